@@ -35,6 +35,7 @@ extern "C" {
 # endif
 
 typedef struct libvlc_renderer_item_t libvlc_renderer_item_t;
+typedef struct libvlc_picture_t libvlc_picture_t;
 
 /**
  * \ingroup libvlc_event
@@ -84,6 +85,14 @@ enum libvlc_event_e {
      * Subitem tree was added to a \link #libvlc_media_t media item\endlink
      */
     libvlc_MediaSubItemTreeAdded,
+    /**
+     * A thumbnail generation for this \link #libvlc_media_t media \endlink
+     * completed.
+     * \see libvlc_media_thumbnail_request_by_time()
+     * \see libvlc_media_thumbnail_request_by_pos()
+     * \see libvlc_media_thumbnail_request_strip()
+     */
+    libvlc_MediaThumbnailGenerated,
 
     libvlc_MediaPlayerMediaChanged=0x100,
     libvlc_MediaPlayerNothingSpecial,
@@ -237,6 +246,11 @@ typedef struct libvlc_event_t
         {
             libvlc_media_t * item;
         } media_subitemtree_added;
+        struct
+        {
+            libvlc_picture_t* p_thumbnail; /**< NULL on failure */
+            unsigned i_index; /**< index within the request, 0 unless strip */
+        } media_thumbnail_generated;
 
         /* media instance */
         struct
@@ -26,6 +26,8 @@
 #ifndef VLC_LIBVLC_MEDIA_H
 #define VLC_LIBVLC_MEDIA_H 1
 
+# include <vlc/libvlc_picture.h>
+
 # ifdef __cplusplus
 extern "C" {
 # endif
@@ -869,6 +871,117 @@ LIBVLC_API
 void libvlc_media_slaves_release( libvlc_media_slave_t **pp_slaves,
                                   unsigned int i_count );
 
+typedef enum libvlc_thumbnailer_seek_speed_t
+{
+    libvlc_media_thumbnail_seek_precise,
+    libvlc_media_thumbnail_seek_fast,
+} libvlc_thumbnailer_seek_speed_t;
+
+typedef struct libvlc_media_thumbnail_request_t libvlc_media_thumbnail_request_t;
+
+/**
+ * \brief libvlc_media_request_thumbnail_by_time Start an asynchronous thumbnail generation
+ *
+ * If the request is successfully queued, the libvlc_MediaThumbnailGenerated
+ * is guaranteed to be emitted, unless the request is destroyed before.
+ * Requests from any number of media are processed in parallel, see the
+ * "thumbnail-threads" option.
+ *
+ * \param md media descriptor object
+ * \param time The time at which the thumbnail should be generated
+ * \param speed The seeking speed \sa{libvlc_thumbnailer_seek_speed_t}
+ * \param width The thumbnail width
+ * \param height the thumbnail height
+ * \param picture_type The thumbnail picture type \sa{libvlc_picture_type_t}
+ * \param timeout A timeout value in ms, or 0 to disable timeout
+ *
+ * \return A valid opaque request object, or NULL in case of failure.
+ * It must be released by libvlc_media_thumbnail_request_destroy().
+ *
+ * \version libvlc 4.0 or later
+ *
+ * \see libvlc_picture_t
+ * \see libvlc_picture_type_t
+ */
+LIBVLC_API libvlc_media_thumbnail_request_t*
+libvlc_media_thumbnail_request_by_time( libvlc_media_t *md,
+                                        libvlc_time_t time,
+                                        libvlc_thumbnailer_seek_speed_t speed,
+                                        unsigned int width, unsigned int height,
+                                        libvlc_picture_type_t picture_type,
+                                        libvlc_time_t timeout );
+
+/**
+ * \brief libvlc_media_request_thumbnail_by_pos Start an asynchronous thumbnail generation
+ *
+ * If the request is successfully queued, the libvlc_MediaThumbnailGenerated
+ * is guaranteed to be emitted, unless the request is destroyed before.
+ *
+ * \param md media descriptor object
+ * \param pos The position at which the thumbnail should be generated
+ * \param speed The seeking speed \sa{libvlc_thumbnailer_seek_speed_t}
+ * \param width The thumbnail width
+ * \param height the thumbnail height
+ * \param picture_type The thumbnail picture type \sa{libvlc_picture_type_t}
+ * \param timeout A timeout value in ms, or 0 to disable timeout
+ *
+ * \return A valid opaque request object, or NULL in case of failure.
+ * It must be released by libvlc_media_thumbnail_request_destroy().
+ *
+ * \version libvlc 4.0 or later
+ *
+ * \see libvlc_picture_t
+ * \see libvlc_picture_type_t
+ */
+LIBVLC_API libvlc_media_thumbnail_request_t*
+libvlc_media_thumbnail_request_by_pos( libvlc_media_t *md,
+                                       float pos,
+                                       libvlc_thumbnailer_seek_speed_t speed,
+                                       unsigned int width, unsigned int height,
+                                       libvlc_picture_type_t picture_type,
+                                       libvlc_time_t timeout );
+
+/**
+ * \brief libvlc_media_thumbnail_request_strip Start an asynchronous
+ * generation of a series of thumbnails
+ *
+ * The media is opened once, and the thumbnails are generated in order by
+ * seeking from one position to the next. One libvlc_MediaThumbnailGenerated
+ * event is emitted per position, with the index of that position.
+ *
+ * \param md media descriptor object
+ * \param positions The positions at which thumbnails should be generated
+ * \param count The number of positions, at least 1
+ * \param speed The seeking speed \sa{libvlc_thumbnailer_seek_speed_t}
+ * \param width The thumbnails width
+ * \param height the thumbnails height
+ * \param picture_type The thumbnails picture type \sa{libvlc_picture_type_t}
+ * \param timeout A timeout value in ms per thumbnail, or 0 to disable timeout
+ *
+ * \return A valid opaque request object, or NULL in case of failure.
+ * It must be released by libvlc_media_thumbnail_request_destroy().
+ *
+ * \version libvlc 4.0 or later
+ */
+LIBVLC_API libvlc_media_thumbnail_request_t*
+libvlc_media_thumbnail_request_strip( libvlc_media_t *md,
+                                      const float *positions, unsigned count,
+                                      libvlc_thumbnailer_seek_speed_t speed,
+                                      unsigned int width, unsigned int height,
+                                      libvlc_picture_type_t picture_type,
+                                      libvlc_time_t timeout );
+
+/**
+ * \brief libvlc_media_thumbnail_request_destroy destroys a thumbnail request
+ * \param p_req An opaque thumbnail request object.
+ *
+ * If the request has not completed yet, it is cancelled and no further
+ * libvlc_MediaThumbnailGenerated event will be emitted for it.
+ * This must not be called from the event callback.
+ */
+LIBVLC_API void
+libvlc_media_thumbnail_request_destroy( libvlc_media_thumbnail_request_t *p_req );
+
 /** @}*/
 
 # ifdef __cplusplus
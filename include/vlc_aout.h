@@ -459,6 +459,71 @@ static inline void aout_PauseDefault(audio_output_t *aout, bool paused,
     (void) date;
 }
 
+/* Audio output ring buffer */
+
+/**
+ * Ring buffer for pull model audio outputs.
+ *
+ * Instead of blocking in audio_output_t.play() until the device accepts the
+ * samples, an output module can queue them into a ring buffer, and drain it
+ * from its own real-time thread or device callback.
+ *
+ * There must be a single producer, audio_output_t.play(), and a single
+ * consumer, the output thread or callback. Neither side ever takes a lock:
+ * only the producer may sleep, when the ring buffer is full or drained.
+ *
+ * Only linear PCM formats are supported.
+ */
+typedef struct aout_ring aout_ring_t;
+
+/**
+ * Creates a ring buffer, from audio_output_t.start().
+ *
+ * \param fmt output sample format
+ * \param duration capacity of the ring buffer
+ */
+VLC_API aout_ring_t *aout_RingNew(audio_output_t *,
+                                  const audio_sample_format_t *fmt,
+                                  vlc_tick_t duration) VLC_USED;
+VLC_API void aout_RingDelete(aout_ring_t *);
+
+/**
+ * Queues a block of samples (producer side).
+ *
+ * Waits for room in the ring buffer if needed. If the consumer stalls for
+ * the duration of the ring buffer, the rest of the block is dropped.
+ * The block is released.
+ */
+VLC_API void aout_RingPlay(aout_ring_t *, block_t *);
+
+/**
+ * Dequeues samples (consumer side).
+ *
+ * If not enough samples are queued, the rest of the buffer is filled with
+ * silence, and an underrun is reported to the core, unless the ring buffer
+ * was flushed or drained since the last queued samples. This function is safe
+ * to call from a real-time thread.
+ *
+ * \param bytes size of the buffer, a multiple of the frame size
+ * \return the number of bytes of actual samples
+ */
+VLC_API size_t aout_RingRead(aout_ring_t *, void *buf, size_t bytes);
+
+/**
+ * Returns the number of bytes queued (either side).
+ */
+VLC_API size_t aout_RingQueued(aout_ring_t *) VLC_USED;
+
+/**
+ * Discards the queued samples (producer side).
+ */
+VLC_API void aout_RingFlush(aout_ring_t *);
+
+/**
+ * Waits for the consumer to dequeue all queued samples (producer side).
+ */
+VLC_API void aout_RingDrain(aout_ring_t *);
+
 /* Audio output filters */
 
 typedef struct
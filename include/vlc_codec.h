@@ -65,6 +65,9 @@ struct decoder_owner_callbacks
             /* Display rate
              * cf. decoder_GetDisplayRate */
             float       (*get_display_rate)( decoder_t * );
+            /* Keyframe only decoding
+             * cf. decoder_IsKeyframeOnly */
+            bool        (*is_keyframe_only)( decoder_t * );
         } video;
         struct
         {
@@ -464,6 +467,22 @@ static inline float decoder_GetDisplayRate( decoder_t *dec )
     return dec->cbs->video.get_display_rate( dec );
 }
 
+/**
+ * This function returns true if only the keyframes are displayed, e.g. for
+ * fast forward. The decoder should then skip the other frames as early as
+ * possible.
+ */
+VLC_USED
+static inline bool decoder_IsKeyframeOnly( decoder_t *dec )
+{
+    vlc_assert( dec->fmt_in.i_cat == VIDEO_ES && dec->cbs != NULL );
+
+    if( !dec->cbs->video.is_keyframe_only )
+        return false;
+
+    return dec->cbs->video.is_keyframe_only( dec );
+}
+
 /** @} */
 /** @} */
 #endif /* _VLC_CODEC_H */
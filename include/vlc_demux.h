@@ -230,6 +230,15 @@ enum demux_query_e
      * arg1= bool */
     DEMUX_SET_RECORD_STATE,
 
+    /** Hints that only the keyframes of the video are decoded, e.g. for
+     * fast forward. The demuxer should then skip the other video frames,
+     * using its index if it has one.
+     *
+     * Can fail (the other frames are then dropped by the decoder).
+     *
+     * arg1= bool */
+    DEMUX_SET_KEYFRAME_ONLY,
+
     /* II. Specific access_demux queries */
 
     /* DEMUX_CAN_CONTROL_RATE is called only if DEMUX_CAN_CONTROL_PACE has
@@ -115,6 +115,16 @@ struct filter_t
         block_t *(*pf_audio_drain) ( filter_t * );
     };
 
+    /** Filter samples in place (audio filter, optional)
+     *
+     * Filters that output VLC_CODEC_FL32 samples in the same format and
+     * quantity as their input can provide this besides pf_audio_filter.
+     * Consecutive such filters are then run over the same buffer, a slice of
+     * samples at a time, so that each slice goes through all of them while it
+     * is still in the cache. Slices are contiguous and given in order.
+     */
+    void (*pf_audio_process)( filter_t *, float *, unsigned samples );
+
     /** Flush
      *
      * Flush (i.e. discard) any internal buffer in a video or audio filter.
@@ -390,6 +390,12 @@ typedef enum input_event_type_e
     /* (pre-)parsing events */
     INPUT_EVENT_SUBITEMS,
 
+    /* Thumbnail generation */
+    INPUT_EVENT_THUMBNAIL_READY,
+
+    /* Loudness scanning */
+    INPUT_EVENT_LOUDNESS_READY,
+
 } input_event_type_e;
 
 #define VLC_INPUT_CAPABILITIES_SEEKABLE (1<<0)
@@ -475,6 +481,10 @@ struct vlc_input_event
         float cache;
         /* INPUT_EVENT_SUBITEMS */
         input_item_node_t *subitems;
+        /* INPUT_EVENT_THUMBNAIL_READY */
+        picture_t *thumbnail;
+        /* INPUT_EVENT_LOUDNESS_READY */
+        const struct vlc_loudness_report *loudness;
     };
 };
 
@@ -437,6 +437,7 @@ struct input_stats_t
     /* Aout */
     int64_t i_played_abuffers;
     int64_t i_lost_abuffers;
+    int64_t i_audio_underruns;
 };
 
 /**
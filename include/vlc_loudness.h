@@ -0,0 +1,171 @@
+/*****************************************************************************
+ * vlc_loudness.h: Loudness measurement and scanning API
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_LOUDNESS_H
+#define VLC_LOUDNESS_H
+
+#include <vlc_common.h>
+
+/**
+ * \defgroup loudness Loudness
+ * \ingroup audio
+ * Loudness measurement as per EBU R128 (ITU-R BS.1770-4, EBU Tech 3341 and
+ * EBU Tech 3342).
+ * @{
+ */
+
+/** ReplayGain 2.0 reference loudness */
+#define VLC_LOUDNESS_REPLAYGAIN_REFERENCE (-18.)
+
+/**
+ * Loudness measurements.
+ *
+ * Values that cannot be measured yet, e.g. the momentary loudness within the
+ * first 400 ms or the loudness of silence, are -INFINITY.
+ */
+struct vlc_loudness_report
+{
+    double momentary; /**< Momentary loudness (400 ms), in LUFS */
+    double short_term; /**< Short-term loudness (3 s), in LUFS */
+    double integrated; /**< Integrated loudness, in LUFS */
+    double range; /**< Loudness range, in LU */
+    double true_peak; /**< Maximum true peak, in dBTP */
+};
+
+/**
+ * \defgroup loudness_meter Loudness meter
+ * Measures the loudness of a stream of samples.
+ * @{
+ */
+typedef struct vlc_loudness_meter vlc_loudness_meter_t;
+
+/**
+ * Creates a loudness meter.
+ *
+ * \param fmt format of the samples, which must be interleaved
+ *            VLC_CODEC_FL32 with a channels bitmap
+ * \return a meter, or NULL on error
+ */
+VLC_API vlc_loudness_meter_t *
+vlc_loudness_meter_New(const audio_sample_format_t *fmt) VLC_USED;
+
+VLC_API void vlc_loudness_meter_Delete(vlc_loudness_meter_t *meter);
+
+/**
+ * Discards all measurements, as for a new stream.
+ */
+VLC_API void vlc_loudness_meter_Reset(vlc_loudness_meter_t *meter);
+
+/**
+ * Measures samples.
+ *
+ * \param samples interleaved samples
+ * \param frames number of frames (samples per channel)
+ */
+VLC_API void vlc_loudness_meter_Process(vlc_loudness_meter_t *meter,
+                                        const float *samples, size_t frames);
+
+/**
+ * Gets the measurements of the samples processed so far.
+ */
+VLC_API void vlc_loudness_meter_Get(const vlc_loudness_meter_t *meter,
+                                    struct vlc_loudness_report *report);
+
+/** @} */
+
+/**
+ * \defgroup loudness_scanner Loudness scanner
+ * Measures the loudness of media without playing them.
+ *
+ * Each request opens its own input with only the audio track enabled and
+ * without any output: decoded samples are measured as fast as they can be
+ * decoded. Requests are processed in parallel by a pool of worker threads.
+ * Once a media was scanned, its ReplayGain track gain and peak are written to
+ * the input item as extra metadata (REPLAYGAIN_TRACK_GAIN and
+ * REPLAYGAIN_TRACK_PEAK).
+ * @{
+ */
+typedef struct vlc_loudness_scanner vlc_loudness_scanner_t;
+typedef struct vlc_loudness_request vlc_loudness_request_t;
+
+/**
+ * Callback invoked once a media was scanned, or could not be.
+ *
+ * It is invoked exactly once per request, unless the request is destroyed
+ * before its completion. It is invoked from an internal thread, without any
+ * scanner lock held, and must not destroy the request it belongs to.
+ *
+ * \param data the opaque pointer given when creating the request
+ * \param report the measurements, or NULL in case of failure or timeout
+ */
+typedef void (*vlc_loudness_scanner_cb)(void *data,
+                                        const struct vlc_loudness_report *report);
+
+/**
+ * Creates a loudness scanner.
+ *
+ * \param parent a VLC object
+ * \return a scanner, or NULL in case of failure
+ */
+VLC_API vlc_loudness_scanner_t *
+vlc_loudness_scanner_Create(vlc_object_t *parent) VLC_USED;
+
+/**
+ * Requests the loudness of a media.
+ *
+ * \param scanner a scanner object
+ * \param item the input item to scan
+ * \param timeout a timeout value, or VLC_TICK_INVALID to disable timeout
+ * \param cb a callback invoked on completion (success and error)
+ * \param data an opaque value, provided as the first parameter of cb
+ * \return an opaque request object, or NULL in case of failure
+ *
+ * The returned request must be destroyed with
+ * vlc_loudness_scanner_DestroyRequest().
+ */
+VLC_API vlc_loudness_request_t *
+vlc_loudness_scanner_Request(vlc_loudness_scanner_t *scanner,
+                             input_item_t *item, vlc_tick_t timeout,
+                             vlc_loudness_scanner_cb cb, void *data);
+
+/**
+ * Cancels and destroys a request.
+ *
+ * If the request is still queued or running, it is cancelled and the
+ * callback will not be invoked anymore once this function returns.
+ * This function must not be called from the request callback.
+ */
+VLC_API void
+vlc_loudness_scanner_DestroyRequest(vlc_loudness_scanner_t *scanner,
+                                    vlc_loudness_request_t *request);
+
+/**
+ * Releases a scanner.
+ *
+ * All the requests created from this scanner must have been destroyed
+ * beforehand.
+ */
+VLC_API void vlc_loudness_scanner_Release(vlc_loudness_scanner_t *scanner);
+
+/** @} */
+
+/** @} */
+
+#endif
@@ -0,0 +1,88 @@
+/*****************************************************************************
+ * vlc_seek_index.h: Persistent seek index for demuxers
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_SEEK_INDEX_H
+#define VLC_SEEK_INDEX_H
+
+#include <vlc_demux.h>
+
+/**
+ * \defgroup seek_index Seek index
+ * \ingroup demux
+ * Time to offset maps for the formats without a native index.
+ *
+ * A demuxer records the time and byte offset of the random access points
+ * it meets while playing, and looks them up to seek. The index is saved in
+ * the user cache directory when it is deleted, and loaded back the next time
+ * the same file is opened with the same demuxer, the file being identified
+ * by its size, its modification time if it is local and its first bytes.
+ * Only the indexes of the last files saved are kept.
+ * @{
+ */
+
+typedef struct vlc_seek_index vlc_seek_index_t;
+
+/**
+ * Creates the seek index of the demuxer source, loading the cached entries.
+ *
+ * \param demux demuxer, whose source must be seekable with a known size
+ * \param format name of the demuxer, as the times are specific to it
+ * \return an index, or NULL if it is disabled (input-seek-index option),
+ *         if the source cannot be identified or on error
+ */
+VLC_API vlc_seek_index_t *vlc_seek_index_New(demux_t *demux,
+                                             const char *format) VLC_USED;
+
+/**
+ * Saves the index to the cache if it has new entries, and deletes it.
+ */
+VLC_API void vlc_seek_index_Delete(vlc_seek_index_t *index);
+
+/**
+ * Records a random access point.
+ *
+ * Points closer than one second to a recorded one are ignored, and so are
+ * the points whose offset is out of order with the recorded ones, e.g. after
+ * a timestamp discontinuity.
+ *
+ * \param time time of the point, as returned by DEMUX_GET_TIME
+ * \param offset byte offset in the source to resume reading from
+ */
+VLC_API void vlc_seek_index_Add(vlc_seek_index_t *index, vlc_tick_t time,
+                                uint64_t offset);
+
+/**
+ * Finds the last recorded point at or before a time.
+ *
+ * The caller is responsible for checking that the point is close enough to
+ * the requested time to be of any use.
+ *
+ * \param time requested time
+ * \param point_time time of the point found [OUT]
+ * \param offset byte offset of the point found [OUT]
+ * \return true if a point was found
+ */
+VLC_API bool vlc_seek_index_Lookup(const vlc_seek_index_t *index,
+                                   vlc_tick_t time, vlc_tick_t *point_time,
+                                   uint64_t *offset);
+
+/** @} */
+
+#endif
@@ -0,0 +1,172 @@
+/*****************************************************************************
+ * vlc_thumbnailer.h: Thumbnailing API
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_THUMBNAILER_H
+#define VLC_THUMBNAILER_H
+
+#include <vlc_common.h>
+
+/**
+ * \defgroup thumbnailer Thumbnailer
+ * \ingroup input
+ * Extract pictures from media without playing them.
+ *
+ * Each request opens its own input with only the video track enabled and
+ * without any output: decoded pictures are handed to the caller instead of
+ * being displayed. Requests are processed in parallel by a pool of worker
+ * threads.
+ * @{
+ */
+
+typedef struct vlc_thumbnailer_t vlc_thumbnailer_t;
+typedef struct vlc_thumbnailer_request_t vlc_thumbnailer_request_t;
+
+/**
+ * \brief vlc_thumbnailer_cb defines a callback invoked when a thumbnail was
+ * generated, or could not be
+ *
+ * The callback is invoked exactly once per requested thumbnail, unless the
+ * request is destroyed before its completion. It is invoked from an internal
+ * thread, without any thumbnailer lock held, and must not destroy the request
+ * it belongs to.
+ *
+ * \param data The opaque pointer given when creating the request
+ * \param index The index of the thumbnail within the request, 0 for requests
+ *              of a single thumbnail
+ * \param thumbnail The generated thumbnail, or NULL in case of failure or
+ *                  timeout. It is owned by the thumbnailer: use picture_Hold()
+ *                  to keep it past the callback scope.
+ */
+typedef void(*vlc_thumbnailer_cb)( void* data, unsigned index,
+                                   picture_t* thumbnail );
+
+enum vlc_thumbnailer_seek_speed
+{
+    /** Seek to the exact requested time or position. Pictures between the
+     * preceding key frame and the target are decoded but never output. */
+    VLC_THUMBNAILER_SEEK_PRECISE,
+    /** Seek to the closest key frame, decoding a single picture */
+    VLC_THUMBNAILER_SEEK_FAST,
+};
+
+/**
+ * \brief vlc_thumbnailer_Create Creates a thumbnailer object
+ * \param parent A VLC object
+ * \return A thumbnailer object, or NULL in case of failure
+ */
+VLC_API vlc_thumbnailer_t *vlc_thumbnailer_Create( vlc_object_t* parent )
+VLC_USED;
+
+/**
+ * \brief vlc_thumbnailer_RequestByTime Requests a thumbnail at a given time
+ *
+ * \param thumbnailer A thumbnailer object
+ * \param time The time at which the thumbnail should be taken
+ * \param speed The seeking speed \sa{vlc_thumbnailer_seek_speed}
+ * \param input_item The input item to generate the thumbnail for
+ * \param timeout A timeout value, or VLC_TICK_INVALID to disable timeout
+ * \param cb A user callback to be called on completion (success & error)
+ * \param user_data An opaque value, provided as pf_cb's first parameter
+ * \return An opaque request object, or NULL in case of failure
+ *
+ * The returned request must be destroyed with vlc_thumbnailer_DestroyRequest().
+ */
+VLC_API vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestByTime( vlc_thumbnailer_t *thumbnailer,
+                               vlc_tick_t time,
+                               enum vlc_thumbnailer_seek_speed speed,
+                               input_item_t *input_item, vlc_tick_t timeout,
+                               vlc_thumbnailer_cb cb, void* user_data );
+
+/**
+ * \brief vlc_thumbnailer_RequestByPos Requests a thumbnail at a given position
+ *
+ * \param thumbnailer A thumbnailer object
+ * \param pos The position at which the thumbnail should be taken, in [0;1]
+ * \param speed The seeking speed \sa{vlc_thumbnailer_seek_speed}
+ * \param input_item The input item to generate the thumbnail for
+ * \param timeout A timeout value, or VLC_TICK_INVALID to disable timeout
+ * \param cb A user callback to be called on completion (success & error)
+ * \param user_data An opaque value, provided as pf_cb's first parameter
+ * \return An opaque request object, or NULL in case of failure
+ *
+ * The returned request must be destroyed with vlc_thumbnailer_DestroyRequest().
+ */
+VLC_API vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
+                              float pos,
+                              enum vlc_thumbnailer_seek_speed speed,
+                              input_item_t *input_item, vlc_tick_t timeout,
+                              vlc_thumbnailer_cb cb, void* user_data );
+
+/**
+ * \brief vlc_thumbnailer_RequestStrip Requests a series of thumbnails
+ *
+ * The thumbnails are extracted in order from a single input, seeking from
+ * one position to the next, so that the media is only opened once. This is
+ * meant to generate sprites and seek previews.
+ *
+ * \param thumbnailer A thumbnailer object
+ * \param positions The positions at which thumbnails should be taken, in [0;1]
+ * \param count The number of positions, at least 1
+ * \param speed The seeking speed \sa{vlc_thumbnailer_seek_speed}
+ * \param input_item The input item to generate the thumbnails for
+ * \param timeout A timeout value per thumbnail, or VLC_TICK_INVALID to
+ *                disable timeout
+ * \param cb A user callback to be called once per thumbnail, with the index
+ *           of the position it was taken at
+ * \param user_data An opaque value, provided as pf_cb's first parameter
+ * \return An opaque request object, or NULL in case of failure
+ *
+ * The returned request must be destroyed with vlc_thumbnailer_DestroyRequest().
+ */
+VLC_API vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestStrip( vlc_thumbnailer_t *thumbnailer,
+                              const float *positions, unsigned count,
+                              enum vlc_thumbnailer_seek_speed speed,
+                              input_item_t *input_item, vlc_tick_t timeout,
+                              vlc_thumbnailer_cb cb, void* user_data );
+
+/**
+ * \brief vlc_thumbnailer_DestroyRequest Cancels and destroys a request
+ *
+ * If the request is still queued or running, it is cancelled and the
+ * callback will not be invoked anymore once this function returns.
+ * This function must not be called from the request callback.
+ *
+ * \param thumbnailer A thumbnailer object
+ * \param request An opaque thumbnail request object
+ */
+VLC_API void vlc_thumbnailer_DestroyRequest( vlc_thumbnailer_t* thumbnailer,
+                                             vlc_thumbnailer_request_t* request );
+
+/**
+ * \brief vlc_thumbnailer_Release releases a thumbnailer
+ *
+ * All the requests created from this thumbnailer must have been destroyed
+ * beforehand.
+ *
+ * \param thumbnailer A thumbnailer object
+ */
+VLC_API void vlc_thumbnailer_Release( vlc_thumbnailer_t* thumbnailer );
+
+/** @} */
+
+#endif // VLC_THUMBNAILER_H
@@ -262,8 +262,8 @@ struct vout_display_t {
      * It is called before the next pf_display call to provide as much
      * time as possible to prepare the given picture and the subpicture
      * for display.
-     * You are guaranted that pf_display will always be called and using
-     * the exact same picture_t and subpicture_t.
+     * You are guaranted that pf_display, or pf_cancel if provided, will
+     * always be called and using the exact same picture_t and subpicture_t.
      * You cannot change the pixel content of the picture_t or of the
      * subpicture_t.
      */
@@ -282,6 +282,17 @@ struct vout_display_t {
      */
     void       (*display)(vout_display_t *, picture_t *, subpicture_t *);
 
+    /* Cancel a prepared picture and its optional subpicture (optional).
+     *
+     * It is called instead of pf_display when the prepared picture is not to
+     * be displayed anymore, e.g. after a flush. If not provided, the
+     * prepared picture is always displayed.
+     *
+     * This function gives away the ownership of the picture and of the
+     * subpicture, so you must release them as soon as possible.
+     */
+    void       (*cancel)(vout_display_t *, picture_t *, subpicture_t *);
+
     /* Control on the module (mandatory) */
     int        (*control)(vout_display_t *, int, va_list);
 
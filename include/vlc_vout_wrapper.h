@@ -58,6 +58,16 @@ static inline void vout_display_Display(vout_display_t *vd,
     vd->display(vd, picture, subpicture);
 }
 
+/**
+ * It discards a prepared picture without displaying it.
+ */
+static inline void vout_display_Cancel(vout_display_t *vd,
+                                       picture_t *picture,
+                                       subpicture_t *subpicture)
+{
+    vd->cancel(vd, picture, subpicture);
+}
+
 /**
  * It holds a state for a vout display.
  */
@@ -38,12 +38,14 @@
 #include <vlc_meta.h>
 #include <vlc_playlist.h> /* For the preparser */
 #include <vlc_url.h>
+#include <vlc_thumbnailer.h>
 
 #include "../src/libvlc.h"
 
 #include "libvlc_internal.h"
 #include "media_internal.h"
 #include "media_list_internal.h"
+#include "picture_internal.h"
 
 static const vlc_meta_type_t libvlc_to_vlc_meta[] =
 {
@@ -1092,6 +1094,139 @@ libvlc_media_type_t libvlc_media_get_type( libvlc_media_t *p_md )
     }
 }
 
+struct libvlc_media_thumbnail_request_t
+{
+    libvlc_media_t *md;
+    unsigned int width;
+    unsigned int height;
+    libvlc_picture_type_t type;
+    vlc_thumbnailer_request_t* req;
+};
+
+static void media_on_thumbnail_ready( void* data, unsigned index,
+                                      picture_t* thumbnail )
+{
+    libvlc_media_thumbnail_request_t *req = data;
+    libvlc_media_t *p_media = req->md;
+    libvlc_event_t event;
+    event.type = libvlc_MediaThumbnailGenerated;
+    libvlc_picture_t* pic = NULL;
+    if ( thumbnail != NULL )
+        pic = libvlc_picture_new( VLC_OBJECT(p_media->p_libvlc_instance->p_libvlc_int),
+                                  thumbnail, req->type, req->width, req->height );
+    event.u.media_thumbnail_generated.p_thumbnail = pic;
+    event.u.media_thumbnail_generated.i_index = index;
+    libvlc_event_send( &p_media->event_manager, &event );
+    if ( pic != NULL )
+        libvlc_picture_release( pic );
+}
+
+static libvlc_media_thumbnail_request_t*
+media_thumbnail_request_new( libvlc_media_t *md, unsigned int width,
+                             unsigned int height,
+                             libvlc_picture_type_t picture_type )
+{
+    libvlc_priv_t *p_priv = libvlc_priv(md->p_libvlc_instance->p_libvlc_int);
+    if ( p_priv->p_thumbnailer == NULL )
+        return NULL;
+
+    libvlc_media_thumbnail_request_t *req = malloc( sizeof( *req ) );
+    if ( unlikely( req == NULL ) )
+        return NULL;
+
+    req->md = md;
+    req->width = width;
+    req->height = height;
+    req->type = picture_type;
+    libvlc_media_retain( md );
+    return req;
+}
+
+static libvlc_media_thumbnail_request_t*
+media_thumbnail_request_queued( libvlc_media_thumbnail_request_t *req )
+{
+    if ( req->req == NULL )
+    {
+        libvlc_media_release( req->md );
+        free( req );
+        return NULL;
+    }
+    return req;
+}
+
+libvlc_media_thumbnail_request_t*
+libvlc_media_thumbnail_request_by_time( libvlc_media_t *md, libvlc_time_t time,
+                                        libvlc_thumbnailer_seek_speed_t speed,
+                                        unsigned int width, unsigned int height,
+                                        libvlc_picture_type_t picture_type,
+                                        libvlc_time_t timeout )
+{
+    assert( md );
+    libvlc_media_thumbnail_request_t *req =
+        media_thumbnail_request_new( md, width, height, picture_type );
+    if ( req == NULL )
+        return NULL;
+
+    libvlc_priv_t *p_priv = libvlc_priv(md->p_libvlc_instance->p_libvlc_int);
+    req->req = vlc_thumbnailer_RequestByTime( p_priv->p_thumbnailer,
+        to_mtime( time ),
+        speed == libvlc_media_thumbnail_seek_fast ?
+            VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
+        md->p_input_item,
+        timeout > 0 ? to_mtime( timeout ) : VLC_TICK_INVALID,
+        media_on_thumbnail_ready, req );
+    return media_thumbnail_request_queued( req );
+}
+
+libvlc_media_thumbnail_request_t*
+libvlc_media_thumbnail_request_by_pos( libvlc_media_t *md, float pos,
+                                       libvlc_thumbnailer_seek_speed_t speed,
+                                       unsigned int width, unsigned int height,
+                                       libvlc_picture_type_t picture_type,
+                                       libvlc_time_t timeout )
+{
+    return libvlc_media_thumbnail_request_strip( md, &pos, 1, speed, width,
+                                                 height, picture_type,
+                                                 timeout );
+}
+
+libvlc_media_thumbnail_request_t*
+libvlc_media_thumbnail_request_strip( libvlc_media_t *md,
+                                      const float *positions, unsigned count,
+                                      libvlc_thumbnailer_seek_speed_t speed,
+                                      unsigned int width, unsigned int height,
+                                      libvlc_picture_type_t picture_type,
+                                      libvlc_time_t timeout )
+{
+    assert( md );
+    if ( count == 0 )
+        return NULL;
+
+    libvlc_media_thumbnail_request_t *req =
+        media_thumbnail_request_new( md, width, height, picture_type );
+    if ( req == NULL )
+        return NULL;
+
+    libvlc_priv_t *p_priv = libvlc_priv(md->p_libvlc_instance->p_libvlc_int);
+    req->req = vlc_thumbnailer_RequestStrip( p_priv->p_thumbnailer,
+        positions, count,
+        speed == libvlc_media_thumbnail_seek_fast ?
+            VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
+        md->p_input_item,
+        timeout > 0 ? to_mtime( timeout ) : VLC_TICK_INVALID,
+        media_on_thumbnail_ready, req );
+    return media_thumbnail_request_queued( req );
+}
+
+void libvlc_media_thumbnail_request_destroy( libvlc_media_thumbnail_request_t *req )
+{
+    libvlc_priv_t *p_priv = libvlc_priv(req->md->p_libvlc_instance->p_libvlc_int);
+    assert( p_priv->p_thumbnailer != NULL );
+    vlc_thumbnailer_DestroyRequest( p_priv->p_thumbnailer, req->req );
+    libvlc_media_release( req->md );
+    free( req );
+}
+
 int libvlc_media_slaves_add( libvlc_media_t *p_md,
                              libvlc_media_slave_type_t i_type,
                              unsigned int i_priority,
@@ -38,12 +38,15 @@
 #include <vlc_filter.h>
 #include <vlc_block.h>
 
+#include "../convolution.h"
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
 static int  OpenFilter ( vlc_object_t * );
 static void CloseFilter( vlc_object_t * );
 static block_t *Convert( filter_t *, block_t * );
+static void Flush( filter_t * );
 
 /*****************************************************************************
  * Module descriptor
@@ -102,12 +105,16 @@ struct atomic_operation_t
     double d_amplitude_factor;
 };
 
+/* Partition size of the convolution, in samples */
+#define HEADPHONE_PARTITION 256
+
 typedef struct
 {
-    size_t i_overflow_buffer_size;/* in bytes */
-    float * p_overflow_buffer;
     unsigned int i_nb_atomic_operations;
     struct atomic_operation_t * p_atomic_operations;
+    /* Delays and attenuations of the atomic operations, as responses from
+     * each source channel to each ear */
+    convolver_t * p_convolver;
 } filter_sys_t;
 
 /*****************************************************************************
@@ -187,7 +194,7 @@ static void ComputeChannelOperations( filter_sys_t * p_data
 
 static int Init( vlc_object_t *p_this, filter_sys_t * p_data
         , unsigned int i_nb_channels, uint32_t i_physical_channels
-        , unsigned int i_rate )
+        , unsigned int i_rate, unsigned int i_nb_inputs )
 {
     double d_x = var_InheritInteger( p_this, "headphone-dim" );
     double d_z = d_x;
@@ -303,25 +310,50 @@ static int Init( vlc_object_t *p_this, filter_sys_t * p_data
         i_source_channel_offset++;
     }
 
-    /* Initialize the overflow buffer
-     * we need it because the process induce a delay in the samples */
-    p_data->i_overflow_buffer_size = 0;
+    /* Turn the atomic operations into impulse responses, long enough for
+     * the largest delay */
+    unsigned int i_taps = 1;
     for( i = 0 ; i < p_data->i_nb_atomic_operations ; i++ )
     {
-        if( p_data->i_overflow_buffer_size
-                < p_data->p_atomic_operations[i].i_delay * 2 * sizeof (float) )
-        {
-            p_data->i_overflow_buffer_size
-                = p_data->p_atomic_operations[i].i_delay * 2 * sizeof (float);
-        }
+        if( i_taps <= p_data->p_atomic_operations[i].i_delay )
+            i_taps = p_data->p_atomic_operations[i].i_delay + 1;
     }
-    p_data->p_overflow_buffer = malloc( p_data->i_overflow_buffer_size );
-    if( p_data->p_overflow_buffer == NULL )
+
+    p_data->p_convolver = convolver_New( i_nb_inputs, 2,
+                                         HEADPHONE_PARTITION, i_taps );
+    float *p_response = malloc( i_taps * sizeof (float) );
+    if( p_data->p_convolver == NULL || p_response == NULL )
     {
+        if( p_data->p_convolver != NULL )
+            convolver_Delete( p_data->p_convolver );
+        free( p_response );
         free( p_data->p_atomic_operations );
         return -1;
     }
-    memset( p_data->p_overflow_buffer, 0 , p_data->i_overflow_buffer_size );
+
+    for( unsigned int i_source = 0; i_source < i_nb_inputs; i_source++ )
+        for( int i_dest = 0; i_dest < 2; i_dest++ )
+        {
+            bool b_used = false;
+
+            memset( p_response, 0, i_taps * sizeof (float) );
+            for( i = 0 ; i < p_data->i_nb_atomic_operations ; i++ )
+            {
+                const struct atomic_operation_t *p_op =
+                    &p_data->p_atomic_operations[i];
+
+                if( p_op->i_source_channel_offset == (int)i_source
+                 && p_op->i_dest_channel_offset == i_dest )
+                {
+                    p_response[p_op->i_delay] += p_op->d_amplitude_factor;
+                    b_used = true;
+                }
+            }
+            if( b_used )
+                convolver_SetResponse( p_data->p_convolver, i_source, i_dest,
+                                       p_response, i_taps );
+        }
+    free( p_response );
 
     return 0;
 }
@@ -333,101 +365,10 @@ static void DoWork( filter_t * p_filter,
                     block_t * p_in_buf, block_t * p_out_buf )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    int i_input_nb = aout_FormatNbChannels( &p_filter->fmt_in.audio );
-    int i_output_nb = aout_FormatNbChannels( &p_filter->fmt_out.audio );
-
-    float * p_in = (float*) p_in_buf->p_buffer;
-    float * p_out;
-    uint8_t * p_overflow;
-    uint8_t * p_end_overflow;
-    uint8_t * p_slide;
-
-    size_t i_overflow_size;     /* in bytes */
-    size_t i_out_size;          /* in bytes */
-
-    unsigned int i, j;
-
-    int i_source_channel_offset;
-    int i_dest_channel_offset;
-    unsigned int i_delay;
-    double d_amplitude_factor;
-
-    p_out = (float *)p_out_buf->p_buffer;
-    i_out_size = p_out_buf->i_buffer;
-
-    /* Slide the overflow buffer */
-    p_overflow = (uint8_t *) p_sys->p_overflow_buffer;
-    i_overflow_size = p_sys->i_overflow_buffer_size;
-    p_end_overflow = p_overflow + i_overflow_size;
-
-    memset( p_out, 0, i_out_size );
-    memcpy( p_out, p_overflow, __MIN( i_out_size, i_overflow_size ) );
-
-    p_slide = (uint8_t *) p_sys->p_overflow_buffer;
-    while( p_slide < p_end_overflow )
-    {
-        size_t i_bytes_copied;
-
-        if( p_slide + i_out_size < p_end_overflow )
-        {
-            memset( p_slide, 0, i_out_size );
-            if( p_slide + 2 * i_out_size < p_end_overflow )
-                i_bytes_copied = i_out_size;
-            else
-                i_bytes_copied = p_end_overflow - ( p_slide + i_out_size );
-            memcpy( p_slide, p_slide + i_out_size, i_bytes_copied );
-        }
-        else
-        {
-            i_bytes_copied = p_end_overflow - p_slide;
-            memset( p_slide, 0, i_bytes_copied );
-        }
-        p_slide += i_bytes_copied;
-    }
 
-    /* apply the atomic operations */
-    for( i = 0; i < p_sys->i_nb_atomic_operations; i++ )
-    {
-        /* shorter variable names */
-        i_source_channel_offset
-            = p_sys->p_atomic_operations[i].i_source_channel_offset;
-        i_dest_channel_offset
-            = p_sys->p_atomic_operations[i].i_dest_channel_offset;
-        i_delay = p_sys->p_atomic_operations[i].i_delay;
-        d_amplitude_factor
-            = p_sys->p_atomic_operations[i].d_amplitude_factor;
-
-        if( p_out_buf->i_nb_samples > i_delay )
-        {
-            /* current buffer coefficients */
-            for( j = 0; j < p_out_buf->i_nb_samples - i_delay; j++ )
-            {
-                ((float*)p_out)[ (i_delay+j)*i_output_nb + i_dest_channel_offset ]
-                    += p_in[ j * i_input_nb + i_source_channel_offset ]
-                       * d_amplitude_factor;
-            }
-
-            /* overflow buffer coefficients */
-            for( j = 0; j < i_delay; j++ )
-            {
-                ((float*)p_overflow)[ j*i_output_nb + i_dest_channel_offset ]
-                    += p_in[ (p_out_buf->i_nb_samples - i_delay + j)
-                       * i_input_nb + i_source_channel_offset ]
-                       * d_amplitude_factor;
-            }
-        }
-        else
-        {
-            /* overflow buffer coefficients only */
-            for( j = 0; j < p_out_buf->i_nb_samples; j++ )
-            {
-                ((float*)p_overflow)[ (i_delay - p_out_buf->i_nb_samples + j)
-                                        * i_output_nb + i_dest_channel_offset ]
-                    += p_in[ j * i_input_nb + i_source_channel_offset ]
-                       * d_amplitude_factor;
-            }
-        }
-    }
+    convolver_Process( p_sys->p_convolver, (const float *)p_in_buf->p_buffer,
+                       (float *)p_out_buf->p_buffer,
+                       p_in_buf->i_nb_samples );
 }
 
 /*
@@ -453,19 +394,13 @@ static int OpenFilter( vlc_object_t *p_this )
     p_sys = p_filter->p_sys = malloc( sizeof(filter_sys_t) );
     if( p_sys == NULL )
         return VLC_ENOMEM;
-    p_sys->i_overflow_buffer_size = 0;
-    p_sys->p_overflow_buffer = NULL;
     p_sys->i_nb_atomic_operations = 0;
     p_sys->p_atomic_operations = NULL;
 
-    if( Init( VLC_OBJECT(p_filter), p_sys
-                , aout_FormatNbChannels ( &(p_filter->fmt_in.audio) )
-                , p_filter->fmt_in.audio.i_physical_channels
-                , p_filter->fmt_in.audio.i_rate ) < 0 )
-    {
-        free( p_sys );
-        return VLC_EGENERIC;
-    }
+    const unsigned int i_nb_channels =
+        aout_FormatNbChannels( &(p_filter->fmt_in.audio) );
+    const uint32_t i_physical_channels =
+        p_filter->fmt_in.audio.i_physical_channels;
 
     /* Request a specific format if not already compatible */
     p_filter->fmt_in.audio.i_format = VLC_CODEC_FL32;
@@ -480,10 +415,19 @@ static int OpenFilter( vlc_object_t *p_this )
         p_filter->fmt_in.audio.i_physical_channels = AOUT_CHANS_5_0;
     }
     p_filter->pf_audio_filter = Convert;
+    p_filter->pf_flush = Flush;
 
     aout_FormatPrepare(&p_filter->fmt_in.audio);
     aout_FormatPrepare(&p_filter->fmt_out.audio);
 
+    if( Init( VLC_OBJECT(p_filter), p_sys, i_nb_channels, i_physical_channels
+                , p_filter->fmt_in.audio.i_rate
+                , aout_FormatNbChannels( &(p_filter->fmt_in.audio) ) ) < 0 )
+    {
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+
     return VLC_SUCCESS;
 }
 
@@ -495,11 +439,18 @@ static void CloseFilter( vlc_object_t *p_this )
     filter_t *p_filter = (filter_t *)p_this;
     filter_sys_t *p_sys = p_filter->p_sys;
 
-    free( p_sys->p_overflow_buffer );
+    convolver_Delete( p_sys->p_convolver );
     free( p_sys->p_atomic_operations );
     free( p_sys );
 }
 
+static void Flush( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    convolver_Reset( p_sys->p_convolver );
+}
+
 static block_t *Convert( filter_t *p_filter, block_t *p_block )
 {
     if( !p_block || !p_block->i_nb_samples )
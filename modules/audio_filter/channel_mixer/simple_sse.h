@@ -0,0 +1,213 @@
+/*****************************************************************************
+ * simple_sse.h : simple channel mixer plug-in using SSE intrinsics
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <vlc_cpu.h>
+#include <immintrin.h>
+
+/* Only conversion to Stereo and 4.0 right now */
+/* Only from 7/7.1/6.1/5/5.1
+ * XXX 5.X rear and middle are handled the same way
+ *
+ * Stereo outputs are computed two input frames at a time, so that a whole
+ * vector is stored at once. Loads never go past the end of an input frame. */
+
+#define LOAD_PAIRS(a, b) \
+    _mm_loadh_pi( _mm_loadl_pi( _mm_setzero_ps(), (const __m64 *)(a) ), \
+                  (const __m64 *)(b) )
+
+VLC_SSE
+static void DoWork_7_x_to_2_0_sse( filter_t *p_filter, block_t *p_in_buf,
+                                   block_t *p_out_buf )
+{
+    const unsigned i_step = 7 +
+        !!( p_filter->fmt_in.audio.i_physical_channels & AOUT_CHAN_LFE );
+    const __m128 f_ctr = _mm_set1_ps( 0.7071f );
+    const __m128 f_quarter = _mm_set1_ps( 0.25f );
+    float *p_dest = (float *)p_out_buf->p_buffer;
+    const float *p_src = (const float *)p_in_buf->p_buffer;
+    unsigned i = p_in_buf->i_nb_samples;
+
+    for( ; i >= 2; i -= 2 )
+    {
+        const float *a = p_src, *b = p_src + i_step;
+        __m128 front = LOAD_PAIRS( a, b );
+        __m128 side = LOAD_PAIRS( a + 2, b + 2 );
+        __m128 rear = LOAD_PAIRS( a + 4, b + 4 );
+        __m128 ctr = _mm_set_ps( b[6], b[6], a[6], a[6] );
+
+        __m128 out = _mm_add_ps( _mm_mul_ps( ctr, f_ctr ), front );
+        out = _mm_add_ps( out, _mm_mul_ps( _mm_add_ps( side, rear ),
+                                           f_quarter ) );
+        _mm_storeu_ps( p_dest, out );
+        p_dest += 4;
+        p_src += 2 * i_step;
+    }
+    if( i > 0 )
+    {
+        float ctr = p_src[6] * 0.7071f;
+        *p_dest++ = ctr + p_src[0] + p_src[2] / 4 + p_src[4] / 4;
+        *p_dest++ = ctr + p_src[1] + p_src[3] / 4 + p_src[5] / 4;
+    }
+}
+
+VLC_SSE
+static void DoWork_6_1_to_2_0_sse( filter_t *p_filter, block_t *p_in_buf,
+                                   block_t *p_out_buf )
+{
+    VLC_UNUSED(p_filter);
+    const __m128 f_ctr = _mm_set1_ps( 0.7071f );
+    float *p_dest = (float *)p_out_buf->p_buffer;
+    const float *p_src = (const float *)p_in_buf->p_buffer;
+    unsigned i = p_in_buf->i_nb_samples;
+
+    /* We always have LFE here */
+    for( ; i >= 2; i -= 2 )
+    {
+        const float *a = p_src, *b = p_src + 7;
+        __m128 front = LOAD_PAIRS( a, b );
+        __m128 rear = LOAD_PAIRS( a + 3, b + 3 );
+        __m128 ctr = _mm_set_ps( b[2] + b[5], b[2] + b[5],
+                                 a[2] + a[5], a[2] + a[5] );
+
+        __m128 out = _mm_add_ps( _mm_add_ps( front, rear ),
+                                 _mm_mul_ps( ctr, f_ctr ) );
+        _mm_storeu_ps( p_dest, out );
+        p_dest += 4;
+        p_src += 14;
+    }
+    if( i > 0 )
+    {
+        float ctr = (p_src[2] + p_src[5]) * 0.7071f;
+        *p_dest++ = p_src[0] + p_src[3] + ctr;
+        *p_dest++ = p_src[1] + p_src[4] + ctr;
+    }
+}
+
+VLC_SSE
+static void DoWork_5_x_to_2_0_sse( filter_t *p_filter, block_t *p_in_buf,
+                                   block_t *p_out_buf )
+{
+    const unsigned i_step = 5 +
+        !!( p_filter->fmt_in.audio.i_physical_channels & AOUT_CHAN_LFE );
+    const __m128 f_ctr = _mm_set1_ps( 0.7071f );
+    float *p_dest = (float *)p_out_buf->p_buffer;
+    const float *p_src = (const float *)p_in_buf->p_buffer;
+    unsigned i = p_in_buf->i_nb_samples;
+
+    for( ; i >= 2; i -= 2 )
+    {
+        const float *a = p_src, *b = p_src + i_step;
+        __m128 front = LOAD_PAIRS( a, b );
+        __m128 rear = LOAD_PAIRS( a + 2, b + 2 );
+        __m128 ctr = _mm_set_ps( b[4], b[4], a[4], a[4] );
+
+        __m128 out = _mm_add_ps( front,
+                                 _mm_mul_ps( _mm_add_ps( ctr, rear ), f_ctr ) );
+        _mm_storeu_ps( p_dest, out );
+        p_dest += 4;
+        p_src += 2 * i_step;
+    }
+    if( i > 0 )
+    {
+        *p_dest++ = p_src[0] + 0.7071f * (p_src[4] + p_src[2]);
+        *p_dest++ = p_src[1] + 0.7071f * (p_src[4] + p_src[3]);
+    }
+}
+
+VLC_SSE
+static void DoWork_7_x_to_4_0_sse( filter_t *p_filter, block_t *p_in_buf,
+                                   block_t *p_out_buf )
+{
+    const unsigned i_step = 7 +
+        !!( p_filter->fmt_in.audio.i_physical_channels & AOUT_CHAN_LFE );
+    const __m128 f_front = _mm_set_ps( 1.f, 1.f, 0.5f, 0.5f );
+    const __m128 f_side = _mm_set1_ps( 1.f / 6 );
+    float *p_dest = (float *)p_out_buf->p_buffer;
+    const float *p_src = (const float *)p_in_buf->p_buffer;
+
+    for( unsigned i = p_in_buf->i_nb_samples; i--; )
+    {
+        /* (L, R, Lr, Rr) * (.5, .5, 1, 1) + (Ls, Rs, Ls, Rs) / 6 + C */
+        __m128 front = LOAD_PAIRS( p_src, p_src + 4 );
+        __m128 side = LOAD_PAIRS( p_src + 2, p_src + 2 );
+        __m128 ctr = _mm_set_ps( 0.f, 0.f, p_src[6], p_src[6] );
+
+        __m128 out = _mm_add_ps( ctr, _mm_mul_ps( front, f_front ) );
+        out = _mm_add_ps( out, _mm_mul_ps( side, f_side ) );
+        _mm_storeu_ps( p_dest, out );
+        p_dest += 4;
+        p_src += i_step;
+    }
+}
+
+VLC_SSE
+static void DoWork_5_x_to_4_0_sse( filter_t *p_filter, block_t *p_in_buf,
+                                   block_t *p_out_buf )
+{
+    const unsigned i_step = 5 +
+        !!( p_filter->fmt_in.audio.i_physical_channels & AOUT_CHAN_LFE );
+    float *p_dest = (float *)p_out_buf->p_buffer;
+    const float *p_src = (const float *)p_in_buf->p_buffer;
+
+    for( unsigned i = p_in_buf->i_nb_samples; i--; )
+    {
+        float ctr = p_src[4] * 0.7071f;
+        __m128 out = _mm_add_ps( _mm_loadu_ps( p_src ),
+                                 _mm_set_ps( 0.f, 0.f, ctr, ctr ) );
+        _mm_storeu_ps( p_dest, out );
+        p_dest += 4;
+        p_src += i_step;
+    }
+}
+
+#undef LOAD_PAIRS
+
+#define SSE_WRAPPER(in, out) \
+    static inline void (*GET_WORK_##in##_to_##out##_sse())(filter_t*, block_t*, block_t*) \
+    { \
+        return vlc_CPU_SSE() ? DoWork_##in##_to_##out##_sse : DoWork_##in##_to_##out; \
+    }
+
+SSE_WRAPPER(7_x,2_0)
+SSE_WRAPPER(6_1,2_0)
+SSE_WRAPPER(5_x,2_0)
+SSE_WRAPPER(7_x,4_0)
+SSE_WRAPPER(5_x,4_0)
+
+/* TODO: the following conversions are not handled in SSE */
+
+#define C_WRAPPER(in, out) \
+    static inline void (*GET_WORK_##in##_to_##out##_sse())(filter_t*, block_t*, block_t*) \
+    { \
+        return DoWork_##in##_to_##out; \
+    }
+
+C_WRAPPER(7_x,1_0)
+C_WRAPPER(5_x,1_0)
+C_WRAPPER(4_0,1_0)
+C_WRAPPER(3_x,1_0)
+C_WRAPPER(2_x,1_0)
+C_WRAPPER(4_0,2_0)
+C_WRAPPER(3_x,2_0)
+C_WRAPPER(7_x,5_x)
+C_WRAPPER(6_1,5_x)
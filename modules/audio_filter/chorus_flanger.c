@@ -43,6 +43,7 @@ typedef struct filter_sys_t filter_sys_t;
 static int  Open     ( vlc_object_t * );
 static void Close    ( vlc_object_t * );
 static block_t *DoWork( filter_t *, block_t * );
+static void Process( filter_t *, float *, unsigned );
 static int paramCallback( vlc_object_t *, char const *, vlc_value_t ,
                           vlc_value_t , void * );
 static int reallocate_buffer( filter_t *, filter_sys_t * );
@@ -198,6 +199,7 @@ static int Open( vlc_object_t *p_this )
     aout_FormatPrepare(&p_filter->fmt_in.audio);
     p_filter->fmt_out.audio = p_filter->fmt_in.audio;
     p_filter->pf_audio_filter = DoWork;
+    p_filter->pf_audio_process = Process;
 
     return VLC_SUCCESS;
 }
@@ -214,20 +216,19 @@ static inline void sanitize( float * f_value )
 
 
 /**
- * DoWork : delays and finds the value of the current frame
+ * Process : delays and finds the value of the current frames, in place
  * @param p_filter This filter object
- * @param p_in_buf Input buffer
- * @return Output buffer
+ * @param p_buf Interleaved samples
+ * @param i_samples Number of samples
  */
-static block_t *DoWork( filter_t *p_filter, block_t *p_in_buf )
+static void Process( filter_t *p_filter, float *p_buf, unsigned i_samples )
 {
     struct filter_sys_t *p_sys = p_filter->p_sys;
     int i_chan;
-    unsigned i_samples = p_in_buf->i_nb_samples; /* number of samples */
     /* maximum number of samples to offset in buffer */
     int i_maxOffset = floorf( p_sys->f_sweepDepth * p_sys->i_sampleRate / 1000 );
-    float *p_out = (float*)p_in_buf->p_buffer;
-    float *p_in =  (float*)p_in_buf->p_buffer;
+    float *p_out = p_buf;
+    float *p_in =  p_buf;
 
     float *p_ptr, f_temp = 0;/* f_diff = 0, f_frac = 0;*/
 
@@ -297,6 +298,17 @@ static block_t *DoWork( filter_t *p_filter, block_t *p_in_buf )
         }
 
     }
+}
+
+/**
+ * DoWork : delays and finds the value of the current frame
+ * @param p_filter This filter object
+ * @param p_in_buf Input buffer
+ * @return Output buffer
+ */
+static block_t *DoWork( filter_t *p_filter, block_t *p_in_buf )
+{
+    Process( p_filter, (float*)p_in_buf->p_buffer, p_in_buf->i_nb_samples );
     return p_in_buf;
 }
 
@@ -39,6 +39,11 @@
 #include <vlc_aout.h>
 #include <vlc_block.h>
 #include <vlc_filter.h>
+#include <vlc_cpu.h>
+
+#ifdef HAVE_SSE2_INTRINSICS
+# include <immintrin.h>
+#endif
 
 /*****************************************************************************
  * Module descriptor
@@ -260,7 +265,7 @@ static block_t *Fl32toS16(filter_t *filter, block_t *b)
         /* Slow version. */
         if (*src >= 1.0) *dst = 32767;
         else if (*src < -1.0) *dst = -32768;
-        else *dst = lroundf(*src * 32768.f);
+        else *dst = lrintf(*src * 32768.f);
         src++; dst++;
 #else
         /* This is Walken's trick based on IEEE float format. */
@@ -291,7 +296,7 @@ static block_t *Fl32toS32(filter_t *filter, block_t *b)
         if (s <= -2147483648.f)
             *(dst++) = -2147483648;
         else
-            *(dst++) = lroundf(s);
+            *(dst++) = lrintf(s);
     }
     VLC_UNUSED(filter);
     return b;
@@ -439,6 +444,138 @@ static block_t *Fl64toS32(filter_t *filter, block_t *b)
 }
 
 
+#ifdef HAVE_SSE2_INTRINSICS
+/*** SSE2 versions of the most common conversions ***/
+__attribute__ ((__target__ ("sse2")))
+static block_t *S16toFl32SSE2(filter_t *filter, block_t *bsrc)
+{
+    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    if (unlikely(bdst == NULL))
+        goto out;
+
+    block_CopyProperties(bdst, bsrc);
+    int16_t *src = (int16_t *)bsrc->p_buffer;
+    float   *dst = (float *)bdst->p_buffer;
+    size_t i = bsrc->i_buffer / 2;
+    const __m128 scale = _mm_set1_ps(1.f / 32768.f);
+
+    for (; i >= 8; i -= 8, src += 8, dst += 8)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i *)src);
+        /* Sign extend to 32 bits */
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+        _mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    for (; i > 0; i--)
+        *dst++ = (float)*src++ / 32768.f;
+out:
+    block_Release(bsrc);
+    VLC_UNUSED(filter);
+    return bdst;
+}
+
+__attribute__ ((__target__ ("sse2")))
+static block_t *Fl32toS16SSE2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    float   *src = (float *)b->p_buffer;
+    int16_t *dst = (int16_t *)src;
+    size_t i = b->i_buffer / 4;
+    const __m128 scale = _mm_set1_ps(32768.f);
+    const __m128 max = _mm_set1_ps(32767.f), min = _mm_set1_ps(-32768.f);
+
+    /* In place: every store lands below the data loaded so far */
+    for (; i >= 8; i -= 8, src += 8, dst += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src), scale);
+        __m128 c = _mm_mul_ps(_mm_loadu_ps(src + 4), scale);
+        a = _mm_max_ps(_mm_min_ps(a, max), min);
+        c = _mm_max_ps(_mm_min_ps(c, max), min);
+        _mm_storeu_si128((__m128i *)dst,
+                         _mm_packs_epi32(_mm_cvtps_epi32(a),
+                                         _mm_cvtps_epi32(c)));
+    }
+    for (; i > 0; i--)
+    {
+        float s = *src++ * 32768.f;
+        if (s >= 32767.f)
+            *dst++ = 32767;
+        else if (s <= -32768.f)
+            *dst++ = -32768;
+        else
+            *dst++ = lrintf(s);
+    }
+    b->i_buffer /= 2;
+    return b;
+}
+
+__attribute__ ((__target__ ("sse2")))
+static block_t *Fl32toS32SSE2(filter_t *filter, block_t *b)
+{
+    float   *src = (float *)b->p_buffer;
+    int32_t *dst = (int32_t *)src;
+    size_t i = b->i_buffer / 4;
+    const __m128 scale = _mm_set1_ps(2147483648.f);
+
+    for (; i >= 4; i -= 4, src += 4, dst += 4)
+    {
+        __m128 s = _mm_mul_ps(_mm_loadu_ps(src), scale);
+        /* Out of range values convert to INT32_MIN: flip the positive ones
+         * to INT32_MAX */
+        __m128i over = _mm_castps_si128(_mm_cmpge_ps(s, scale));
+        _mm_storeu_si128((__m128i *)dst,
+                         _mm_xor_si128(_mm_cvtps_epi32(s), over));
+    }
+    for (; i > 0; i--)
+    {
+        float s = *(src++) * 2147483648.f;
+        if (s >= 2147483647.f)
+            *(dst++) = 2147483647;
+        else
+        if (s <= -2147483648.f)
+            *(dst++) = -2147483648;
+        else
+            *(dst++) = lrintf(s);
+    }
+    VLC_UNUSED(filter);
+    return b;
+}
+
+__attribute__ ((__target__ ("sse2")))
+static block_t *S32toFl32SSE2(filter_t *filter, block_t *b)
+{
+    VLC_UNUSED(filter);
+    int32_t *src = (int32_t*)b->p_buffer;
+    float   *dst = (float *)src;
+    size_t i = b->i_buffer / 4;
+    const __m128 scale = _mm_set1_ps(1.f / 2147483648.f);
+
+    for (; i >= 4; i -= 4, src += 4, dst += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i *)src);
+        _mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(s), scale));
+    }
+    for (; i > 0; i--)
+        *dst++ = (float)(*src++) / 2147483648.f;
+    return b;
+}
+
+static const struct {
+    vlc_fourcc_t src;
+    vlc_fourcc_t dst;
+    cvt_t convert;
+} cvt_sse2[] = {
+    { VLC_CODEC_S16N, VLC_CODEC_FL32, S16toFl32SSE2 },
+    { VLC_CODEC_FL32, VLC_CODEC_S16N, Fl32toS16SSE2 },
+    { VLC_CODEC_FL32, VLC_CODEC_S32N, Fl32toS32SSE2 },
+    { VLC_CODEC_S32N, VLC_CODEC_FL32, S32toFl32SSE2 },
+
+    { 0, 0, NULL }
+};
+#endif
+
 /* */
 /* */
 static const struct {
@@ -476,6 +613,14 @@ static const struct {
 
 static cvt_t FindConversion(vlc_fourcc_t src, vlc_fourcc_t dst)
 {
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE2())
+        for (int i = 0; cvt_sse2[i].convert; i++) {
+            if (cvt_sse2[i].src == src &&
+                cvt_sse2[i].dst == dst)
+                return cvt_sse2[i].convert;
+        }
+#endif
     for (int i = 0; cvt_directs[i].convert; i++) {
         if (cvt_directs[i].src == src &&
             cvt_directs[i].dst == dst)
@@ -0,0 +1,382 @@
+/*****************************************************************************
+ * convolution.c: partitioned FFT convolution engine for audio filters
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+
+#include "convolution.h"
+
+/*
+ * With a partition size P, each input channel is transformed over a window
+ * of 2P samples: the previous partition followed by the current one, zero
+ * padded while it is incomplete. Each response partition is transformed
+ * zero padded to 2P samples. The last P samples of the inverse transform of
+ * sum(input[n - k] * response[k]) are then the output of partition n.
+ *
+ * The contributions of the previous partitions (k > 0) only change once per
+ * partition, and are accumulated then. Only the current one (k = 0) is
+ * recomputed whenever samples are input.
+ *
+ * Transforms of 2P real samples are computed as complex transforms of P
+ * points, followed by a split into the P + 1 non-redundant bins. Spectra are
+ * stored as interleaved real and imaginary parts.
+ */
+
+struct convolver
+{
+    unsigned inputs;
+    unsigned outputs;
+    unsigned size;  /* partition size */
+    unsigned parts; /* number of partitions per response */
+    unsigned fill;  /* samples of the current partition already input */
+    unsigned head;  /* spectra slot of the current partition */
+
+    unsigned *reverse; /* bit reversal permutation */
+    float *twiddles;   /* exp(-2i.pi.k / P), k < P / 2 */
+    float *split;      /* exp(-2i.pi.k / 2P), k <= P */
+
+    float *windows;    /* [input][2P] time domain samples */
+    float *spectra;    /* [input][part][P + 1] input spectra, circular */
+    float *responses;  /* [input][output][part][P + 1] response spectra */
+    bool *active;      /* [input][output] non null responses */
+    float *sums;       /* [output][P + 1] previous partitions spectra */
+    float *spectrum;   /* [P + 1] current output spectrum, or scratch */
+    float *work;       /* [2P] transform work area */
+};
+
+static inline size_t Bins(const convolver_t *c)
+{
+    return 2 * (c->size + 1); /* floats per spectrum */
+}
+
+static float *InputSpectrum(const convolver_t *c, unsigned input,
+                            unsigned slot)
+{
+    return c->spectra + (input * c->parts + slot) * Bins(c);
+}
+
+static float *ResponseSpectrum(const convolver_t *c, unsigned input,
+                               unsigned output, unsigned part)
+{
+    return c->responses
+         + ((input * c->outputs + output) * c->parts + part) * Bins(c);
+}
+
+/* In place complex transform of P points */
+static void FFT(const convolver_t *c, float *data, bool inverse)
+{
+    const unsigned n = c->size;
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        unsigned j = c->reverse[i];
+        if (i < j)
+        {
+            float r = data[2 * i], im = data[2 * i + 1];
+            data[2 * i] = data[2 * j];
+            data[2 * i + 1] = data[2 * j + 1];
+            data[2 * j] = r;
+            data[2 * j + 1] = im;
+        }
+    }
+
+    const float sign = inverse ? -1.f : 1.f;
+
+    for (unsigned len = 2; len <= n; len *= 2)
+    {
+        const unsigned half = len / 2, step = n / len;
+
+        for (unsigned j = 0; j < half; j++)
+        {
+            const float wr = c->twiddles[2 * j * step];
+            const float wi = sign * c->twiddles[2 * j * step + 1];
+
+            for (unsigned i = j; i < n; i += len)
+            {
+                float *a = data + 2 * i, *b = a + 2 * half;
+                const float tr = b[0] * wr - b[1] * wi;
+                const float ti = b[0] * wi + b[1] * wr;
+
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+
+/* Transforms 2P real samples into P + 1 bins */
+static void RealFFT(const convolver_t *c, const float *in, float *out)
+{
+    const unsigned n = c->size;
+    float *z = c->work;
+
+    memcpy(z, in, 2 * n * sizeof (*z));
+    FFT(c, z, false);
+
+    for (unsigned k = 0; k <= n; k++)
+    {
+        const unsigned a = k % n, b = (n - k) % n;
+        /* Even and odd samples spectra */
+        const float er = (z[2 * a] + z[2 * b]) * .5f;
+        const float ei = (z[2 * a + 1] - z[2 * b + 1]) * .5f;
+        const float xr = (z[2 * a + 1] + z[2 * b + 1]) * .5f;
+        const float xi = (z[2 * b] - z[2 * a]) * .5f;
+        const float wr = c->split[2 * k], wi = c->split[2 * k + 1];
+
+        out[2 * k] = er + xr * wr - xi * wi;
+        out[2 * k + 1] = ei + xr * wi + xi * wr;
+    }
+}
+
+/* Transforms P + 1 bins back into 2P real samples, scaled by P */
+static void RealIFFT(const convolver_t *c, const float *in, float *out)
+{
+    const unsigned n = c->size;
+
+    for (unsigned k = 0; k < n; k++)
+    {
+        const float *a = in + 2 * k, *b = in + 2 * (n - k);
+        const float er = (a[0] + b[0]) * .5f, ei = (a[1] - b[1]) * .5f;
+        const float dr = (a[0] - b[0]) * .5f, di = (a[1] + b[1]) * .5f;
+        /* Odd samples spectrum: difference times exp(2i.pi.k / 2P) */
+        const float wr = c->split[2 * k], wi = -c->split[2 * k + 1];
+        const float xr = dr * wr - di * wi, xi = dr * wi + di * wr;
+
+        out[2 * k] = er - xi;
+        out[2 * k + 1] = ei + xr;
+    }
+    FFT(c, out, true);
+}
+
+static void MultiplyAdd(float *restrict acc, const float *restrict a,
+                        const float *restrict b, size_t bins)
+{
+    for (size_t k = 0; k < bins; k += 2)
+    {
+        acc[k] += a[k] * b[k] - a[k + 1] * b[k + 1];
+        acc[k + 1] += a[k] * b[k + 1] + a[k + 1] * b[k];
+    }
+}
+
+/* Sums the contributions of the previous partitions */
+static void Accumulate(convolver_t *c)
+{
+    for (unsigned o = 0; o < c->outputs; o++)
+    {
+        float *sum = c->sums + o * Bins(c);
+
+        memset(sum, 0, Bins(c) * sizeof (*sum));
+        for (unsigned i = 0; i < c->inputs; i++)
+        {
+            if (!c->active[i * c->outputs + o])
+                continue;
+
+            for (unsigned k = 1; k < c->parts; k++)
+                MultiplyAdd(sum, InputSpectrum(c, i,
+                                               (c->head + c->parts - k)
+                                               % c->parts),
+                            ResponseSpectrum(c, i, o, k), Bins(c));
+        }
+    }
+}
+
+convolver_t *convolver_New(unsigned inputs, unsigned outputs,
+                           unsigned partition, unsigned taps)
+{
+    assert(partition >= 4 && (partition & (partition - 1)) == 0);
+    assert(inputs > 0 && outputs > 0 && taps > 0);
+
+    convolver_t *c = malloc(sizeof (*c));
+    if (unlikely(c == NULL))
+        return NULL;
+
+    c->inputs = inputs;
+    c->outputs = outputs;
+    c->size = partition;
+    c->parts = (taps + partition - 1) / partition;
+
+    const size_t bins = Bins(c);
+
+    c->reverse = vlc_alloc(partition, sizeof (*c->reverse));
+    c->twiddles = vlc_alloc(partition, sizeof (*c->twiddles));
+    c->split = vlc_alloc(bins, sizeof (*c->split));
+    c->windows = vlc_alloc(inputs * 2 * partition, sizeof (*c->windows));
+    c->spectra = vlc_alloc(inputs * c->parts * bins, sizeof (*c->spectra));
+    c->responses = calloc((size_t)inputs * outputs * c->parts * bins,
+                          sizeof (*c->responses));
+    c->active = calloc(inputs * outputs, sizeof (*c->active));
+    c->sums = vlc_alloc(outputs * bins, sizeof (*c->sums));
+    c->spectrum = vlc_alloc(bins, sizeof (*c->spectrum));
+    c->work = vlc_alloc(2 * partition, sizeof (*c->work));
+
+    if (unlikely(c->reverse == NULL || c->twiddles == NULL
+              || c->split == NULL || c->windows == NULL
+              || c->spectra == NULL || c->responses == NULL
+              || c->active == NULL || c->sums == NULL
+              || c->spectrum == NULL || c->work == NULL))
+    {
+        convolver_Delete(c);
+        return NULL;
+    }
+
+    unsigned bits = 0;
+    while ((1u << bits) < partition)
+        bits++;
+    for (unsigned i = 0; i < partition; i++)
+    {
+        unsigned r = 0;
+        for (unsigned b = 0; b < bits; b++)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        c->reverse[i] = r;
+    }
+    for (unsigned k = 0; k < partition / 2; k++)
+    {
+        c->twiddles[2 * k] = cos(2. * M_PI * k / partition);
+        c->twiddles[2 * k + 1] = -sin(2. * M_PI * k / partition);
+    }
+    for (unsigned k = 0; k <= partition; k++)
+    {
+        c->split[2 * k] = cos(M_PI * k / partition);
+        c->split[2 * k + 1] = -sin(M_PI * k / partition);
+    }
+
+    convolver_Reset(c);
+    return c;
+}
+
+void convolver_Delete(convolver_t *c)
+{
+    free(c->work);
+    free(c->spectrum);
+    free(c->sums);
+    free(c->active);
+    free(c->responses);
+    free(c->spectra);
+    free(c->windows);
+    free(c->split);
+    free(c->twiddles);
+    free(c->reverse);
+    free(c);
+}
+
+void convolver_Reset(convolver_t *c)
+{
+    const size_t bins = Bins(c);
+
+    memset(c->windows, 0, c->inputs * 2 * c->size * sizeof (*c->windows));
+    memset(c->spectra, 0, c->inputs * c->parts * bins * sizeof (*c->spectra));
+    memset(c->sums, 0, c->outputs * bins * sizeof (*c->sums));
+    c->fill = 0;
+    c->head = 0;
+}
+
+void convolver_SetResponse(convolver_t *c, unsigned input, unsigned output,
+                           const float *response, unsigned taps)
+{
+    assert(input < c->inputs && output < c->outputs);
+    assert(taps <= c->parts * c->size);
+
+    c->active[input * c->outputs + output] = response != NULL && taps > 0;
+
+    /* The inverse transforms are scaled by P: compensate here */
+    const float scale = 1.f / c->size;
+    /* Zero padded partition, in the spare output spectrum */
+    float *window = c->spectrum;
+
+    for (unsigned k = 0; k < c->parts; k++)
+    {
+        unsigned offset = k * c->size, count = 0;
+
+        if (response != NULL && offset < taps)
+            count = __MIN(taps - offset, c->size);
+
+        for (unsigned i = 0; i < count; i++)
+            window[i] = response[offset + i] * scale;
+        memset(window + count, 0, (2 * c->size - count) * sizeof (*window));
+
+        RealFFT(c, window, ResponseSpectrum(c, input, output, k));
+    }
+
+    /* Apply it to the samples already input */
+    Accumulate(c);
+}
+
+void convolver_Process(convolver_t *c, const float *in, float *out,
+                       unsigned samples)
+{
+    const size_t bins = Bins(c);
+
+    while (samples > 0)
+    {
+        const unsigned n = __MIN(c->size - c->fill, samples);
+
+        for (unsigned i = 0; i < c->inputs; i++)
+        {
+            float *window = c->windows + i * 2 * c->size;
+
+            for (unsigned s = 0; s < n; s++)
+                window[c->size + c->fill + s] = in[s * c->inputs + i];
+            RealFFT(c, window, InputSpectrum(c, i, c->head));
+        }
+
+        for (unsigned o = 0; o < c->outputs; o++)
+        {
+            memcpy(c->spectrum, c->sums + o * bins,
+                   bins * sizeof (*c->spectrum));
+            for (unsigned i = 0; i < c->inputs; i++)
+                if (c->active[i * c->outputs + o])
+                    MultiplyAdd(c->spectrum, InputSpectrum(c, i, c->head),
+                                ResponseSpectrum(c, i, o, 0), bins);
+
+            RealIFFT(c, c->spectrum, c->work);
+
+            const float *result = c->work + c->size + c->fill;
+            for (unsigned s = 0; s < n; s++)
+                out[s * c->outputs + o] = result[s];
+        }
+
+        c->fill += n;
+        in += n * c->inputs;
+        out += n * c->outputs;
+        samples -= n;
+
+        if (c->fill == c->size)
+        {   /* Partition complete: move on to the next one */
+            for (unsigned i = 0; i < c->inputs; i++)
+            {
+                float *window = c->windows + i * 2 * c->size;
+
+                memcpy(window, window + c->size, c->size * sizeof (*window));
+                memset(window + c->size, 0, c->size * sizeof (*window));
+            }
+            c->head = (c->head + 1) % c->parts;
+            c->fill = 0;
+            Accumulate(c);
+        }
+    }
+}
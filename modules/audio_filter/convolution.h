@@ -0,0 +1,82 @@
+/*****************************************************************************
+ * convolution.h: partitioned FFT convolution engine for audio filters
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_AUDIO_FILTER_CONVOLUTION_H
+#define VLC_AUDIO_FILTER_CONVOLUTION_H 1
+
+/**
+ * Convolves interleaved float samples with a matrix of impulse responses:
+ * each output channel is the sum of every input channel filtered through
+ * its own finite impulse response.
+ *
+ * Responses are cut into partitions of equal size, and filtered in the
+ * frequency domain (uniformly partitioned overlap-save). The cost per sample
+ * thus grows with the number of partitions rather than with the number of
+ * taps, and does not depend on how sparse the responses are.
+ *
+ * No latency is added: samples are output as soon as they are input, even
+ * when less than a partition is available.
+ */
+typedef struct convolver convolver_t;
+
+/**
+ * Creates a convolution engine.
+ *
+ * \param inputs number of interleaved input channels
+ * \param outputs number of interleaved output channels
+ * \param partition partition size in samples, a power of two; larger
+ *                  partitions are cheaper per sample for long responses
+ * \param taps maximum length of the impulse responses
+ * \return the engine, with all responses null, or NULL on error
+ */
+convolver_t *convolver_New(unsigned inputs, unsigned outputs,
+                           unsigned partition, unsigned taps);
+
+void convolver_Delete(convolver_t *);
+
+/**
+ * Sets the impulse response from an input channel to an output channel.
+ *
+ * The response is applied from the next processed sample, while previously
+ * input samples are filtered through it.
+ *
+ * \param response taps, or NULL to disconnect the channels
+ * \param taps number of taps, no more than given at creation
+ */
+void convolver_SetResponse(convolver_t *, unsigned input, unsigned output,
+                           const float *response, unsigned taps);
+
+/**
+ * Filters interleaved samples.
+ *
+ * \param in input samples, interleaved with the number of input channels
+ * \param out output samples, interleaved with the number of output channels;
+ *            it must not overlap with the input
+ * \param samples number of samples (per channel)
+ */
+void convolver_Process(convolver_t *, const float *in, float *out,
+                       unsigned samples);
+
+/**
+ * Forgets previously input samples, as after a flush.
+ */
+void convolver_Reset(convolver_t *);
+
+#endif
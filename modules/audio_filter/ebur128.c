@@ -0,0 +1,166 @@
+/*****************************************************************************
+ * ebur128.c : EBU R128 loudness meter filter
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_loudness.h>
+#include <vlc_plugin.h>
+
+/*****************************************************************************
+ * Local prototypes
+ *****************************************************************************/
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+
+static block_t *Filter ( filter_t *, block_t * );
+static void Process ( filter_t *, float *, unsigned );
+
+typedef struct
+{
+    vlc_loudness_meter_t *meter;
+    unsigned i_period; /* frames between updates of the variables */
+    unsigned i_pending; /* frames measured since the last update */
+} filter_sys_t;
+
+#define HELP_TEXT N_("This filter measures the loudness of the audio as per " \
+            "EBU R128, without altering it. The measurements are published " \
+            "as the loudness-momentary, loudness-short-term, " \
+            "loudness-integrated, loudness-range and loudness-true-peak " \
+            "variables of the audio output.")
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+vlc_module_begin ()
+    set_shortname( N_("Loudness meter") )
+    set_description( N_("EBU R128 loudness meter") )
+    set_help( HELP_TEXT )
+    set_category( CAT_AUDIO )
+    set_subcategory( SUBCAT_AUDIO_AFILTER )
+    set_capability( "audio filter", 0 )
+    set_callbacks( Open, Close )
+vlc_module_end ()
+
+static const char *const ppsz_vars[] = {
+    "loudness-momentary", "loudness-short-term", "loudness-integrated",
+    "loudness-range", "loudness-true-peak",
+};
+
+/*****************************************************************************
+ * Open: create the meter
+ *****************************************************************************/
+static int Open( vlc_object_t *obj )
+{
+    filter_t *p_filter = (filter_t *)obj;
+    vlc_object_t *p_aout = p_filter->obj.parent;
+    filter_sys_t *p_sys;
+
+    if( p_filter->fmt_in.audio.i_format != VLC_CODEC_FL32 ||
+     !AOUT_FMTS_IDENTICAL( &p_filter->fmt_in.audio, &p_filter->fmt_out.audio) )
+        return VLC_EGENERIC;
+
+    p_sys = p_filter->p_sys = malloc( sizeof(filter_sys_t) );
+    if( unlikely(!p_sys) )
+        return VLC_ENOMEM;
+
+    p_sys->meter = vlc_loudness_meter_New( &p_filter->fmt_in.audio );
+    if( p_sys->meter == NULL )
+    {
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+    /* As often as the measurements can change */
+    p_sys->i_period = p_filter->fmt_in.audio.i_rate / 10;
+    p_sys->i_pending = 0;
+
+    for( size_t i = 0; i < ARRAY_SIZE(ppsz_vars); i++ )
+    {
+        var_Create( p_aout, ppsz_vars[i], VLC_VAR_FLOAT );
+        var_SetFloat( p_aout, ppsz_vars[i], -INFINITY );
+    }
+
+    p_filter->pf_audio_filter = Filter;
+    p_filter->pf_audio_process = Process;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Process: measure the samples, and publish the measurements
+ *****************************************************************************/
+static void Process( filter_t *p_filter, float *p_samples, unsigned i_samples )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    vlc_object_t *p_aout = p_filter->obj.parent;
+    struct vlc_loudness_report report;
+
+    vlc_loudness_meter_Process( p_sys->meter, p_samples, i_samples );
+
+    p_sys->i_pending += i_samples;
+    if( p_sys->i_pending < p_sys->i_period )
+        return;
+    p_sys->i_pending = 0;
+
+    vlc_loudness_meter_Get( p_sys->meter, &report );
+
+    var_SetFloat( p_aout, "loudness-momentary", report.momentary );
+    var_SetFloat( p_aout, "loudness-short-term", report.short_term );
+    var_SetFloat( p_aout, "loudness-integrated", report.integrated );
+    var_SetFloat( p_aout, "loudness-range", report.range );
+    var_SetFloat( p_aout, "loudness-true-peak", report.true_peak );
+}
+
+static block_t *Filter( filter_t *p_filter, block_t *p_block )
+{
+    Process( p_filter, (float *)p_block->p_buffer, p_block->i_nb_samples );
+    return p_block;
+}
+
+/*****************************************************************************
+ * Close: report the measurements and destroy the meter
+ *****************************************************************************/
+static void Close( vlc_object_t *obj )
+{
+    filter_t *p_filter = (filter_t *)obj;
+    vlc_object_t *p_aout = p_filter->obj.parent;
+    filter_sys_t *p_sys = p_filter->p_sys;
+    struct vlc_loudness_report report;
+
+    vlc_loudness_meter_Get( p_sys->meter, &report );
+    msg_Dbg( p_filter, "integrated loudness %.1f LUFS, range %.1f LU, "
+             "true peak %.1f dBTP", report.integrated, report.range,
+             report.true_peak );
+
+    for( size_t i = 0; i < ARRAY_SIZE(ppsz_vars); i++ )
+        var_Destroy( p_aout, ppsz_vars[i] );
+
+    vlc_loudness_meter_Delete( p_sys->meter );
+    free( p_sys );
+}
@@ -126,6 +126,7 @@ typedef struct
 } filter_sys_t;
 
 static block_t *DoWork( filter_t *, block_t * );
+static void Process( filter_t *, float *, unsigned );
 
 #define EQZ_IN_FACTOR (0.25f)
 static int  EqzInit( filter_t *, int );
@@ -167,6 +168,7 @@ static int Open( vlc_object_t *p_this )
     aout_FormatPrepare(&p_filter->fmt_in.audio);
     p_filter->fmt_out.audio = p_filter->fmt_in.audio;
     p_filter->pf_audio_filter = DoWork;
+    p_filter->pf_audio_process = Process;
 
     return VLC_SUCCESS;
 }
@@ -189,11 +191,16 @@ static void Close( vlc_object_t *p_this )
  *****************************************************************************
  *
  *****************************************************************************/
-static block_t * DoWork( filter_t * p_filter, block_t * p_in_buf )
+static void Process( filter_t * p_filter, float * p_samples,
+                     unsigned i_samples )
 {
-    EqzFilter( p_filter, (float*)p_in_buf->p_buffer,
-               (float*)p_in_buf->p_buffer, p_in_buf->i_nb_samples,
+    EqzFilter( p_filter, p_samples, p_samples, i_samples,
                aout_FormatNbChannels( &p_filter->fmt_in.audio ) );
+}
+
+static block_t * DoWork( filter_t * p_filter, block_t * p_in_buf )
+{
+    Process( p_filter, (float*)p_in_buf->p_buffer, p_in_buf->i_nb_samples );
     return p_in_buf;
 }
 
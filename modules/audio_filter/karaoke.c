@@ -40,6 +40,7 @@ vlc_module_begin ()
 vlc_module_end ()
 
 static block_t *Process (filter_t *, block_t *);
+static void ProcessSamples (filter_t *, float *, unsigned);
 
 static int Open (vlc_object_t *obj)
 {
@@ -55,15 +56,15 @@ static int Open (vlc_object_t *obj)
     aout_FormatPrepare(&filter->fmt_in.audio);
     filter->fmt_out.audio = filter->fmt_in.audio;
     filter->pf_audio_filter = Process;
+    filter->pf_audio_process = ProcessSamples;
     return VLC_SUCCESS;
 }
 
-static block_t *Process (filter_t *filter, block_t *block)
+static void ProcessSamples (filter_t *filter, float *spl, unsigned samples)
 {
     const float factor = .70710678 /* 1. / sqrtf (2) */;
-    float *spl = (float *)block->p_buffer;
 
-    for (unsigned i = block->i_nb_samples; i > 0; i--)
+    for (unsigned i = samples; i > 0; i--)
     {
         float s = (spl[0] - spl[1]) * factor;
 
@@ -72,5 +73,10 @@ static block_t *Process (filter_t *filter, block_t *block)
         /* TODO: set output format to mono */
     }
     (void) filter;
+}
+
+static block_t *Process (filter_t *filter, block_t *block)
+{
+    ProcessSamples (filter, (float *)block->p_buffer, block->i_nb_samples);
     return block;
 }
@@ -47,6 +47,7 @@ static void CalcShelfEQCoeffs( float, float, float, int, float, float * );
 static void ProcessEQ( const float *, float *, float *, unsigned, unsigned,
                        const float *, unsigned );
 static block_t *DoWork( filter_t *, block_t * );
+static void Process( filter_t *, float *, unsigned );
 
 vlc_module_begin ()
     set_description( N_("Parametric Equalizer") )
@@ -116,6 +117,7 @@ static int Open( vlc_object_t *p_this )
     p_filter->fmt_in.audio.i_format = VLC_CODEC_FL32;
     p_filter->fmt_out.audio = p_filter->fmt_in.audio;
     p_filter->pf_audio_filter = DoWork;
+    p_filter->pf_audio_process = Process;
 
     p_sys->f_lowf = var_InheritFloat( p_this, "param-eq-lowf");
     p_sys->f_lowgain = var_InheritFloat( p_this, "param-eq-lowgain");
@@ -165,13 +167,18 @@ static void Close( vlc_object_t *p_this )
  *****************************************************************************
  *
  *****************************************************************************/
-static block_t *DoWork( filter_t * p_filter, block_t * p_in_buf )
+static void Process( filter_t * p_filter, float * p_samples,
+                     unsigned i_samples )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    ProcessEQ( (float*)p_in_buf->p_buffer, (float*)p_in_buf->p_buffer,
-               p_sys->p_state,
-               p_filter->fmt_in.audio.i_channels, p_in_buf->i_nb_samples,
+    ProcessEQ( p_samples, p_samples, p_sys->p_state,
+               p_filter->fmt_in.audio.i_channels, i_samples,
                p_sys->coeffs, 5 );
+}
+
+static block_t *DoWork( filter_t * p_filter, block_t * p_in_buf )
+{
+    Process( p_filter, (float*)p_in_buf->p_buffer, p_in_buf->i_nb_samples );
     return p_in_buf;
 }
 
@@ -0,0 +1,553 @@
+/*****************************************************************************
+ * polyphase.c : polyphase FIR audio resampler
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Each output sample is the dot product of the input history with one phase
+ * of a Kaiser-windowed sinc low-pass filter. The filter is tabulated for a
+ * fixed number of phases, and the coefficients of the two closest phases are
+ * linearly interpolated, so that any ratio can be used, and changed on every
+ * block (as aout_DecSynchronize() does to correct the drift).
+ *
+ * The input is kept deinterleaved, so that the inner products work on
+ * contiguous memory, with SSE, AVX or NEON when available.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_plugin.h>
+#include <vlc_cpu.h>
+
+#if defined(HAVE_SSE2_INTRINSICS)
+# include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define HAVE_NEON_INTRINSICS 1
+#endif
+
+#define QUALITY_TEXT N_("Resampling quality")
+#define QUALITY_LONGTEXT N_("Resampling quality, from fastest to best")
+
+static const int quality_values[] = { 0, 1, 2 };
+static const char *const quality_texts[] = {
+    N_("Fast"), N_("Medium"), N_("High"),
+};
+
+/* Number of taps must be a multiple of 8, for the vector kernels */
+static const struct
+{
+    unsigned taps;
+    unsigned phases;
+    double   rolloff; /* pass band, relative to the Nyquist frequency */
+    double   beta;    /* Kaiser window shape */
+} presets[] = {
+    { 16,  64, 0.85,  6. },
+    { 32, 128, 0.91,  8. },
+    { 64, 256, 0.95, 10. },
+};
+
+static int OpenConverter(vlc_object_t *);
+static int OpenResampler(vlc_object_t *);
+static void Close(vlc_object_t *);
+
+vlc_module_begin ()
+    set_shortname (N_("Polyphase resampler"))
+    set_description (N_("Polyphase FIR audio resampler"))
+    set_category (CAT_AUDIO)
+    set_subcategory (SUBCAT_AUDIO_RESAMPLER)
+    add_integer ("polyphase-resampler-quality", 1,
+                 QUALITY_TEXT, QUALITY_LONGTEXT, true)
+        change_integer_list (quality_values, quality_texts)
+    set_capability ("audio converter", 30)
+    set_callbacks (OpenConverter, Close)
+
+    add_submodule ()
+    set_capability ("audio resampler", 30)
+    set_callbacks (OpenResampler, Close)
+    add_shortcut ("polyphase")
+vlc_module_end ()
+
+typedef struct
+{
+    unsigned taps;
+    unsigned phases;
+    double   rolloff;
+    double   beta;
+    double   cutoff;   /* cutoff of the tabulated filter, relative to Nyquist */
+
+    float   *coeffs;   /* phases + 1 rows of taps coefficients */
+    float   *scratch;  /* coefficients interpolated between two phases */
+
+    float   *history;  /* one row of capacity samples per channel */
+    size_t   capacity;
+    size_t   avail;    /* samples per channel in the history */
+    uint64_t pos;      /* start of the next output window, 32.32 fixed point */
+
+    vlc_tick_t end_pts;
+
+    float (*dot)(const float *, const float *, unsigned);
+    void (*lerp)(float *, const float *, const float *, float, unsigned);
+} filter_sys_t;
+
+/*****************************************************************************
+ * Kernels
+ *****************************************************************************/
+static float DotC(const float *a, const float *b, unsigned n)
+{
+    float s0 = 0.f, s1 = 0.f, s2 = 0.f, s3 = 0.f;
+
+    for (unsigned i = 0; i < n; i += 4)
+    {
+        s0 += a[i + 0] * b[i + 0];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+static void LerpC(float *dst, const float *a, const float *b, float mu,
+                  unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+        dst[i] = a[i] + mu * (b[i] - a[i]);
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+VLC_SSE
+static float DotSSE(const float *a, const float *b, unsigned n)
+{
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                       _mm_load_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                       _mm_load_ps(b + i + 4)));
+    }
+    s0 = _mm_add_ps(s0, s1);
+    s0 = _mm_add_ps(s0, _mm_movehl_ps(s0, s0));
+    s0 = _mm_add_ss(s0, _mm_shuffle_ps(s0, s0, 1));
+    return _mm_cvtss_f32(s0);
+}
+
+VLC_SSE
+static void LerpSSE(float *dst, const float *a, const float *b, float mu,
+                    unsigned n)
+{
+    const __m128 m = _mm_set1_ps(mu);
+
+    for (unsigned i = 0; i < n; i += 4)
+    {
+        __m128 va = _mm_load_ps(a + i);
+        __m128 vb = _mm_load_ps(b + i);
+        _mm_store_ps(dst + i,
+                     _mm_add_ps(va, _mm_mul_ps(m, _mm_sub_ps(vb, va))));
+    }
+}
+
+__attribute__ ((__target__ ("avx")))
+static float DotAVX(const float *a, const float *b, unsigned n)
+{
+    __m256 s = _mm256_setzero_ps();
+
+    for (unsigned i = 0; i < n; i += 8)
+        s = _mm256_add_ps(s, _mm256_mul_ps(_mm256_loadu_ps(a + i),
+                                           _mm256_load_ps(b + i)));
+
+    __m128 s4 = _mm_add_ps(_mm256_castps256_ps128(s),
+                           _mm256_extractf128_ps(s, 1));
+    s4 = _mm_add_ps(s4, _mm_movehl_ps(s4, s4));
+    s4 = _mm_add_ss(s4, _mm_shuffle_ps(s4, s4, 1));
+    return _mm_cvtss_f32(s4);
+}
+
+__attribute__ ((__target__ ("avx")))
+static void LerpAVX(float *dst, const float *a, const float *b, float mu,
+                    unsigned n)
+{
+    const __m256 m = _mm256_set1_ps(mu);
+
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        __m256 va = _mm256_load_ps(a + i);
+        __m256 vb = _mm256_load_ps(b + i);
+        _mm256_store_ps(dst + i, _mm256_add_ps(va,
+                        _mm256_mul_ps(m, _mm256_sub_ps(vb, va))));
+    }
+}
+#endif
+
+#ifdef HAVE_NEON_INTRINSICS
+static float DotNEON(const float *a, const float *b, unsigned n)
+{
+    float32x4_t s0 = vdupq_n_f32(0.f), s1 = vdupq_n_f32(0.f);
+
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        s0 = vmlaq_f32(s0, vld1q_f32(a + i), vld1q_f32(b + i));
+        s1 = vmlaq_f32(s1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    s0 = vaddq_f32(s0, s1);
+    float32x2_t s = vadd_f32(vget_low_f32(s0), vget_high_f32(s0));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+
+static void LerpNEON(float *dst, const float *a, const float *b, float mu,
+                     unsigned n)
+{
+    for (unsigned i = 0; i < n; i += 4)
+    {
+        float32x4_t va = vld1q_f32(a + i);
+        float32x4_t vb = vld1q_f32(b + i);
+        vst1q_f32(dst + i, vmlaq_n_f32(va, vsubq_f32(vb, va), mu));
+    }
+}
+#endif
+
+/*****************************************************************************
+ * Filter design
+ *****************************************************************************/
+static double BesselI0(double x)
+{
+    double sum = 1., term = 1.;
+    const double q = x * x / 4.;
+
+    for (unsigned k = 1; term > sum * 1e-12; k++)
+    {
+        term *= q / ((double)k * k);
+        sum += term;
+    }
+    return sum;
+}
+
+/* Tabulates the filter for a cutoff relative to the input Nyquist frequency.
+ * Row p holds the taps for an output sample p / phases input samples after
+ * the center of the window; every row is normalized to a unity DC gain. */
+static void BuildTable(filter_sys_t *sys, double cutoff)
+{
+    const unsigned taps = sys->taps;
+    const double half = taps / 2;
+    const double i0beta = BesselI0(sys->beta);
+
+    for (unsigned p = 0; p <= sys->phases; p++)
+    {
+        float *row = sys->coeffs + p * taps;
+        double coeffs[taps], sum = 0.;
+
+        for (unsigned k = 0; k < taps; k++)
+        {
+            const double d = k - half + 1. - (double)p / sys->phases;
+            const double x = d / half;
+            double c = 0.;
+
+            if (fabs(x) < 1.)
+            {
+                const double t = M_PI * cutoff * d;
+                c = cutoff * (d != 0. ? sin(t) / t : 1.)
+                  * BesselI0(sys->beta * sqrt(1. - x * x)) / i0beta;
+            }
+            coeffs[k] = c;
+            sum += c;
+        }
+        for (unsigned k = 0; k < taps; k++)
+            row[k] = coeffs[k] / sum;
+    }
+    sys->cutoff = cutoff;
+}
+
+static double GetCutoff(const filter_sys_t *sys, unsigned irate,
+                        unsigned orate)
+{
+    double cutoff = sys->rolloff;
+
+    /* Reject what cannot be represented at the output rate */
+    if (orate < irate)
+        cutoff = cutoff * orate / irate;
+    return cutoff;
+}
+
+/*****************************************************************************
+ * Processing
+ *****************************************************************************/
+static void Reset(filter_sys_t *sys, unsigned channels)
+{
+    /* Prime the window so that the first output matches the first input */
+    sys->avail = sys->taps / 2 - 1;
+    for (unsigned c = 0; c < channels; c++)
+        memset(sys->history + c * sys->capacity, 0,
+               sys->avail * sizeof (float));
+    sys->pos = 0;
+    sys->end_pts = VLC_TICK_INVALID;
+}
+
+static int Append(filter_sys_t *sys, unsigned channels, const float *in,
+                  size_t frames)
+{
+    if (sys->avail + frames > sys->capacity)
+    {
+        size_t capacity = sys->avail + frames + sys->taps;
+        float *history = vlc_alloc(capacity * channels, sizeof (float));
+        if (unlikely(history == NULL))
+            return VLC_ENOMEM;
+
+        for (unsigned c = 0; c < channels; c++)
+            memcpy(history + c * capacity, sys->history + c * sys->capacity,
+                   sys->avail * sizeof (float));
+        free(sys->history);
+        sys->history = history;
+        sys->capacity = capacity;
+    }
+
+    for (unsigned c = 0; c < channels; c++)
+    {
+        float *dst = sys->history + c * sys->capacity + sys->avail;
+
+        if (in != NULL)
+            for (size_t i = 0; i < frames; i++)
+                dst[i] = in[i * channels + c];
+        else
+            memset(dst, 0, frames * sizeof (float));
+    }
+    sys->avail += frames;
+    return VLC_SUCCESS;
+}
+
+static block_t *Process(filter_t *filter, const float *in, size_t frames)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned channels = filter->fmt_in.audio.i_channels;
+    const unsigned irate = filter->fmt_in.audio.i_rate;
+    const unsigned orate = filter->fmt_out.audio.i_rate;
+    const unsigned taps = sys->taps;
+
+    /* The input rate changes when the aout corrects the drift */
+    double cutoff = GetCutoff(sys, irate, orate);
+    if (fabs(cutoff - sys->cutoff) > sys->cutoff * 0.02)
+        BuildTable(sys, cutoff);
+
+    if (Append(sys, channels, in, frames))
+        return NULL;
+
+    const uint64_t step = ((uint64_t)irate << 32) / orate;
+    size_t olen = 0;
+
+    if (sys->avail >= taps)
+    {
+        const uint64_t limit = (uint64_t)(sys->avail - taps + 1) << 32;
+        if (limit > sys->pos)
+            olen = (limit - sys->pos + step - 1) / step;
+    }
+
+    if (olen == 0)
+        return NULL;
+
+    block_t *out = block_Alloc(olen * channels * sizeof (float));
+    if (unlikely(out == NULL))
+        return NULL;
+
+    float *dst = (float *)out->p_buffer;
+    uint64_t pos = sys->pos;
+
+    for (size_t n = 0; n < olen; n++)
+    {
+        const size_t start = pos >> 32;
+        const uint64_t frac = (pos & UINT32_MAX) * sys->phases;
+        const float *row = sys->coeffs + (frac >> 32) * taps;
+        const float mu = (uint32_t)frac * (1.f / 4294967296.f);
+
+        sys->lerp(sys->scratch, row, row + taps, mu, taps);
+        for (unsigned c = 0; c < channels; c++)
+            *(dst++) = sys->dot(sys->history + c * sys->capacity + start,
+                                sys->scratch, taps);
+        pos += step;
+    }
+
+    /* Drop the samples no window will use anymore */
+    size_t used = pos >> 32;
+    if (used > sys->avail)
+        used = sys->avail;
+    for (unsigned c = 0; c < channels; c++)
+    {
+        float *row = sys->history + c * sys->capacity;
+        memmove(row, row + used, (sys->avail - used) * sizeof (float));
+    }
+    sys->avail -= used;
+    sys->pos = pos - ((uint64_t)used << 32);
+
+    out->i_nb_samples = olen;
+    out->i_length = olen * CLOCK_FREQ / orate;
+    return out;
+}
+
+static block_t *Resample(filter_t *filter, block_t *in)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    if (in->i_nb_samples == 0)
+    {
+        block_Release(in);
+        return NULL;
+    }
+
+    block_t *out = Process(filter, (const float *)in->p_buffer,
+                           in->i_nb_samples);
+    if (out != NULL)
+    {
+        out->i_pts = in->i_pts;
+        out->i_dts = in->i_dts;
+        out->i_flags = in->i_flags;
+    }
+    if (in->i_pts != VLC_TICK_INVALID)
+        sys->end_pts = in->i_pts + in->i_length;
+    block_Release(in);
+    return out;
+}
+
+static block_t *Drain(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    /* Push the end of the stream through the filter with silence */
+    block_t *out = Process(filter, NULL, sys->taps / 2);
+    if (out != NULL)
+        out->i_pts = out->i_dts = sys->end_pts;
+    Reset(sys, filter->fmt_in.audio.i_channels);
+    return out;
+}
+
+static void Flush(filter_t *filter)
+{
+    Reset(filter->p_sys, filter->fmt_in.audio.i_channels);
+}
+
+/*****************************************************************************
+ * Module callbacks
+ *****************************************************************************/
+static int Open(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    /* Cannot convert format */
+    if (filter->fmt_in.audio.i_format != VLC_CODEC_FL32
+     || filter->fmt_out.audio.i_format != VLC_CODEC_FL32
+    /* Cannot remix */
+     || filter->fmt_in.audio.i_channels != filter->fmt_out.audio.i_channels
+     || filter->fmt_in.audio.i_channels == 0)
+        return VLC_EGENERIC;
+
+    filter_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    int64_t q = var_InheritInteger(obj, "polyphase-resampler-quality");
+    if (q < 0)
+        q = 0;
+    else if (q >= (int64_t)ARRAY_SIZE(presets))
+        q = ARRAY_SIZE(presets) - 1;
+
+    sys->taps = presets[q].taps;
+    sys->phases = presets[q].phases;
+    sys->rolloff = presets[q].rolloff;
+    sys->beta = presets[q].beta;
+
+    /* Aligned for the vector kernels */
+    sys->coeffs = aligned_alloc(32, (sys->phases + 1) * sys->taps
+                                    * sizeof (float));
+    sys->scratch = aligned_alloc(32, sys->taps * sizeof (float));
+    sys->capacity = 4096;
+    sys->history = vlc_alloc(sys->capacity * filter->fmt_in.audio.i_channels,
+                             sizeof (float));
+    if (unlikely(sys->coeffs == NULL || sys->scratch == NULL
+              || sys->history == NULL))
+    {
+        aligned_free(sys->coeffs);
+        aligned_free(sys->scratch);
+        free(sys->history);
+        free(sys);
+        return VLC_ENOMEM;
+    }
+
+    BuildTable(sys, GetCutoff(sys, filter->fmt_in.audio.i_rate,
+                              filter->fmt_out.audio.i_rate));
+    Reset(sys, filter->fmt_in.audio.i_channels);
+
+    sys->dot = DotC;
+    sys->lerp = LerpC;
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_AVX())
+    {
+        sys->dot = DotAVX;
+        sys->lerp = LerpAVX;
+    }
+    else if (vlc_CPU_SSE())
+    {
+        sys->dot = DotSSE;
+        sys->lerp = LerpSSE;
+    }
+#endif
+#ifdef HAVE_NEON_INTRINSICS
+    sys->dot = DotNEON;
+    sys->lerp = LerpNEON;
+#endif
+
+    msg_Dbg(filter, "%u taps, %u phases, %uHz to %uHz", sys->taps,
+            sys->phases, filter->fmt_in.audio.i_rate,
+            filter->fmt_out.audio.i_rate);
+
+    filter->p_sys = sys;
+    filter->pf_audio_filter = Resample;
+    filter->pf_audio_drain = Drain;
+    filter->pf_flush = Flush;
+    return VLC_SUCCESS;
+}
+
+static int OpenResampler(vlc_object_t *obj)
+{
+    return Open(obj);
+}
+
+static int OpenConverter(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    /* Will change rate */
+    if (filter->fmt_in.audio.i_rate == filter->fmt_out.audio.i_rate)
+        return VLC_EGENERIC;
+    return Open(obj);
+}
+
+static void Close(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+    filter_sys_t *sys = filter->p_sys;
+
+    aligned_free(sys->coeffs);
+    aligned_free(sys->scratch);
+    free(sys->history);
+    free(sys);
+}
@@ -32,11 +32,18 @@
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_atomic.h>
+#include <vlc_cpu.h>
 #include <vlc_filter.h>
 #include <vlc_modules.h>
 
 #include <string.h> /* for memset */
 #include <limits.h> /* form INT_MIN */
+#include <math.h>
+#ifdef HAVE_SSE2_INTRINSICS
+# include <immintrin.h>
+#endif
+
+#include "convolution.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -69,6 +76,8 @@ vlc_module_begin ()
         N_("Overlap Length"), N_("Percentage of stride to overlap"), true )
     add_integer_with_range( "scaletempo-search", 14, 0, 200,
         N_("Search Length"), N_("Length in milliseconds to search for best overlap position"), true )
+    add_bool( "scaletempo-downmix", false,
+        N_("Downmix search"), N_("Search for the best overlap position on the sum of all channels. This is faster with many channels, but less accurate."), true )
 #ifdef PITCH_SHIFTER
     add_float_with_range( "pitch-shift", 0, -12, 12,
         N_("Pitch Shift"), N_("Pitch shift in semitones."), false )
@@ -90,6 +99,12 @@ vlc_module_end ()
  * for the best overlap position.  Scaletempo uses a statistical cross correlation
  * (roughly a dot-product).  Scaletempo consumes most of its CPU cycles here.
  *
+ * The correlation is either computed directly, one (vectorized) dot-product
+ * per position, or for long searches, for all positions at once by a
+ * frequency domain convolution with the reversed overlap. It can also be
+ * computed on the sum of all channels, which makes it cheaper with many
+ * channels.
+ *
  * NOTE:
  * sample: a single audio sample for one channel
  * frame: a single set of samples, one for each channel
@@ -127,8 +142,15 @@ typedef struct
     void    (*output_overlap)( filter_t *p_filter, void *p_out_buf, unsigned bytes_off );
     /* best overlap */
     unsigned  frames_search;
+    unsigned  search_channels;  /* 1 if downmixed, else samples_per_frame */
+    unsigned  samples_pre_corr;
     void     *buf_pre_corr;
     void     *table_window;
+    float    *buf_search;       /* downmixed search window */
+    float    *buf_response;     /* one channel of buf_pre_corr, reversed */
+    float    *buf_corr;         /* correlation at every position */
+    convolver_t *convolver;
+    float   (*dot_product)( const float *, const float *, unsigned );
     unsigned(*best_overlap_offset)( filter_t *p_filter );
 #ifdef PITCH_SHIFTER
     /* pitch */
@@ -137,38 +159,157 @@ typedef struct
 #endif
 } filter_sys_t;
 
+/*****************************************************************************
+ * dot_product: sum of the products of two vectors
+ *****************************************************************************/
+static float dot_product_float( const float *a, const float *b, unsigned n )
+{
+    float corr = 0;
+    for( unsigned i = 0; i < n; i++ )
+        corr += a[i] * b[i];
+    return corr;
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+VLC_SSE
+static float dot_product_float_sse( const float *a, const float *b,
+                                    unsigned n )
+{
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    unsigned i = 0;
+
+    for( ; i + 8 <= n; i += 8 ) {
+        acc0 = _mm_add_ps( acc0, _mm_mul_ps( _mm_loadu_ps( a + i ),
+                                             _mm_loadu_ps( b + i ) ) );
+        acc1 = _mm_add_ps( acc1, _mm_mul_ps( _mm_loadu_ps( a + i + 4 ),
+                                             _mm_loadu_ps( b + i + 4 ) ) );
+    }
+    acc0 = _mm_add_ps( acc0, acc1 );
+    acc0 = _mm_add_ps( acc0, _mm_movehl_ps( acc0, acc0 ) );
+    acc0 = _mm_add_ss( acc0, _mm_shuffle_ps( acc0, acc0, 1 ) );
+
+    float corr = _mm_cvtss_f32( acc0 );
+    for( ; i < n; i++ )
+        corr += a[i] * b[i];
+    return corr;
+}
+
+__attribute__ ((__target__ ("avx")))
+static float dot_product_float_avx( const float *a, const float *b,
+                                    unsigned n )
+{
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    unsigned i = 0;
+
+    for( ; i + 16 <= n; i += 16 ) {
+        acc0 = _mm256_add_ps( acc0, _mm256_mul_ps( _mm256_loadu_ps( a + i ),
+                                                   _mm256_loadu_ps( b + i ) ) );
+        acc1 = _mm256_add_ps( acc1,
+                              _mm256_mul_ps( _mm256_loadu_ps( a + i + 8 ),
+                                             _mm256_loadu_ps( b + i + 8 ) ) );
+    }
+    acc0 = _mm256_add_ps( acc0, acc1 );
+
+    __m128 acc = _mm_add_ps( _mm256_castps256_ps128( acc0 ),
+                             _mm256_extractf128_ps( acc0, 1 ) );
+    acc = _mm_add_ps( acc, _mm_movehl_ps( acc, acc ) );
+    acc = _mm_add_ss( acc, _mm_shuffle_ps( acc, acc, 1 ) );
+
+    float corr = _mm_cvtss_f32( acc );
+    for( ; i < n; i++ )
+        corr += a[i] * b[i];
+    return corr;
+}
+#endif
+
+/*****************************************************************************
+ * prepare_search: window the overlap and return the samples to search
+ *****************************************************************************/
+static const float *prepare_search( filter_t *p_filter )
+{
+    filter_sys_t *p = p_filter->p_sys;
+    const float *pw  = p->table_window;
+    const float *po  = (const float *)p->buf_overlap + p->samples_per_frame;
+    const float *ps  = (const float *)p->buf_queue + p->samples_per_frame;
+    float       *ppc = p->buf_pre_corr;
+    unsigned i, j;
+
+    if( p->search_channels == p->samples_per_frame ) {
+        for( i = 0; i < p->samples_pre_corr; i++ )
+            ppc[i] = pw[i] * po[i];
+        return ps;
+    }
+
+    /* Downmixed: one sample per frame */
+    for( i = 0; i < p->samples_pre_corr; i++ ) {
+        float sum = 0;
+        for( j = 0; j < p->samples_per_frame; j++ )
+            sum += *po++;
+        ppc[i] = pw[i] * sum;
+    }
+
+    unsigned frames = p->frames_search + p->samples_pre_corr - 1;
+    for( i = 0; i < frames; i++ ) {
+        float sum = 0;
+        for( j = 0; j < p->samples_per_frame; j++ )
+            sum += *ps++;
+        p->buf_search[i] = sum;
+    }
+    return p->buf_search;
+}
+
 /*****************************************************************************
  * best_overlap_offset: calculate best offset for overlap
  *****************************************************************************/
 static unsigned best_overlap_offset_float( filter_t *p_filter )
 {
     filter_sys_t *p = p_filter->p_sys;
-    float *pw, *po, *ppc, *search_start;
+    const float *search_start = prepare_search( p_filter );
     float best_corr = INT_MIN;
     unsigned best_off = 0;
-    unsigned i, off;
-
-    pw  = p->table_window;
-    po  = p->buf_overlap;
-    po += p->samples_per_frame;
-    ppc = p->buf_pre_corr;
-    for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-      *ppc++ = *pw++ * *po++;
-    }
 
-    search_start = (float *)p->buf_queue + p->samples_per_frame;
-    for( off = 0; off < p->frames_search; off++ ) {
-      float corr = 0;
-      float *ps = search_start;
-      ppc = p->buf_pre_corr;
-      for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-        corr += *ppc++ * *ps++;
-      }
+    for( unsigned off = 0; off < p->frames_search; off++ ) {
+      float corr = p->dot_product( p->buf_pre_corr, search_start,
+                                   p->samples_pre_corr );
       if( corr > best_corr ) {
         best_corr = corr;
         best_off  = off;
       }
-      search_start += p->samples_per_frame;
+      search_start += p->search_channels;
+    }
+
+    return best_off * p->bytes_per_frame;
+}
+
+/* Correlates the overlap with every search position at once, by convolving
+ * the search window with the reversed overlap of each channel. */
+static unsigned best_overlap_offset_fft( filter_t *p_filter )
+{
+    filter_sys_t *p = p_filter->p_sys;
+    const float *search_start = prepare_search( p_filter );
+    const float *ppc = p->buf_pre_corr;
+    const unsigned channels = p->search_channels;
+    const unsigned frames_pre_corr = p->samples_pre_corr / channels;
+    float best_corr = INT_MIN;
+    unsigned best_off = 0;
+
+    convolver_Reset( p->convolver );
+    for( unsigned c = 0; c < channels; c++ ) {
+        for( unsigned i = 0; i < frames_pre_corr; i++ )
+            p->buf_response[i] = ppc[( frames_pre_corr - 1 - i ) * channels + c];
+        convolver_SetResponse( p->convolver, c, 0, p->buf_response,
+                               frames_pre_corr );
+    }
+    convolver_Process( p->convolver, search_start, p->buf_corr,
+                       p->frames_search + frames_pre_corr - 1 );
+
+    /* The correlation at offset off ends up at off + frames_pre_corr - 1 */
+    const float *pcorr = p->buf_corr + frames_pre_corr - 1;
+    for( unsigned off = 0; off < p->frames_search; off++ ) {
+      if( pcorr[off] > best_corr ) {
+        best_corr = pcorr[off];
+        best_off  = off;
+      }
     }
 
     return best_off * p->bytes_per_frame;
@@ -349,19 +490,72 @@ static int reinit_buffers( filter_t *p_filter )
     }
     else
     {
-        unsigned bytes_pre_corr = ( p->samples_overlap - p->samples_per_frame ) * 4; /* sizeof (int32|float) */
-        p->buf_pre_corr = malloc( bytes_pre_corr );
-        p->table_window = malloc( bytes_pre_corr );
+        unsigned frames_pre_corr = frames_overlap - 1;
+        p->samples_pre_corr = frames_pre_corr * p->search_channels;
+        p->buf_pre_corr = vlc_alloc( p->samples_pre_corr, sizeof (float) );
+        p->table_window = vlc_alloc( p->samples_pre_corr, sizeof (float) );
         if( ! p->buf_pre_corr || ! p->table_window )
             return VLC_ENOMEM;
         float *pw = p->table_window;
         for( i = 1; i<frames_overlap; i++ )
         {
             float v = i * ( frames_overlap - i );
-            for( j = 0; j < p->samples_per_frame; j++ )
+            for( j = 0; j < p->search_channels; j++ )
                 *pw++ = v;
         }
+
+        unsigned frames_corr = p->frames_search + frames_pre_corr - 1;
+        if( p->search_channels != p->samples_per_frame )
+        {
+            p->buf_search = vlc_alloc( frames_corr, sizeof (float) );
+            if( ! p->buf_search )
+                return VLC_ENOMEM;
+        }
+
+        p->dot_product = dot_product_float;
+        unsigned width = 1;
+#ifdef HAVE_SSE2_INTRINSICS
+        if( vlc_CPU_AVX() )
+        {
+            p->dot_product = dot_product_float_avx;
+            width = 8;
+        }
+        else if( vlc_CPU_SSE() )
+        {
+            p->dot_product = dot_product_float_sse;
+            width = 4;
+        }
+#endif
         p->best_overlap_offset = best_overlap_offset_float;
+
+        /* Each direct correlation costs one multiply-add per sample, while a
+         * partition of the convolution costs about one real transform per
+         * channel and one inverse transform, plus the overlap transforms. */
+        unsigned partition = 64, log2_partition = 6;
+        while( partition < frames_pre_corr && partition < 16384 )
+        {
+            partition *= 2;
+            log2_partition++;
+        }
+        unsigned parts = ( frames_pre_corr + partition - 1 ) / partition;
+        unsigned chunks = ( frames_corr + partition - 1 ) / partition;
+        double cost_direct = (double)p->frames_search * p->samples_pre_corr
+                           / width;
+        double cost_fft = ( (double)chunks * ( p->search_channels + 1 )
+                          + (double)parts * p->search_channels )
+                        * 4. * partition * ( log2_partition + 1 )
+                        + (double)chunks * parts * p->search_channels
+                        * 4. * partition;
+        if( cost_fft < cost_direct )
+        {
+            p->convolver = convolver_New( p->search_channels, 1, partition,
+                                          frames_pre_corr );
+            p->buf_response = vlc_alloc( frames_pre_corr, sizeof (float) );
+            p->buf_corr = vlc_alloc( frames_corr, sizeof (float) );
+            if( ! p->convolver || ! p->buf_response || ! p->buf_corr )
+                return VLC_ENOMEM;
+            p->best_overlap_offset = best_overlap_offset_fft;
+        }
     }
 
     unsigned new_size = ( p->frames_search + frames_stride + frames_overlap ) * p->bytes_per_frame;
@@ -391,13 +585,15 @@ static int reinit_buffers( filter_t *p_filter )
     p->frames_stride_scaled = p->bytes_stride_scaled / p->bytes_per_frame;
 
     msg_Dbg( VLC_OBJECT(p_filter),
-             "%.3f scale, %.3f stride_in, %i stride_out, %i standing, %i overlap, %i search, %i queue, %s mode",
+             "%.3f scale, %.3f stride_in, %i stride_out, %i standing, %i overlap, %i search (%s, %u channels), %i queue, %s mode",
              p->scale,
              p->frames_stride_scaled,
              (int)( p->bytes_stride / p->bytes_per_frame ),
              (int)( p->bytes_standing / p->bytes_per_frame ),
              (int)( p->bytes_overlap / p->bytes_per_frame ),
              p->frames_search,
+             p->best_overlap_offset == best_overlap_offset_fft ? "fft" : "direct",
+             p->search_channels,
              (int)( p->bytes_queue_max / p->bytes_per_frame ),
              "fl32");
 
@@ -431,6 +627,8 @@ static int Open( vlc_object_t *p_this )
     p_sys->ms_stride       = var_InheritInteger( p_this, "scaletempo-stride" );
     p_sys->percent_overlap = var_InheritFloat( p_this, "scaletempo-overlap" );
     p_sys->ms_search       = var_InheritInteger( p_this, "scaletempo-search" );
+    p_sys->search_channels = var_InheritBool( p_this, "scaletempo-downmix" )
+                           ? 1 : p_sys->samples_per_frame;
 
     msg_Dbg( p_this, "params: %i stride, %.3f overlap, %i search",
              p_sys->ms_stride, p_sys->percent_overlap, p_sys->ms_search );
@@ -440,6 +638,10 @@ static int Open( vlc_object_t *p_this )
     p_sys->table_blend    = NULL;
     p_sys->buf_pre_corr   = NULL;
     p_sys->table_window   = NULL;
+    p_sys->buf_search     = NULL;
+    p_sys->buf_response   = NULL;
+    p_sys->buf_corr       = NULL;
+    p_sys->convolver      = NULL;
     p_sys->bytes_overlap  = 0;
     p_sys->bytes_queued   = 0;
     p_sys->bytes_to_slide = 0;
@@ -537,6 +739,11 @@ static void Close( vlc_object_t *p_this )
     free( p_sys->table_blend );
     free( p_sys->buf_pre_corr );
     free( p_sys->table_window );
+    free( p_sys->buf_search );
+    free( p_sys->buf_response );
+    free( p_sys->buf_corr );
+    if( p_sys->convolver )
+        convolver_Delete( p_sys->convolver );
     free( p_sys );
 }
 
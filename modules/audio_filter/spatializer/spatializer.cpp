@@ -133,6 +133,7 @@ static const callback_s callbacks[] = {
 enum { num_callbacks=sizeof(callbacks)/sizeof(callback_s) };
 
 static block_t *DoWork( filter_t *, block_t * );
+static void Process( filter_t *, float *, unsigned );
 
 /*****************************************************************************
  * Open:
@@ -172,6 +173,7 @@ static int Open( vlc_object_t *p_this )
     aout_FormatPrepare(&p_filter->fmt_in.audio);
     p_filter->fmt_out.audio = p_filter->fmt_in.audio;
     p_filter->pf_audio_filter = DoWork;
+    p_filter->pf_audio_process = Process;
     return VLC_SUCCESS;
 }
 
@@ -199,7 +201,7 @@ static void Close( vlc_object_t *p_this )
 
 /*****************************************************************************
  * SpatFilter: process samples buffer
- * DoWork: call SpatFilter
+ * DoWork, Process: call SpatFilter
  *****************************************************************************/
 
 static void SpatFilter( filter_t *p_filter, float *out, float *in,
@@ -228,6 +230,12 @@ static block_t *DoWork( filter_t * p_filter, block_t * p_in_buf )
     return p_in_buf;
 }
 
+static void Process( filter_t *p_filter, float *p_buf, unsigned i_samples )
+{
+    SpatFilter( p_filter, p_buf, p_buf, i_samples,
+                aout_FormatNbChannels( &p_filter->fmt_in.audio ) );
+}
+
 
 /*****************************************************************************
  * Variables callbacks
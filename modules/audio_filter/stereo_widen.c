@@ -36,6 +36,7 @@ static int  Open ( vlc_object_t * );
 static void Close( vlc_object_t * );
 
 static block_t *Filter ( filter_t *, block_t * );
+static void Process ( filter_t *, float *, unsigned );
 static int paramCallback( vlc_object_t *, char const *, vlc_value_t ,
                             vlc_value_t , void * );
 
@@ -154,19 +155,19 @@ static int Open( vlc_object_t *obj )
     }
 
     p_filter->pf_audio_filter = Filter;
+    p_filter->pf_audio_process = Process;
     return VLC_SUCCESS;
 }
 
 /*****************************************************************************
  * Filter: process each sample
  *****************************************************************************/
-static block_t *Filter( filter_t *p_filter, block_t *p_block )
+static void Process( filter_t *p_filter, float *p_out, unsigned i_samples )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    float *p_out = (float *)p_block->p_buffer;
     float *pf_read;
 
-    for (unsigned i = p_block->i_nb_samples; i > 0; i--)
+    for (unsigned i = i_samples; i > 0; i--)
     {
         pf_read = p_sys->pf_write + 2;
         /* if at end of buffer put read ptr at begin */
@@ -187,7 +188,11 @@ static block_t *Filter( filter_t *p_filter, block_t *p_block )
         if( p_sys->pf_write  == p_sys->pf_ringbuf + p_sys->i_len )
             p_sys->pf_write  =  p_sys->pf_ringbuf;
     }
+}
 
+static block_t *Filter( filter_t *p_filter, block_t *p_block )
+{
+    Process( p_filter, (float *)p_block->p_buffer, p_block->i_nb_samples );
     return p_block;
 }
 
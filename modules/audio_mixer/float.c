@@ -34,6 +34,11 @@
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
+#include <vlc_cpu.h>
+
+#ifdef HAVE_SSE2_INTRINSICS
+# include <immintrin.h>
+#endif
 
 /*****************************************************************************
  * Local prototypes
@@ -67,6 +72,81 @@ static void FilterFL32( audio_volume_t *p_volume, block_t *p_buffer,
     (void) p_volume;
 }
 
+#ifdef HAVE_SSE2_INTRINSICS
+VLC_SSE
+static void FilterFL32SSE( audio_volume_t *p_volume, block_t *p_buffer,
+                           float f_multiplier )
+{
+    if( f_multiplier == 1.f )
+        return; /* nothing to do */
+
+    float *p = (float *)p_buffer->p_buffer;
+    size_t i = p_buffer->i_buffer / sizeof(*p);
+    const __m128 mult = _mm_set1_ps( f_multiplier );
+
+    for( ; i >= 8; i -= 8, p += 8 )
+    {
+        __m128 a = _mm_loadu_ps( p );
+        __m128 b = _mm_loadu_ps( p + 4 );
+        _mm_storeu_ps( p, _mm_mul_ps( a, mult ) );
+        _mm_storeu_ps( p + 4, _mm_mul_ps( b, mult ) );
+    }
+    for( ; i > 0; i-- )
+        *(p++) *= f_multiplier;
+
+    (void) p_volume;
+}
+
+__attribute__ ((__target__ ("avx")))
+static void FilterFL32AVX( audio_volume_t *p_volume, block_t *p_buffer,
+                           float f_multiplier )
+{
+    if( f_multiplier == 1.f )
+        return; /* nothing to do */
+
+    float *p = (float *)p_buffer->p_buffer;
+    size_t i = p_buffer->i_buffer / sizeof(*p);
+    const __m256 mult = _mm256_set1_ps( f_multiplier );
+
+    for( ; i >= 16; i -= 16, p += 16 )
+    {
+        __m256 a = _mm256_loadu_ps( p );
+        __m256 b = _mm256_loadu_ps( p + 8 );
+        _mm256_storeu_ps( p, _mm256_mul_ps( a, mult ) );
+        _mm256_storeu_ps( p + 8, _mm256_mul_ps( b, mult ) );
+    }
+    for( ; i > 0; i-- )
+        *(p++) *= f_multiplier;
+
+    (void) p_volume;
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void FilterFL64SSE( audio_volume_t *p_volume, block_t *p_buffer,
+                           float f_multiplier )
+{
+    double *p = (double *)p_buffer->p_buffer;
+    double mult = f_multiplier;
+    if( mult == 1. )
+        return; /* nothing to do */
+
+    size_t i = p_buffer->i_buffer / sizeof(*p);
+    const __m128d vmult = _mm_set1_pd( mult );
+
+    for( ; i >= 4; i -= 4, p += 4 )
+    {
+        __m128d a = _mm_loadu_pd( p );
+        __m128d b = _mm_loadu_pd( p + 2 );
+        _mm_storeu_pd( p, _mm_mul_pd( a, vmult ) );
+        _mm_storeu_pd( p + 2, _mm_mul_pd( b, vmult ) );
+    }
+    for( ; i > 0; i-- )
+        *(p++) *= mult;
+
+    (void) p_volume;
+}
+#endif
+
 static void FilterFL64( audio_volume_t *p_volume, block_t *p_buffer,
                         float f_multiplier )
 {
@@ -92,9 +172,19 @@ static int Create( vlc_object_t *p_this )
     {
         case VLC_CODEC_FL32:
             p_volume->amplify = FilterFL32;
+#ifdef HAVE_SSE2_INTRINSICS
+            if( vlc_CPU_AVX() )
+                p_volume->amplify = FilterFL32AVX;
+            else if( vlc_CPU_SSE() )
+                p_volume->amplify = FilterFL32SSE;
+#endif
             break;
         case VLC_CODEC_FL64:
             p_volume->amplify = FilterFL64;
+#ifdef HAVE_SSE2_INTRINSICS
+            if( vlc_CPU_SSE2() )
+                p_volume->amplify = FilterFL64SSE;
+#endif
             break;
         default:
             return -1;
@@ -51,6 +51,15 @@ typedef struct
     bool soft_mute;
     float soft_gain;
     char *device;
+
+    /* Pull model */
+    aout_ring_t *ring; /**< Samples queued for the thread, or NULL */
+    void *period_buf; /**< One period of samples */
+    snd_pcm_uframes_t period_size; /**< Period in frames */
+    vlc_thread_t thread;
+    vlc_mutex_t lock; /**< Serializes device operations with the thread */
+    vlc_cond_t wait;
+    bool paused;
 } aout_sys_t;
 
 enum {
@@ -292,6 +301,8 @@ out:
 
 static int TimeGet (audio_output_t *aout, vlc_tick_t *);
 static void Play(audio_output_t *, block_t *, vlc_tick_t);
+static void PlayRing(audio_output_t *, block_t *, vlc_tick_t);
+static void *Thread(void *);
 static void Pause (audio_output_t *, bool, vlc_tick_t);
 static void PauseDummy (audio_output_t *, bool, vlc_tick_t);
 static void Flush (audio_output_t *, bool);
@@ -522,8 +533,14 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
     sys->rate = fmt->i_rate;
 
+    /* In pull model, the thread refills the device period by period from the
+     * ring buffer, so the device buffer only needs to absorb the scheduling
+     * latency of the thread. */
+    const bool pull = passthrough == PASSTHROUGH_NONE
+                   && var_InheritBool (aout, "audio-pull");
+
 #if 1 /* work-around for period-long latency outputs (e.g. PulseAudio): */
-    param = AOUT_MIN_PREPARE_TIME;
+    param = pull ? AOUT_MIN_PREPARE_TIME / 4 : AOUT_MIN_PREPARE_TIME;
     val = snd_pcm_hw_params_set_period_time_near (pcm, hw, &param, NULL);
     if (val)
     {
@@ -532,7 +549,7 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
 #endif
     /* Set buffer size */
-    param = AOUT_MAX_ADVANCE_TIME;
+    param = pull ? AOUT_MIN_PREPARE_TIME : AOUT_MAX_ADVANCE_TIME;
     val = snd_pcm_hw_params_set_buffer_time_near (pcm, hw, &param, NULL);
     if (val)
     {
@@ -610,9 +627,50 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
     fmt->channel_type = AUDIO_CHANNEL_TYPE_BITMAP;
     sys->format = fmt->i_format;
+    sys->ring = NULL;
+
+    if (pull)
+    {
+        aout_FormatPrepare (fmt);
+
+        val = snd_pcm_hw_params_get_period_size (hw, &sys->period_size, NULL);
+        if (val)
+        {
+            msg_Err (aout, "cannot get period size: %s", snd_strerror (val));
+            goto error;
+        }
+
+        sys->period_buf = malloc (snd_pcm_frames_to_bytes (pcm,
+                                                           sys->period_size));
+        if (unlikely(sys->period_buf == NULL))
+            goto error;
+
+        sys->ring = aout_RingNew (aout, fmt, AOUT_MAX_ADVANCE_TIME);
+        if (unlikely(sys->ring == NULL))
+        {
+            free (sys->period_buf);
+            goto error;
+        }
+
+        vlc_mutex_init (&sys->lock);
+        vlc_cond_init (&sys->wait);
+        sys->paused = false;
+
+        if (vlc_clone (&sys->thread, Thread, aout,
+                       VLC_THREAD_PRIORITY_OUTPUT))
+        {
+            vlc_cond_destroy (&sys->wait);
+            vlc_mutex_destroy (&sys->lock);
+            aout_RingDelete (sys->ring);
+            free (sys->period_buf);
+            goto error;
+        }
+        msg_Dbg (aout, "pull model with %lu frames periods",
+                 (unsigned long)sys->period_size);
+    }
 
     aout->time_get = TimeGet;
-    aout->play = Play;
+    aout->play = pull ? PlayRing : Play;
     if (snd_pcm_hw_params_can_pause (hw))
         aout->pause = Pause;
     else
@@ -629,21 +687,102 @@ error:
     return VLC_EGENERIC;
 }
 
+/* Device operations must not race with the pull model thread */
+static void DeviceLock (aout_sys_t *sys)
+{
+    if (sys->ring != NULL)
+        vlc_mutex_lock (&sys->lock);
+}
+
+static void DeviceUnlock (aout_sys_t *sys)
+{
+    if (sys->ring != NULL)
+        vlc_mutex_unlock (&sys->lock);
+}
+
+static void DevicePause (aout_sys_t *sys, bool pause)
+{
+    if (sys->ring != NULL)
+    {
+        sys->paused = pause;
+        vlc_cond_signal (&sys->wait);
+    }
+}
+
 static int TimeGet (audio_output_t *aout, vlc_tick_t *restrict delay)
 {
     aout_sys_t *sys = aout->sys;
     snd_pcm_sframes_t frames;
 
+    DeviceLock (sys);
     int val = snd_pcm_delay (sys->pcm, &frames);
+    DeviceUnlock (sys);
     if (val)
     {
         msg_Err (aout, "cannot estimate delay: %s", snd_strerror (val));
         return -1;
     }
+    if (sys->ring != NULL)
+        frames += snd_pcm_bytes_to_frames (sys->pcm,
+                                           aout_RingQueued (sys->ring));
     *delay = frames * CLOCK_FREQ / sys->rate;
     return 0;
 }
 
+/**
+ * Refills the hardware from the ring buffer (pull model).
+ */
+static void *Thread (void *data)
+{
+    audio_output_t *aout = data;
+    aout_sys_t *sys = aout->sys;
+    snd_pcm_t *pcm = sys->pcm;
+    const size_t bytes = snd_pcm_frames_to_bytes (pcm, sys->period_size);
+    /* Wake up regularly to handle cancellation */
+    const int timeout = MS_FROM_VLC_TICK(AOUT_MIN_PREPARE_TIME);
+
+    for (;;)
+    {
+        snd_pcm_sframes_t avail;
+
+        vlc_mutex_lock (&sys->lock);
+        mutex_cleanup_push (&sys->lock);
+        while (sys->paused)
+            vlc_cond_wait (&sys->wait, &sys->lock);
+        vlc_cleanup_pop ();
+
+        avail = snd_pcm_avail_update (pcm);
+        if (avail >= (snd_pcm_sframes_t)sys->period_size)
+        {
+            /* Pad with silence rather than letting the device run dry */
+            aout_RingRead (sys->ring, sys->period_buf, bytes);
+            avail = snd_pcm_writei (pcm, sys->period_buf, sys->period_size);
+        }
+
+        if (avail < 0)
+        {
+            int val = snd_pcm_recover (pcm, avail, 1);
+            if (val)
+            {
+                msg_Err (aout, "cannot recover playback stream: %s",
+                         snd_strerror (val));
+                DumpDeviceStatus (aout, pcm);
+            }
+            else
+                msg_Warn (aout, "cannot write samples: %s",
+                          snd_strerror (avail));
+        }
+        vlc_mutex_unlock (&sys->lock);
+
+        if (avail >= 0 && avail < (snd_pcm_sframes_t)sys->period_size)
+            snd_pcm_wait (pcm, timeout);
+        else if (avail < 0)
+            vlc_tick_sleep (AOUT_MIN_PREPARE_TIME / 4);
+        vlc_testcancel ();
+    }
+    vlc_assert_unreachable ();
+}
+
 /**
  * Queues one audio buffer to the hardware.
  */
@@ -690,6 +829,21 @@ static void Play(audio_output_t *aout, block_t *block, vlc_tick_t date)
     (void) date;
 }
 
+/**
+ * Queues one audio buffer to the thread (pull model).
+ */
+static void PlayRing(audio_output_t *aout, block_t *block, vlc_tick_t date)
+{
+    aout_sys_t *sys = aout->sys;
+
+    if (sys->chans_to_reorder != 0)
+        aout_ChannelReorder(block->p_buffer, block->i_buffer,
+                           sys->chans_to_reorder, sys->chans_table, sys->format);
+
+    aout_RingPlay(sys->ring, block);
+    (void) date;
+}
+
 /**
  * Pauses/resumes the audio playback.
  */
@@ -698,7 +852,10 @@ static void Pause (audio_output_t *aout, bool pause, vlc_tick_t date)
     aout_sys_t *p_sys = aout->sys;
     snd_pcm_t *pcm = p_sys->pcm;
 
+    DeviceLock (p_sys);
     int val = snd_pcm_pause (pcm, pause);
+    DevicePause (p_sys, pause);
+    DeviceUnlock (p_sys);
     if (unlikely(val))
         PauseDummy (aout, pause, date);
 }
@@ -708,11 +865,14 @@ static void PauseDummy (audio_output_t *aout, bool pause, vlc_tick_t date)
     aout_sys_t *p_sys = aout->sys;
     snd_pcm_t *pcm = p_sys->pcm;
 
+    DeviceLock (p_sys);
     /* Stupid device cannot pause. Discard samples. */
     if (pause)
         snd_pcm_drop (pcm);
     else
         snd_pcm_prepare (pcm);
+    DevicePause (p_sys, pause);
+    DeviceUnlock (p_sys);
     (void) date;
 }
 
@@ -724,11 +884,21 @@ static void Flush (audio_output_t *aout, bool wait)
     aout_sys_t *p_sys = aout->sys;
     snd_pcm_t *pcm = p_sys->pcm;
 
+    if (p_sys->ring != NULL)
+    {
+        if (wait)
+            aout_RingDrain (p_sys->ring);
+        else
+            aout_RingFlush (p_sys->ring);
+    }
+
+    DeviceLock (p_sys);
     if (wait)
         snd_pcm_drain (pcm);
     else
         snd_pcm_drop (pcm);
     snd_pcm_prepare (pcm);
+    DeviceUnlock (p_sys);
 }
 
 
@@ -740,6 +910,16 @@ static void Stop (audio_output_t *aout)
     aout_sys_t *sys = aout->sys;
     snd_pcm_t *pcm = sys->pcm;
 
+    if (sys->ring != NULL)
+    {
+        vlc_cancel (sys->thread);
+        vlc_join (sys->thread, NULL);
+        vlc_cond_destroy (&sys->wait);
+        vlc_mutex_destroy (&sys->lock);
+        aout_RingDelete (sys->ring);
+        free (sys->period_buf);
+    }
+
     snd_pcm_drop (pcm);
     snd_pcm_close (pcm);
 }
@@ -70,6 +70,7 @@ typedef struct
     pa_cvolume cvolume; /**< actual sink input volume */
     vlc_tick_t first_pts; /**< Play stream timestamp of buffer start */
     vlc_tick_t first_date; /**< Play system timestamp of buffer start */
+    aout_ring_t *ring; /**< Pull model samples queue, or NULL */
 
     pa_volume_t volume_force; /**< Forced volume (stream must be NULL) */
     pa_stream_flags_t flags_force; /**< Forced flags (stream must be NULL) */
@@ -320,6 +321,40 @@ static void stream_moved_cb(pa_stream *s, void *userdata)
     aout_DeviceReport(aout, name);
 }
 
+/**
+ * Writes samples from the ring buffer (pull model).
+ * While the stream is corked, only queued samples are written, so that the
+ * deferred start is not delayed by padding.
+ * @note PulseAudio lock required.
+ */
+static void stream_fill(pa_stream *s, audio_output_t *aout, size_t nbytes)
+{
+    aout_sys_t *sys = aout->sys;
+    const size_t frame_size = pa_frame_size(pa_stream_get_sample_spec(s));
+    void *data;
+
+    if (pa_stream_is_corked(s) > 0)
+        nbytes = __MIN(nbytes, aout_RingQueued(sys->ring));
+    if (nbytes < frame_size)
+        return;
+
+    if (pa_stream_begin_write(s, &data, &nbytes) < 0) {
+        vlc_pa_error(aout, "cannot begin write", sys->context);
+        return;
+    }
+
+    nbytes -= nbytes % frame_size;
+    aout_RingRead(sys->ring, data, nbytes);
+
+    if (pa_stream_write(s, data, nbytes, NULL, 0, PA_SEEK_RELATIVE) < 0)
+        vlc_pa_error(aout, "cannot write", sys->context);
+}
+
+static void stream_write_cb(pa_stream *s, size_t nbytes, void *userdata)
+{
+    stream_fill(s, userdata, nbytes);
+}
+
 static void stream_overflow_cb(pa_stream *s, void *userdata)
 {
     audio_output_t *aout = userdata;
@@ -451,6 +486,9 @@ static int TimeGet(audio_output_t *aout, vlc_tick_t *restrict delay)
         vlc_tick_t delta = vlc_pa_get_latency(aout, sys->context, s);
         if (delta != VLC_TICK_INVALID)
         {
+            if (sys->ring != NULL)
+                delta += pa_bytes_to_usec(aout_RingQueued(sys->ring),
+                                          pa_stream_get_sample_spec(s));
             *delay = delta;
             ret = 0;
         }
@@ -528,6 +566,35 @@ static void Play(audio_output_t *aout, block_t *block, vlc_tick_t date)
     pa_threaded_mainloop_unlock(sys->mainloop);
 }
 
+/**
+ * Queue one audio frame to the ring buffer (pull model)
+ */
+static void PlayRing(audio_output_t *aout, block_t *block, vlc_tick_t date)
+{
+    aout_sys_t *sys = aout->sys;
+    pa_stream *s = sys->stream;
+    vlc_tick_t pts = block->i_pts;
+
+    /* The PulseAudio thread drains the ring buffer: do not hold its lock
+     * while waiting for room. */
+    aout_RingPlay(sys->ring, block);
+
+    pa_threaded_mainloop_lock(sys->mainloop);
+
+    if (sys->first_pts == VLC_TICK_INVALID) {
+        sys->first_pts = pts;
+        sys->first_date = date;
+    }
+
+    if (pa_stream_is_corked(s) > 0) {
+        /* Prefill before the deferred start */
+        stream_fill(s, aout, pa_stream_writable_size(s));
+        stream_start(s, aout, date);
+    }
+
+    pa_threaded_mainloop_unlock(sys->mainloop);
+}
+
 /**
  * Cork or uncork the playback stream
  */
@@ -560,6 +627,13 @@ static void Flush(audio_output_t *aout, bool wait)
     pa_stream *s = sys->stream;
     pa_operation *op;
 
+    if (sys->ring != NULL) {
+        if (wait)
+            aout_RingDrain(sys->ring);
+        else
+            aout_RingFlush(sys->ring);
+    }
+
     pa_threaded_mainloop_lock(sys->mainloop);
 
     if (wait)
@@ -798,6 +872,16 @@ static int Start(audio_output_t *aout, audio_sample_format_t *restrict fmt)
     attr.minreq = pa_usec_to_bytes(AOUT_MIN_PREPARE_TIME, &ss);
     attr.fragsize = 0; /* not used for output */
 
+    /* In pull model, the write callback refills the server buffer from the
+     * ring buffer, so the server buffer can be much shorter. */
+    const bool pull = encoding == PA_ENCODING_PCM
+                   && var_InheritBool(aout, "audio-pull");
+    if (pull)
+    {
+        attr.tlength = pa_usec_to_bytes(AOUT_MIN_PREPARE_TIME, &ss);
+        attr.minreq = pa_usec_to_bytes(AOUT_MIN_PREPARE_TIME / 4, &ss);
+    }
+
     pa_cvolume *cvolume = NULL, cvolumebuf;
     if (PA_VOLUME_IS_VALID(sys->volume_force))
     {
@@ -808,6 +892,7 @@ static int Start(audio_output_t *aout, audio_sample_format_t *restrict fmt)
     sys->trigger = NULL;
     pa_cvolume_init(&sys->cvolume);
     sys->first_pts = VLC_TICK_INVALID;
+    sys->ring = NULL;
 
     pa_format_info *formatv = pa_format_info_new();
     formatv->encoding = encoding;
@@ -956,6 +1041,16 @@ static int Start(audio_output_t *aout, audio_sample_format_t *restrict fmt)
         fmt->i_rate = spec->rate;
     }
 
+    if (pull)
+    {
+        aout_FormatPrepare(fmt);
+        sys->ring = aout_RingNew(aout, fmt, AOUT_MAX_ADVANCE_TIME);
+        if (unlikely(sys->ring == NULL))
+            goto fail;
+        pa_stream_set_write_callback(s, stream_write_cb, aout);
+    }
+    aout->play = pull ? PlayRing : Play;
+
     stream_buffer_attr_cb(s, aout);
     stream_moved_cb(s, aout);
     pa_threaded_mainloop_unlock(sys->mainloop);
@@ -991,10 +1086,16 @@ static void Stop(audio_output_t *aout)
     pa_stream_set_started_callback(s, NULL, NULL);
     pa_stream_set_suspended_callback(s, NULL, NULL);
     pa_stream_set_underflow_callback(s, NULL, NULL);
+    pa_stream_set_write_callback(s, NULL, NULL);
 
     pa_stream_unref(s);
     sys->stream = NULL;
     pa_threaded_mainloop_unlock(sys->mainloop);
+
+    if (sys->ring != NULL) {
+        aout_RingDelete(sys->ring);
+        sys->ring = NULL;
+    }
 }
 
 static int Open(vlc_object_t *obj)
@@ -48,6 +48,14 @@
  ****************************************************************************/
 static int OpenDecoder(vlc_object_t *);
 static void CloseDecoder(vlc_object_t *);
+
+#define THREADS_TEXT N_("Threads")
+#define THREADS_LONGTEXT N_("Number of threads used for decoding, 0 meaning auto")
+#define ROW_MT_TEXT N_("Row multithreading")
+#define ROW_MT_LONGTEXT N_("Decode the rows of each tile in parallel, so " \
+    "that all the threads are used even if the stream has few tiles. This " \
+    "raises the throughput, at the cost of some synchronization overhead.")
+
 #ifdef ENABLE_SOUT
 static int OpenEncoder(vlc_object_t *);
 static void CloseEncoder(vlc_object_t *);
@@ -70,6 +78,9 @@ vlc_module_begin ()
     set_callbacks(OpenDecoder, CloseDecoder)
     set_category(CAT_INPUT)
     set_subcategory(SUBCAT_INPUT_VCODEC)
+    add_integer("aom-threads", 0, THREADS_TEXT, THREADS_LONGTEXT, true)
+        change_integer_range(0, 64)
+    add_bool("aom-row-mt", true, ROW_MT_TEXT, ROW_MT_LONGTEXT, true)
 #ifdef ENABLE_SOUT
     add_submodule()
         set_shortname("aom")
@@ -338,8 +349,12 @@ static int OpenDecoder(vlc_object_t *p_this)
 
     sys->i_next_frame_priv = 0;
 
+    int i_threads = var_InheritInteger(p_this, "aom-threads");
+    if (i_threads <= 0)
+        i_threads = __MIN(vlc_GetCPUCount(), 16);
+
     struct aom_codec_dec_cfg deccfg = {
-        .threads = __MIN(vlc_GetCPUCount(), 16),
+        .threads = i_threads,
         .allow_lowbitdepth = 1
     };
 
@@ -352,6 +367,14 @@ static int OpenDecoder(vlc_object_t *p_this)
         return VLC_EGENERIC;;
     }
 
+#ifdef AOM_CTRL_AV1D_SET_ROW_MT
+    if (i_threads > 1 &&
+        aom_codec_control(&sys->ctx, AV1D_SET_ROW_MT,
+                          var_InheritBool(p_this, "aom-row-mt")) != AOM_CODEC_OK)
+        AOM_ERR(p_this, &sys->ctx, "Failed to set row multithreading");
+#endif
+    msg_Dbg(p_this, "using %d thread(s)", i_threads);
+
     dec->pf_decode = Decode;
     dec->pf_flush = FlushDecoder;
 
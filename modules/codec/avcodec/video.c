@@ -58,6 +58,22 @@ struct frame_info_s
     bool b_display;
 };
 
+/* Reasons for a frame buffer not being a decoder (vout) picture, in which
+ * case the decoded frame is copied before being output. */
+enum
+{
+    LAVC_COPY_DR_DISABLED, /* by option, codec or capabilities */
+    LAVC_COPY_PALETTE,     /* paletted frames cannot be rendered directly */
+    LAVC_COPY_PITCH,       /* picture pitch not aligned for libavcodec */
+    LAVC_COPY_ALIGN,       /* picture planes not aligned for libavcodec */
+    LAVC_COPY_MAX
+};
+
+static const char *const lavc_copy_reasons[LAVC_COPY_MAX] =
+{
+    "disabled", "palette", "pitch", "alignment",
+};
+
 /*****************************************************************************
  * decoder_sys_t : decoder descriptor
  *****************************************************************************/
@@ -76,6 +92,7 @@ typedef struct
     bool b_hurry_up;
     bool b_show_corrupted;
     bool b_from_preroll;
+    bool b_keyframe_only;
     enum AVDiscard i_skip_frame;
 
     struct frame_info_s frame_info[FRAME_INFO_DEPTH];
@@ -95,6 +112,12 @@ typedef struct
     bool        b_direct_rendering;
     atomic_bool b_dr_failure;
 
+    /* direct rendering statistics */
+    atomic_uint dr_buffers;
+    atomic_uint copy_buffers[LAVC_COPY_MAX];
+    unsigned    dr_frames;
+    unsigned    copied_frames;
+
     /* Hack to force display of still pictures */
     bool b_first_frame;
 
@@ -419,6 +442,12 @@ static int lavc_CopyPicture(decoder_t *dec, picture_t *pic, AVFrame *frame)
         size_t dst_stride = pic->p[plane].i_pitch;
         size_t size = __MIN(src_stride, dst_stride);
 
+        if (src_stride == dst_stride)
+        {   /* Same layout: copy the whole plane at once */
+            memcpy(dst, src, size * pic->p[plane].i_visible_lines);
+            continue;
+        }
+
         for (int line = 0; line < pic->p[plane].i_visible_lines; line++)
         {
             memcpy(dst, src, size);
@@ -576,6 +605,10 @@ int InitVideoDec( vlc_object_t *obj )
     /* ***** libavcodec direct rendering ***** */
     p_sys->b_direct_rendering = false;
     atomic_init(&p_sys->b_dr_failure, false);
+    atomic_init(&p_sys->dr_buffers, 0);
+    for (unsigned i = 0; i < LAVC_COPY_MAX; i++)
+        atomic_init(&p_sys->copy_buffers[i], 0);
+    p_sys->dr_frames = p_sys->copied_frames = 0;
     if( var_CreateGetBool( p_dec, "avcodec-dr" ) &&
        (p_codec->capabilities & AV_CODEC_CAP_DR1) &&
         /* No idea why ... but this fixes flickering on some TSCC streams */
@@ -642,6 +675,7 @@ int InitVideoDec( vlc_object_t *obj )
     p_sys->b_first_frame = true;
     p_sys->i_late_frames = 0;
     p_sys->b_from_preroll = false;
+    p_sys->b_keyframe_only = false;
     p_sys->i_last_output_frame = -1;
     p_sys->framedrop = FRAMEDROP_NONE;
 
@@ -1020,6 +1054,14 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
             p_block = filter_earlydropped_blocks( p_dec, p_block );
     }
 
+    /* Fast forward: only the keyframes are shown, skip the other ones */
+    bool b_keyframe_only = decoder_IsKeyframeOnly( p_dec );
+    if( b_keyframe_only )
+        p_context->skip_frame = AVDISCARD_NONKEY;
+    else if( p_sys->b_keyframe_only )
+        p_context->skip_frame = p_sys->i_skip_frame;
+    p_sys->b_keyframe_only = b_keyframe_only;
+
     if( !b_need_output_picture || p_sys->framedrop == FRAMEDROP_NONREF )
     {
         p_context->skip_frame = __MAX( p_context->skip_frame, AVDISCARD_NONREF );
@@ -1238,9 +1280,12 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
                 picture_Release( p_pic );
                 break;
             }
+            p_sys->copied_frames++;
         }
         else
         {
+            p_sys->dr_frames++;
+
             /* Some codecs can return the same frame multiple times. By the
              * time that the same frame is returned a second time, it will be
              * too late to clone the underlying picture. So clone proactively.
@@ -1345,6 +1390,22 @@ void EndVideoDec( vlc_object_t *obj )
 
     post_mt( p_sys );
 
+    if( p_sys->copied_frames > 0 )
+    {
+        unsigned copies[LAVC_COPY_MAX];
+        for( unsigned i = 0; i < LAVC_COPY_MAX; i++ )
+            copies[i] = atomic_load( &p_sys->copy_buffers[i] );
+
+        msg_Dbg( p_dec, "%u frame(s) rendered directly, %u frame(s) copied "
+                 "(buffers: %u direct, %u %s, %u %s, %u %s, %u %s)",
+                 p_sys->dr_frames, p_sys->copied_frames,
+                 atomic_load( &p_sys->dr_buffers ),
+                 copies[0], lavc_copy_reasons[0],
+                 copies[1], lavc_copy_reasons[1],
+                 copies[2], lavc_copy_reasons[2],
+                 copies[3], lavc_copy_reasons[3] );
+    }
+
     /* do not flush buffers if codec hasn't been opened (theora/vorbis/VC1) */
     if( avcodec_is_open( ctx ) )
         avcodec_flush_buffers( ctx );
@@ -1472,7 +1533,10 @@ static int lavc_dr_GetFrame(struct AVCodecContext *ctx, AVFrame *frame,
     decoder_sys_t *sys = dec->p_sys;
 
     if (ctx->pix_fmt == AV_PIX_FMT_PAL8)
+    {
+        atomic_fetch_add(&sys->copy_buffers[LAVC_COPY_PALETTE], 1);
         goto error;
+    }
 
     int width = frame->width;
     int height = frame->height;
@@ -1491,12 +1555,14 @@ static int lavc_dr_GetFrame(struct AVCodecContext *ctx, AVFrame *frame,
             if (!atomic_exchange(&sys->b_dr_failure, true))
                 msg_Warn(dec, "plane %d: pitch not aligned (%d%%%d): disabling direct rendering",
                          i, pic->p[i].i_pitch, aligns[i]);
+            atomic_fetch_add(&sys->copy_buffers[LAVC_COPY_PITCH], 1);
             goto error;
         }
         if (((uintptr_t)pic->p[i].p_pixels) % aligns[i])
         {
             if (!atomic_exchange(&sys->b_dr_failure, true))
                 msg_Warn(dec, "plane %d not aligned: disabling direct rendering", i);
+            atomic_fetch_add(&sys->copy_buffers[LAVC_COPY_ALIGN], 1);
             goto error;
         }
     }
@@ -1526,6 +1592,7 @@ static int lavc_dr_GetFrame(struct AVCodecContext *ctx, AVFrame *frame,
     frame->opaque = pic;
     /* The loop above held one reference to the picture for each plane. */
     picture_Release(pic);
+    atomic_fetch_add(&sys->dr_buffers, 1);
     return 0;
 error:
     picture_Release(pic);
@@ -1558,6 +1625,7 @@ static int lavc_GetFrame(struct AVCodecContext *ctx, AVFrame *frame, int flags)
         if (!sys->b_direct_rendering)
         {
             post_mt(sys);
+            atomic_fetch_add(&sys->copy_buffers[LAVC_COPY_DR_DISABLED], 1);
             return avcodec_default_get_buffer2(ctx, frame, flags);
         }
 
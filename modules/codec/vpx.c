@@ -45,6 +45,17 @@
  ****************************************************************************/
 static int OpenDecoder(vlc_object_t *);
 static void CloseDecoder(vlc_object_t *);
+
+#define THREADS_TEXT N_("Threads")
+#define THREADS_LONGTEXT N_("Number of threads used for decoding, 0 meaning auto")
+#define FRAME_THREADS_TEXT N_("Frame threading")
+#define FRAME_THREADS_LONGTEXT N_("Decode several frames in parallel, if " \
+    "the library supports it. This raises the throughput, at the cost of " \
+    "latency.")
+#define ROW_MT_TEXT N_("Row multithreading")
+#define ROW_MT_LONGTEXT N_("Decode the rows of each VP9 tile in parallel, " \
+    "so that all the threads are used even if the stream has few tiles.")
+
 #ifdef ENABLE_SOUT
 static const char *const ppsz_sout_options[] = { "quality-mode", NULL };
 static int OpenEncoder(vlc_object_t *);
@@ -69,6 +80,11 @@ vlc_module_begin ()
     set_callbacks(OpenDecoder, CloseDecoder)
     set_category(CAT_INPUT)
     set_subcategory(SUBCAT_INPUT_VCODEC)
+    add_integer("vpx-threads", 0, THREADS_TEXT, THREADS_LONGTEXT, true)
+        change_integer_range(0, 64)
+    add_bool("vpx-frame-threads", false, FRAME_THREADS_TEXT,
+             FRAME_THREADS_LONGTEXT, true)
+    add_bool("vpx-row-mt", true, ROW_MT_TEXT, ROW_MT_LONGTEXT, true)
 #ifdef ENABLE_SOUT
     add_submodule()
     set_shortname("vpx")
@@ -93,13 +109,21 @@ static void vpx_err_msg(vlc_object_t *this, struct vpx_codec_ctx *ctx,
 }
 
 #define VPX_ERR(this, ctx, msg) vpx_err_msg(VLC_OBJECT(this), ctx, msg ": %s (%s)")
+#define VPX_MAX_FRAMES_DEPTH 64
 
 /*****************************************************************************
  * decoder_sys_t: libvpx decoder descriptor
  *****************************************************************************/
+struct frame_priv_s
+{
+    vlc_tick_t pts;
+};
+
 typedef struct
 {
     struct vpx_codec_ctx ctx;
+    struct frame_priv_s frame_priv[VPX_MAX_FRAMES_DEPTH];
+    unsigned i_next_frame_priv;
 } decoder_sys_t;
 
 static const struct
@@ -192,64 +216,8 @@ static vlc_fourcc_t FindVlcChroma( struct vpx_image *img )
     return 0;
 }
 
-/****************************************************************************
- * Decode: the whole thing
- ****************************************************************************/
-static int Decode(decoder_t *dec, block_t *block)
+static void OutputFrame(decoder_t *dec, const struct vpx_image *img)
 {
-    decoder_sys_t *p_sys = dec->p_sys;
-    struct vpx_codec_ctx *ctx = &p_sys->ctx;
-
-    if (block == NULL) /* No Drain */
-        return VLCDEC_SUCCESS;
-
-    if (block->i_flags & (BLOCK_FLAG_CORRUPTED)) {
-        block_Release(block);
-        return VLCDEC_SUCCESS;
-    }
-
-    /* Associate packet PTS with decoded frame */
-    vlc_tick_t *pkt_pts = malloc(sizeof(*pkt_pts));
-    if (!pkt_pts) {
-        block_Release(block);
-        return VLCDEC_SUCCESS;
-    }
-
-    *pkt_pts = (block->i_pts != VLC_TICK_INVALID) ? block->i_pts : block->i_dts;
-
-    vpx_codec_err_t err;
-    err = vpx_codec_decode(ctx, block->p_buffer, block->i_buffer, pkt_pts, 0);
-
-    block_Release(block);
-
-    if (err != VPX_CODEC_OK) {
-        free(pkt_pts);
-        VPX_ERR(dec, ctx, "Failed to decode frame");
-        if (err == VPX_CODEC_UNSUP_BITSTREAM)
-            return VLCDEC_ECRITICAL;
-        else
-            return VLCDEC_SUCCESS;
-    }
-
-    const void *iter = NULL;
-    struct vpx_image *img = vpx_codec_get_frame(ctx, &iter);
-    if (!img) {
-        free(pkt_pts);
-        return VLCDEC_SUCCESS;
-    }
-
-    /* fetches back the PTS */
-    pkt_pts = img->user_priv;
-    vlc_tick_t pts = *pkt_pts;
-    free(pkt_pts);
-
-    dec->fmt_out.i_codec = FindVlcChroma(img);
-
-    if( dec->fmt_out.i_codec == 0 ) {
-        msg_Err(dec, "Unsupported output colorspace %d", img->fmt);
-        return VLCDEC_SUCCESS;
-    }
-
     video_format_t *v = &dec->fmt_out.video;
 
     if (img->d_w != v->i_visible_width || img->d_h != v->i_visible_height) {
@@ -277,10 +245,10 @@ static int Decode(decoder_t *dec, block_t *block)
     dec->fmt_out.video.pose = dec->fmt_in.video.pose;
 
     if (decoder_UpdateVideoFormat(dec))
-        return VLCDEC_SUCCESS;
+        return;
     picture_t *pic = decoder_NewPicture(dec);
     if (!pic)
-        return VLCDEC_SUCCESS;
+        return;
 
     for (int plane = 0; plane < pic->i_planes; plane++ ) {
         uint8_t *src = img->planes[plane];
@@ -296,10 +264,95 @@ static int Decode(decoder_t *dec, block_t *block)
         }
     }
 
+    /* fetches back the PTS */
+    vlc_tick_t pts = ((struct frame_priv_s *) img->user_priv)->pts;
+
     pic->b_progressive = true; /* codec does not support interlacing */
     pic->date = pts;
 
     decoder_QueueVideo(dec, pic);
+}
+
+/* Outputs, or drops, the frames the decoder is done with. With frame
+ * threading, they lag behind the input. */
+static void PopFrames(decoder_t *dec, bool b_output)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    struct vpx_codec_ctx *ctx = &p_sys->ctx;
+
+    for (const void *iter = NULL;;) {
+        struct vpx_image *img = vpx_codec_get_frame(ctx, &iter);
+        if (!img)
+            break;
+        if (!b_output)
+            continue;
+
+        dec->fmt_out.i_codec = FindVlcChroma(img);
+        if (dec->fmt_out.i_codec == 0) {
+            msg_Err(dec, "Unsupported output colorspace %d", img->fmt);
+            continue;
+        }
+
+        OutputFrame(dec, img);
+    }
+}
+
+/****************************************************************************
+ * Flush: clears decoder between seeks
+ ****************************************************************************/
+static void FlushDecoder(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    struct vpx_codec_ctx *ctx = &p_sys->ctx;
+
+    if (vpx_codec_decode(ctx, NULL, 0, NULL, 0) != VPX_CODEC_OK)
+        VPX_ERR(dec, ctx, "Failed to flush decoder");
+    else
+        PopFrames(dec, false);
+}
+
+/****************************************************************************
+ * Decode: the whole thing
+ ****************************************************************************/
+static int Decode(decoder_t *dec, block_t *block)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    struct vpx_codec_ctx *ctx = &p_sys->ctx;
+    vpx_codec_err_t err;
+
+    if (block == NULL) /* Drain */
+    {
+        err = vpx_codec_decode(ctx, NULL, 0, NULL, 0);
+        if (err != VPX_CODEC_OK)
+            VPX_ERR(dec, ctx, "Failed to drain decoder");
+        else
+            PopFrames(dec, true);
+        return VLCDEC_SUCCESS;
+    }
+
+    if (block->i_flags & (BLOCK_FLAG_CORRUPTED)) {
+        block_Release(block);
+        return VLCDEC_SUCCESS;
+    }
+
+    /* Associate packet PTS with decoded frame */
+    struct frame_priv_s *priv =
+        &p_sys->frame_priv[p_sys->i_next_frame_priv++ % VPX_MAX_FRAMES_DEPTH];
+    priv->pts = (block->i_pts != VLC_TICK_INVALID) ? block->i_pts : block->i_dts;
+
+    err = vpx_codec_decode(ctx, block->p_buffer, block->i_buffer, priv, 0);
+
+    block_Release(block);
+
+    if (err != VPX_CODEC_OK) {
+        VPX_ERR(dec, ctx, "Failed to decode frame");
+        if (err == VPX_CODEC_UNSUP_BITSTREAM)
+            return VLCDEC_ECRITICAL;
+        else
+            return VLCDEC_SUCCESS;
+    }
+
+    PopFrames(dec, true);
     return VLCDEC_SUCCESS;
 }
 
@@ -336,20 +389,51 @@ static int OpenDecoder(vlc_object_t *p_this)
         return VLC_ENOMEM;
     dec->p_sys = sys;
 
+    sys->i_next_frame_priv = 0;
+
+    int i_threads = var_InheritInteger(p_this, "vpx-threads");
+    if (i_threads <= 0)
+        i_threads = __MIN(vlc_GetCPUCount(), 16);
+
+    vpx_codec_flags_t flags = 0;
+    if (var_InheritBool(p_this, "vpx-frame-threads") && i_threads > 1)
+    {
+        if (vpx_codec_get_caps(iface) & VPX_CODEC_CAP_FRAME_THREADING)
+        {
+            /* Each thread holds back one frame */
+            i_threads = __MIN(i_threads, VPX_MAX_FRAMES_DEPTH / 2);
+            flags |= VPX_CODEC_USE_FRAME_THREADING;
+        }
+        else
+            msg_Warn(p_this, "frame threading not supported by libvpx");
+    }
+
     struct vpx_codec_dec_cfg deccfg = {
-        .threads = __MIN(vlc_GetCPUCount(), 16)
+        .threads = i_threads
     };
 
     msg_Dbg(p_this, "VP%d: using libvpx version %s (build options %s)",
         vp_version, vpx_codec_version_str(), vpx_codec_build_config());
 
-    if (vpx_codec_dec_init(&sys->ctx, iface, &deccfg, 0) != VPX_CODEC_OK) {
+    if (vpx_codec_dec_init(&sys->ctx, iface, &deccfg, flags) != VPX_CODEC_OK) {
         VPX_ERR(p_this, &sys->ctx, "Failed to initialize decoder");
         free(sys);
         return VLC_EGENERIC;;
     }
 
+#ifdef VPX_CTRL_VP9D_SET_ROW_MT
+    if (vp_version == 9 && i_threads > 1 &&
+        vpx_codec_control(&sys->ctx, VP9D_SET_ROW_MT,
+                          var_InheritBool(p_this, "vpx-row-mt")) != VPX_CODEC_OK)
+        VPX_ERR(p_this, &sys->ctx, "Failed to set row multithreading");
+#endif
+
+    msg_Dbg(p_this, "using %d thread(s)%s", i_threads,
+            (flags & VPX_CODEC_USE_FRAME_THREADING) ? " with frame threading"
+                                                    : "");
+
     dec->pf_decode = Decode;
+    dec->pf_flush = FlushDecoder;
 
     dec->fmt_out.video.i_width = dec->fmt_in.video.i_width;
     dec->fmt_out.video.i_height = dec->fmt_in.video.i_height;
@@ -370,14 +454,8 @@ static void CloseDecoder(vlc_object_t *p_this)
     decoder_t *dec = (decoder_t *)p_this;
     decoder_sys_t *sys = dec->p_sys;
 
-    /* Free our PTS */
-    const void *iter = NULL;
-    for (;;) {
-        struct vpx_image *img = vpx_codec_get_frame(&sys->ctx, &iter);
-        if (!img)
-            break;
-        free(img->user_priv);
-    }
+    /* Flush decoder */
+    FlushDecoder(dec);
 
     vpx_codec_destroy(&sys->ctx);
 
@@ -37,6 +37,7 @@ namespace mkv {
 matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estream, KaxSegment *p_seg )
     :segment(p_seg)
     ,es(estream)
+    ,p_frames_io(NULL)
     ,i_timescale(MKVD_TIMECODESCALE)
     ,i_duration(-1)
     ,i_mk_start_time(0)
@@ -64,6 +65,10 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,b_preloaded(false)
     ,b_ref_external_segments(false)
 {
+    /* The frames are read after the block that holds them */
+    vlc_stream_io_callback *p_io = dynamic_cast<vlc_stream_io_callback *>( &estream.I_O() );
+    if( p_io != NULL && p_io->IsSeekable() )
+        p_frames_io = p_io;
 }
 
 matroska_segment_c::~matroska_segment_c()
@@ -1246,7 +1251,8 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
             }
 
             vars.simpleblock = &ksblock;
-            vars.simpleblock->ReadData( vars.obj->es.I_O() );
+            vars.simpleblock->ReadData( vars.obj->es.I_O(),
+                vars.obj->p_frames_io ? SCOPE_PARTIAL_DATA : SCOPE_ALL_DATA );
             vars.simpleblock->SetParent( *vars.obj->cluster );
 
             if( ksblock.IsKeyframe() )
@@ -1266,7 +1272,8 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
         E_CASE( KaxBlock, kblock )
         {
             vars.block = &kblock;
-            vars.block->ReadData( vars.obj->es.I_O() );
+            vars.block->ReadData( vars.obj->es.I_O(),
+                vars.obj->p_frames_io ? SCOPE_PARTIAL_DATA : SCOPE_ALL_DATA );
             vars.block->SetParent( *vars.obj->cluster );
 
             const mkv_track_t *p_track = vars.obj->FindTrackByBlock( &kblock, NULL );
@@ -1350,17 +1357,36 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
             {
                 if( p_track->fmt.i_codec == VLC_CODEC_THEORA )
                 {
-                    DataBuffer *    p_data = &pp_block->GetBuffer(0);
-                    const uint8_t * p_buff = p_data->Buffer();
+                    block_t *       p_data = NULL;
+                    const uint8_t * p_buff = NULL;
+                    size_t          i_size = 0;
+                    if( p_frames_io != NULL )
+                    {
+                        uint64 i_pos = FramesPosition( *pp_block );
+                        if( i_pos != 0 && pp_block->GetFrameSize(0) > 0 )
+                            p_data = p_frames_io->ReadBlock( i_pos, 1, 0 );
+                        if( p_data != NULL )
+                        {
+                            p_buff = p_data->p_buffer;
+                            i_size = p_data->i_buffer;
+                        }
+                    }
+                    else
+                    {
+                        p_buff = pp_block->GetBuffer(0).Buffer();
+                        i_size = pp_block->GetBuffer(0).Size();
+                    }
                     /* if the second bit of a Theora frame is 1
                        it's not a keyframe */
-                    if( p_data->Size() && p_buff )
+                    if( i_size && p_buff )
                     {
                         if( p_buff[0] & 0x40 )
                             *pb_key_picture = false;
                     }
                     else
                         *pb_key_picture = false;
+                    if( p_data != NULL )
+                        block_Release( p_data );
                 }
             }
 
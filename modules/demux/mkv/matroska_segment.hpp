@@ -88,6 +88,9 @@ public:
 
     KaxSegment              *segment;
     EbmlStream              & es;
+    /* stream BlockGet leaves the frames in, for BlockDecode to read them into
+     * the blocks sent, or NULL if they are read along with the blocks */
+    vlc_stream_io_callback  *p_frames_io;
 
     /* time scale */
     uint64_t                i_timescale;
@@ -47,6 +47,38 @@ namespace {
 
     template<class It> It prev_( It it ) { return --it; }
     template<class It> It next_( It it ) { return ++it; }
+
+    struct first_less {
+        template<class Pair, class Key>
+        bool operator()( Pair const& lhs, Key const& rhs ) const
+        {
+            return lhs.first < rhs;
+        }
+    };
+
+    // reads an EBML variable size integer, returns its length or 0 if invalid
+    size_t read_vint( uint8_t const* p, uint8_t const* end, uint64_t& value, bool& unknown )
+    {
+        if( p >= end || *p == 0 )
+            return 0;
+
+        size_t len = 1;
+        while( !( *p & ( 0x80 >> ( len - 1 ) ) ) )
+            len++;
+
+        if( static_cast<size_t>( end - p ) < len )
+            return 0;
+
+        value = *p & ( 0xFF >> len );
+        bool all_ones = value == static_cast<uint64_t>( 0xFF >> len );
+        for( size_t i = 1; i < len; ++i )
+        {
+            value = ( value << 8 ) | p[i];
+            all_ones &= p[i] == 0xFF;
+        }
+        unknown = all_ones;
+        return len;
+    }
 }
 
 namespace mkv {
@@ -60,10 +92,13 @@ SegmentSeeker::add_cluster_position( fptr_t fpos )
       fpos
     );
 
+    if( insertion_point != _cluster_positions.begin() && *prev_( insertion_point ) == fpos )
+        return prev_( insertion_point ); // already known
+
     return _cluster_positions.insert( insertion_point, fpos );
 }
 
-SegmentSeeker::cluster_map_t::iterator
+SegmentSeeker::clusters_t::iterator
 SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
 {
     Cluster cinfo = {
@@ -75,17 +110,23 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
             : UINT64_MAX
     };
 
+    return add_cluster( cinfo );
+}
+
+SegmentSeeker::clusters_t::iterator
+SegmentSeeker::add_cluster( Cluster const& cinfo )
+{
     add_cluster_position( cinfo.fpos );
 
-    cluster_map_t::iterator it = _clusters.lower_bound( cinfo.pts );
+    clusters_t::iterator it = std::lower_bound( _clusters.begin(), _clusters.end(), cinfo );
 
-    if( it != _clusters.end() && it->second.pts == cinfo.pts )
+    if( it != _clusters.end() && it->pts == cinfo.pts )
     {
         // cluster already known
     }
     else
     {
-        it = _clusters.insert( cluster_map_t::value_type( cinfo.pts, cinfo ) ).first;
+        it = _clusters.insert( it, cinfo );
     }
 
     // ------------------------------------------------------------------
@@ -102,21 +143,34 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
 
     if( it != _clusters.begin() )
     {
-        Duration::fix( prev_( it )->second, it->second );
+        Duration::fix( *prev_( it ), *it );
     }
 
     if( it != _clusters.end() && next_( it ) != _clusters.end() )
     {
-        Duration::fix( it->second, next_( it )->second );
+        Duration::fix( *it, *next_( it ) );
     }
 
     return it;
 }
 
+SegmentSeeker::seekpoints_t&
+SegmentSeeker::get_track_seekpoints( track_id_t track_id )
+{
+    tracks_seekpoints_t::iterator it = std::lower_bound(
+      _tracks_seekpoints.begin(), _tracks_seekpoints.end(), track_id, first_less()
+    );
+
+    if( it == _tracks_seekpoints.end() || it->first != track_id )
+        it = _tracks_seekpoints.insert( it, tracks_seekpoints_t::value_type( track_id, seekpoints_t() ) );
+
+    return it->second;
+}
+
 void
 SegmentSeeker::add_seekpoint( track_id_t track_id, Seekpoint sp )
 {
-    seekpoints_t&  seekpoints = _tracks_seekpoints[ track_id ];
+    seekpoints_t&  seekpoints = get_track_seekpoints( track_id );
     seekpoints_t::iterator it = std::lower_bound( seekpoints.begin(), seekpoints.end(), sp );
 
     if( it != seekpoints.end() && it->pts == sp.pts )
@@ -246,7 +300,7 @@ SegmentSeeker::get_seekpoints_around( vlc_tick_t target_pts, track_ids_t const&
 
         for( track_iterator it = begin; it != end; ++it )
         {
-            seekpoint_pair_t track_points = get_seekpoints_around( target_pts, _tracks_seekpoints[ *it ] );
+            seekpoint_pair_t track_points = get_seekpoints_around( target_pts, get_track_seekpoints( *it ) );
 
             if( it == begin ) {
                 points = track_points;
@@ -265,11 +319,12 @@ SegmentSeeker::get_seekpoints_around( vlc_tick_t target_pts, track_ids_t const&
 
     { // check if we got a cluster which is closer to target_pts than the found cues //
 
-        cluster_map_t::iterator it = _clusters.lower_bound( target_pts );
+        Cluster const needle = { 0, target_pts, -1, 0 };
+        clusters_t::const_iterator it = std::lower_bound( _clusters.begin(), _clusters.end(), needle );
 
         if( it != _clusters.begin() && --it != _clusters.end() )
         {
-            Cluster const& cluster = it->second;
+            Cluster const& cluster = *it;
 
             if( cluster.fpos > points.first.fpos )
             {
@@ -302,6 +357,10 @@ SegmentSeeker::get_seekpoints( matroska_segment_c& ms, vlc_tick_t target_pts,
         }
     };
 
+    if( !ms.b_cues && ms.sys.b_seekable )
+        // find the clusters around the target rather than parsing up to it
+        probe_clusters( ms, target_pts );
+
     for( vlc_tick_t needle_pts = target_pts; ; )
     {
         seekpoint_pair_t seekpoints = get_seekpoints_around( needle_pts, priority_tracks );
@@ -327,6 +386,144 @@ SegmentSeeker::get_seekpoints( matroska_segment_c& ms, vlc_tick_t target_pts,
     vlc_assert_unreachable();
 }
 
+void
+SegmentSeeker::probe_clusters( matroska_segment_c& ms, vlc_tick_t target_pts )
+{
+    // stop probing when the clusters around the target are this close, and
+    // index the blocks in between
+    fptr_t const probe_span = 1024 * 1024;
+
+    if( _clusters.empty() )
+        return;
+
+    // closest known clusters before and after the target //
+
+    Cluster const needle = { 0, target_pts, -1, 0 };
+    clusters_t::const_iterator it = std::upper_bound( _clusters.begin(), _clusters.end(), needle );
+
+    if( it == _clusters.begin() )
+        return;
+
+    fptr_t     lower_fpos = prev_( it )->fpos;
+    vlc_tick_t lower_pts  = prev_( it )->pts;
+    fptr_t     upper_fpos;
+    vlc_tick_t upper_pts;
+
+    if( it != _clusters.end() )
+    {
+        upper_fpos = it->fpos;
+        upper_pts  = it->pts;
+    }
+    else
+    {
+        upper_fpos = ms.segment->IsFiniteSize() ? ms.segment->GetEndPosition()
+                                                : stream_Size( ms.sys.demuxer.s );
+        upper_pts  = std::numeric_limits<vlc_tick_t>::max();
+    }
+
+    fptr_t const i_saved_pos = ms.es.I_O().getFilePointer();
+
+    while( upper_fpos > lower_fpos && upper_fpos - lower_fpos > probe_span )
+    {
+        fptr_t const middle = lower_fpos + ( upper_fpos - lower_fpos ) / 2;
+        Cluster cluster;
+
+        if( !probe_cluster_at( ms, middle, upper_fpos, lower_pts, upper_pts, cluster ) )
+        {
+            // no cluster starts in the upper half
+            upper_fpos = middle;
+            continue;
+        }
+
+        add_cluster( cluster );
+
+        if( cluster.pts <= target_pts )
+        {
+            lower_fpos = cluster.fpos;
+            lower_pts  = cluster.pts;
+        }
+        else
+        {
+            upper_fpos = cluster.fpos;
+            upper_pts  = cluster.pts;
+        }
+    }
+
+    ms.es.I_O().setFilePointer( i_saved_pos );
+}
+
+bool
+SegmentSeeker::probe_cluster_at( matroska_segment_c& ms, fptr_t start, fptr_t end,
+                                 vlc_tick_t min_pts, vlc_tick_t max_pts, Cluster& cluster )
+{
+    // Cluster ID, then its size, an optional CRC-32 and the Timecode
+    static uint8_t const cluster_id[] = { 0x1F, 0x43, 0xB6, 0x75 };
+    size_t const header_max = 4 + 8 + 6 + 1 + 8 + 8;
+    size_t const chunk_size = 64 * 1024;
+
+    std::vector<uint8_t> buffer( chunk_size + header_max );
+
+    for( fptr_t chunk_pos = start; chunk_pos < end; chunk_pos += chunk_size )
+    {
+        ms.es.I_O().setFilePointer( chunk_pos );
+        size_t const i_read = ms.es.I_O().read( &buffer[0], buffer.size() );
+
+        uint8_t const* const p_begin = &buffer[0];
+        uint8_t const* const p_end   = p_begin + i_read;
+        uint8_t const* const p_last  = p_begin + std::min<fptr_t>( std::min( chunk_size, i_read ),
+                                                                   end - chunk_pos );
+
+        for( uint8_t const* p = p_begin; p < p_last; ++p )
+        {
+            p = std::search( p, p_last, cluster_id, cluster_id + sizeof( cluster_id ) );
+            if( p == p_last )
+                break;
+
+            uint8_t const* q = p + sizeof( cluster_id );
+            uint64_t size, value;
+            bool unknown_size, unknown;
+            size_t len, size_len;
+
+            if( !( size_len = read_vint( q, p_end, size, unknown_size ) ) )
+                continue;
+            q += size_len;
+
+            if( q < p_end && *q == 0xBF ) // EbmlCrc32
+            {
+                if( !( len = read_vint( q + 1, p_end, value, unknown ) ) || value != 4 )
+                    continue;
+                q += 1 + len + 4;
+            }
+
+            if( q >= p_end || *q != 0xE7 ) // KaxClusterTimecode
+                continue;
+            if( !( len = read_vint( q + 1, p_end, value, unknown ) ) ||
+                value == 0 || value > 8 || static_cast<uint64_t>( p_end - q - 1 - len ) < value )
+                continue;
+
+            uint64_t timecode = 0;
+            for( uint8_t const* v = q + 1 + len; v < q + 1 + len + value; ++v )
+                timecode = ( timecode << 8 ) | *v;
+
+            vlc_tick_t const pts = vlc_tick_t( timecode * ms.i_timescale / INT64_C( 1000 ) );
+            if( pts < min_pts || pts > max_pts )
+                continue; // not a cluster, or out of order
+
+            cluster.fpos     = chunk_pos + ( p - p_begin );
+            cluster.pts      = pts;
+            cluster.duration = -1;
+            cluster.size     = unknown_size ? UINT64_MAX
+                                            : sizeof( cluster_id ) + size_len + size;
+            return true;
+        }
+
+        if( i_read < buffer.size() )
+            break;
+    }
+
+    return false;
+}
+
 void
 SegmentSeeker::index_range( matroska_segment_c& ms, Range search_area, vlc_tick_t max_pts )
 {
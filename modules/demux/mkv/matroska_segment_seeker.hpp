@@ -86,6 +86,11 @@ class SegmentSeeker
             vlc_tick_t pts;
             vlc_tick_t duration;
             fptr_t  size;
+
+            bool operator<( Cluster const& rhs ) const
+            {
+                return pts < rhs.pts;
+            }
         };
 
     public:
@@ -95,12 +100,16 @@ class SegmentSeeker
         typedef std::vector<fptr_t> cluster_positions_t;
 
         typedef std::map<track_id_t, Seekpoint> tracks_seekpoint_t;
-        typedef std::map<track_id_t, seekpoints_t> tracks_seekpoints_t;
-        typedef std::map<vlc_tick_t, Cluster> cluster_map_t;
+
+        // both sorted, by track id and by cluster pts, as they are looked
+        // up much more often than they grow
+        typedef std::vector<std::pair<track_id_t, seekpoints_t> > tracks_seekpoints_t;
+        typedef std::vector<Cluster> clusters_t;
 
         typedef std::pair<Seekpoint, Seekpoint> seekpoint_pair_t;
 
         void add_seekpoint( track_id_t, Seekpoint );
+        seekpoints_t& get_track_seekpoints( track_id_t );
 
         seekpoint_pair_t get_seekpoints_around( vlc_tick_t, seekpoints_t const& );
         Seekpoint get_first_seekpoint_around( vlc_tick_t, seekpoints_t const&, Seekpoint::TrustLevel = Seekpoint::TRUSTED );
@@ -110,7 +119,12 @@ class SegmentSeeker
         tracks_seekpoint_t find_greatest_seekpoints_in_range( fptr_t , vlc_tick_t, track_ids_t const& filter_tracks );
 
         cluster_positions_t::iterator add_cluster_position( fptr_t pos );
-        cluster_map_t      ::iterator add_cluster( KaxCluster * const );
+        clusters_t         ::iterator add_cluster( KaxCluster * const );
+        clusters_t         ::iterator add_cluster( Cluster const& );
+
+        void probe_clusters( matroska_segment_c&, vlc_tick_t target_pts );
+        bool probe_cluster_at( matroska_segment_c&, fptr_t start, fptr_t end,
+                               vlc_tick_t min_pts, vlc_tick_t max_pts, Cluster& );
 
         void mkv_jump_to( matroska_segment_c&, fptr_t );
 
@@ -124,7 +138,7 @@ class SegmentSeeker
         ranges_t            _ranges_searched;
         tracks_seekpoints_t _tracks_seekpoints;
         cluster_positions_t _cluster_positions;
-        cluster_map_t       _clusters;
+        clusters_t          _clusters;
 };
 
 } // namespace
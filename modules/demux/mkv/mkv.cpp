@@ -458,6 +458,27 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             msg_Dbg(p_demux,"SET_TIME to %" PRId64, i64 );
             return Seek( p_demux, i64, -1, NULL, b );
 
+        case DEMUX_SET_KEYFRAME_ONLY:
+        {
+            bool b_keyframe_only = va_arg( args, int );
+            /* The next frames may refer to the dropped ones */
+            if( p_sys->b_keyframe_only && !b_keyframe_only &&
+                p_sys->p_current_vsegment && p_sys->p_current_vsegment->CurrentSegment() )
+            {
+                typedef matroska_segment_c::tracks_map_t tracks_map_t;
+
+                matroska_segment_c *p_segment = p_sys->p_current_vsegment->CurrentSegment();
+                for( tracks_map_t::iterator it = p_segment->tracks.begin(); it != p_segment->tracks.end(); ++it )
+                {
+                    mkv_track_t &track = *it->second;
+                    if( track.fmt.i_cat == VIDEO_ES )
+                        track.b_wait_keyframe = true;
+                }
+            }
+            p_sys->b_keyframe_only = b_keyframe_only;
+            return VLC_SUCCESS;
+        }
+
         case DEMUX_CAN_PAUSE:
         case DEMUX_SET_PAUSE_STATE:
         case DEMUX_CAN_CONTROL_PACE:
@@ -552,31 +573,78 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
         }
     }
 
+    /* Fast forward: the other video frames would be dropped anyway. Once
+     * it ended, they are dropped until the next keyframe, as their
+     * references were. */
+    if( track.fmt.i_cat == VIDEO_ES && !b_key_picture &&
+        ( p_sys->b_keyframe_only || track.b_wait_keyframe ) )
+    {
+        track.i_last_dts = VLC_TICK_INVALID;
+        return;
+    }
+    if( b_key_picture )
+        track.b_wait_keyframe = false;
+
     size_t frame_size = 0;
     size_t block_size = internal_block.GetSize();
     const unsigned i_number_frames = internal_block.NumberFrames();
+    vlc_stream_io_callback *p_frames_io = p_segment->p_frames_io;
+    uint64 i_frame_pos = 0;
 
-    for( unsigned int i_frame = 0; i_frame < i_number_frames; i_frame++ )
+    /* The frames were left in the file: read them straight into the blocks */
+    if( p_frames_io != NULL )
     {
-        block_t *p_block;
-        DataBuffer *data = &internal_block.GetBuffer(i_frame);
-
-        frame_size += data->Size();
-        if( !data->Buffer() || data->Size() > frame_size || frame_size > block_size  )
+        i_frame_pos = FramesPosition( internal_block );
+        if( i_frame_pos == 0 )
         {
             msg_Warn( p_demux, "Cannot read frame (too long or no frame)" );
-            break;
+            return;
         }
+    }
+
+    for( unsigned int i_frame = 0; i_frame < i_number_frames; i_frame++ )
+    {
+        block_t *p_block;
         size_t extra_data = track.fmt.i_codec == VLC_CODEC_PRORES ? 8 : 0;
+        bool b_wavpack = false;
 
         if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
             track.p_compression_data != NULL &&
             track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
-            p_block = MemToBlock( data->Buffer(), data->Size(), track.p_compression_data->GetSize() + extra_data );
+            extra_data += track.p_compression_data->GetSize();
         else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
-            p_block = packetize_wavpack( track, data->Buffer(), data->Size() );
+            b_wavpack = true;
+
+        if( p_frames_io != NULL )
+        {
+            size_t i_size = internal_block.GetFrameSize( i_frame );
+
+            p_block = p_frames_io->ReadBlock( i_frame_pos, i_size, extra_data );
+            i_frame_pos += i_size;
+
+            if( p_block != NULL && b_wavpack )
+            {
+                block_t *p_frame = p_block;
+                p_block = packetize_wavpack( track, p_frame->p_buffer, p_frame->i_buffer );
+                block_Release( p_frame );
+            }
+        }
         else
-            p_block = MemToBlock( data->Buffer(), data->Size(), extra_data );
+        {
+            DataBuffer *data = &internal_block.GetBuffer(i_frame);
+
+            frame_size += data->Size();
+            if( !data->Buffer() || data->Size() > frame_size || frame_size > block_size  )
+            {
+                msg_Warn( p_demux, "Cannot read frame (too long or no frame)" );
+                break;
+            }
+
+            if( b_wavpack )
+                p_block = packetize_wavpack( track, data->Buffer(), data->Size() );
+            else
+                p_block = MemToBlock( data->Buffer(), data->Size(), extra_data );
+        }
 
         if( p_block == NULL )
         {
@@ -855,6 +923,7 @@ mkv_track_t::mkv_track_t(enum es_format_category_e es_cat) :
   ,i_chans_to_reorder(0)
   ,p_sys(NULL)
   ,b_discontinuity(false)
+  ,b_wait_keyframe(false)
   ,i_compression_type(MATROSKA_COMPRESSION_NONE)
   ,i_encoding_scope(MATROSKA_ENCODING_SCOPE_ALL_FRAMES)
   ,p_compression_data(NULL)
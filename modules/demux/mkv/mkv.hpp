@@ -219,6 +219,7 @@ class mkv_track_t
         PrivateTrackData *p_sys;
 
         bool            b_discontinuity;
+        bool            b_wait_keyframe; /* since keyframe only mode ended */
 
         /* informative */
         std::string str_codec_name;
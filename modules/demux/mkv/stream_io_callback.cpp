@@ -33,6 +33,8 @@ vlc_stream_io_callback::vlc_stream_io_callback( stream_t *s_, bool b_owner_ )
                        : s( s_), b_owner( b_owner_ )
 {
     mb_eof = false;
+    if( s == NULL || vlc_stream_Control( s, STREAM_CAN_SEEK, &b_seekable ) )
+        b_seekable = false;
 }
 
 uint32 vlc_stream_io_callback::read( void *p_buffer, size_t i_size )
@@ -88,6 +90,29 @@ void vlc_stream_io_callback::setFilePointer(int64_t i_offset, seek_mode mode )
     return;
 }
 
+block_t *vlc_stream_io_callback::ReadBlock( uint64 i_pos, size_t i_size, size_t i_offset )
+{
+    if( unlikely( i_size > SIZE_MAX - i_offset ) )
+        return NULL;
+
+    block_t *p_block = block_Alloc( i_offset + i_size );
+    if( unlikely( p_block == NULL ) )
+        return NULL;
+
+    uint64_t i_current = vlc_stream_Tell( s );
+
+    if( vlc_stream_Seek( s, i_pos ) ||
+        vlc_stream_Read( s, p_block->p_buffer + i_offset, i_size ) != (ssize_t)i_size )
+    {
+        block_Release( p_block );
+        p_block = NULL;
+    }
+
+    if( vlc_stream_Seek( s, i_current ) )
+        mb_eof = true;
+    return p_block;
+}
+
 uint64 vlc_stream_io_callback::getFilePointer( void )
 {
     if ( s == NULL )
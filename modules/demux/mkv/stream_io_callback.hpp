@@ -46,6 +46,7 @@ class vlc_stream_io_callback: public IOCallback
     stream_t       *s;
     bool           mb_eof;
     bool           b_owner;
+    bool           b_seekable;
 
   public:
     vlc_stream_io_callback( stream_t *, bool owner );
@@ -57,6 +58,11 @@ class vlc_stream_io_callback: public IOCallback
     }
 
     bool IsEOF() const { return mb_eof; }
+    bool IsSeekable() const { return b_seekable; }
+
+    /* Reads i_size bytes at i_pos into a new block, after i_offset bytes left
+     * to the caller, without moving the file pointer */
+    block_t         *ReadBlock       ( uint64 i_pos, size_t i_size, size_t i_offset );
 
     virtual uint32   read            ( void *p_buffer, size_t i_size);
     virtual void     setFilePointer  ( int64_t i_offset, seek_mode mode = seek_beginning );
@@ -163,6 +163,20 @@ block_t *MemToBlock( uint8_t *p_mem, size_t i_mem, size_t offset)
     return p_block;
 }
 
+/* Position of the first frame of a block whose data was not read: the frames
+ * end the block, after its header and lacing. Returns 0 if they do not fit */
+uint64 FramesPosition( KaxInternalBlock & block )
+{
+    uint64 i_frames_size = 0;
+
+    for( unsigned int i_frame = 0; i_frame < block.NumberFrames(); i_frame++ )
+        i_frames_size += block.GetFrameSize( i_frame );
+
+    if( i_frames_size > block.GetSize() )
+        return 0;
+    return block.GetEndPosition() - i_frames_size;
+}
+
 
 void handle_real_audio(demux_t * p_demux, mkv_track_t * p_tk, block_t * p_blk, vlc_tick_t i_pts)
 {
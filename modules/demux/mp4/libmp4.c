@@ -362,6 +362,52 @@ static int MP4_PeekBoxHeader( stream_t *p_stream, MP4_Box_t *p_box )
     return 1;
 }
 
+/* Boxes smaller than that are read right away, as skipping them would not
+ * spare any I/O */
+#define MP4_DEFERRED_MIN_SIZE (16 * 1024)
+
+/*****************************************************************************
+ * MP4_BoxCanDefer : whether reading the box can wait for its first access
+ *****************************************************************************
+ * Only the large sample tables and movie user data, that the demuxer may
+ * never need, within a tree read from a seekable stream by MP4_BoxGetRoot
+ *****************************************************************************/
+static bool MP4_BoxCanDefer( stream_t *p_stream, const MP4_Box_t *p_box )
+{
+    const MP4_Box_t *p_father = p_box->p_father;
+
+    if( p_father == NULL || p_box->i_size < MP4_DEFERRED_MIN_SIZE )
+        return false;
+
+    switch( p_box->i_type )
+    {
+        case ATOM_stts:
+        case ATOM_ctts:
+        case ATOM_stsz:
+        case ATOM_stz2:
+        case ATOM_stsc:
+        case ATOM_stco:
+        case ATOM_co64:
+        case ATOM_stss:
+        case ATOM_stsh:
+        case ATOM_sdtp:
+            if( p_father->i_type != ATOM_stbl )
+                return false;
+            break;
+        case ATOM_udta:
+        case ATOM_meta:
+            if( p_father->i_type != ATOM_moov )
+                return false;
+            break;
+        default:
+            return false;
+    }
+
+    while( p_father->p_father )
+        p_father = p_father->p_father;
+    return p_father->i_type == ATOM_root && p_father->p_stream == p_stream;
+}
+
 /*****************************************************************************
  * MP4_ReadBoxRestricted : Reads box from current position
  *****************************************************************************
@@ -423,7 +469,13 @@ static MP4_Box_t *MP4_ReadBoxRestricted( stream_t *p_stream, MP4_Box_t *p_father
 
     const uint64_t i_next = p_box->i_pos + p_box->i_size;
     p_box->p_father = p_father;
-    if( MP4_Box_Read_Specific( p_stream, p_box, p_father ) != VLC_SUCCESS )
+    if( MP4_BoxCanDefer( p_stream, p_box ) )
+    {
+        /* Skipped below, and read by MP4_BoxGet */
+        p_box->e_flags |= BOX_FLAG_DEFERRED;
+        p_box->p_stream = p_stream;
+    }
+    else if( MP4_Box_Read_Specific( p_stream, p_box, p_father ) != VLC_SUCCESS )
     {
         msg_Warn( p_stream, "Failed reading box %4.4s", (char*) &peekbox.i_type );
         MP4_BoxFree( p_box );
@@ -5239,6 +5291,12 @@ MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream )
     if( vlc_stream_GetSize( p_stream, &i_size ) == 0 )
         p_vroot->i_size = i_size;
 
+    bool b_seekable;
+    if( vlc_stream_Control( p_stream, STREAM_CAN_SEEK, &b_seekable ) != VLC_SUCCESS )
+        b_seekable = false;
+    if( b_seekable ) /* the boxes we can come back to are deferred */
+        p_vroot->p_stream = p_stream;
+
     /* First get the moov */
     {
         const uint32_t stoplist[] = { ATOM_moov, ATOM_mdat, 0 };
@@ -5248,8 +5306,7 @@ MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream )
     /* mdat appeared first */
     if( i_result && !MP4_BoxGet( p_vroot, "moov" ) )
     {
-        bool b_seekable;
-        if( vlc_stream_Control( p_stream, STREAM_CAN_SEEK, &b_seekable ) != VLC_SUCCESS || !b_seekable )
+        if( !b_seekable )
         {
             msg_Err( p_stream, "no moov before mdat and the stream is not seekable" );
             goto error;
@@ -5344,7 +5401,8 @@ static void MP4_BoxDumpStructure_Internal( stream_t *s, const MP4_Box_t *p_box,
                   "+ %4.4s size %"PRIu64" offset %" PRIuMAX "%s",
                     (char*)&i_displayedtype, p_box->i_size,
                   (uintmax_t)p_box->i_pos,
-                p_box->e_flags & BOX_FLAG_INCOMPLETE ? " (\?\?\?\?)" : "" );
+                p_box->e_flags & BOX_FLAG_INCOMPLETE ? " (\?\?\?\?)" :
+                p_box->e_flags & BOX_FLAG_DEFERRED ? " (deferred)" : "" );
         msg_Dbg( s, "%s", str );
     }
     p_child = p_box->p_first;
@@ -5416,6 +5474,69 @@ static bool get_token( char **ppsz_path, char **ppsz_token, int *pi_number )
     return true;
 }
 
+/*****************************************************************************
+ * MP4_BoxReadDeferred : read a box skipped by MP4_ReadBoxRestricted
+ *****************************************************************************
+ * The stream position is restored afterwards.
+ * RETURN : false if the box could not be read, and was removed from its
+ *          father and freed
+ *****************************************************************************/
+static bool MP4_BoxReadDeferred( MP4_Box_t *p_box )
+{
+    if( !(p_box->e_flags & BOX_FLAG_DEFERRED) )
+        return true;
+
+    stream_t *p_stream = p_box->p_stream;
+    MP4_Box_t *p_father = p_box->p_father;
+    MP4_Box_t *p_read = NULL;
+    const uint64_t i_pos = vlc_stream_Tell( p_stream );
+
+    p_box->e_flags &= ~BOX_FLAG_DEFERRED;
+    p_box->p_stream = NULL;
+
+    if( MP4_Seek( p_stream, p_box->i_pos ) == VLC_SUCCESS &&
+        ( p_read = MP4_ReadBoxAllocateCheck( p_stream, p_father ) ) != NULL &&
+        MP4_Box_Read_Specific( p_stream, p_read, p_father ) != VLC_SUCCESS )
+    {
+        MP4_BoxFree( p_read );
+        p_read = NULL;
+    }
+
+    if( MP4_Seek( p_stream, i_pos ) != VLC_SUCCESS )
+        msg_Warn( p_stream, "cannot restore position %"PRIu64, i_pos );
+
+    if( p_read == NULL )
+    {
+        msg_Warn( p_stream, "Failed reading deferred box %4.4s",
+                  (char *) &p_box->i_type );
+
+        MP4_Box_t **pp_box = &p_father->p_first, *p_prev = NULL;
+        while( *pp_box != p_box )
+        {
+            p_prev = *pp_box;
+            pp_box = &p_prev->p_next;
+        }
+        *pp_box = p_box->p_next;
+        if( p_father->p_last == p_box )
+            p_father->p_last = p_prev;
+        MP4_BoxFree( p_box );
+        return false;
+    }
+
+    /* Move the payload and the children to the box in the tree */
+    p_box->i_handler = p_read->i_handler;
+    p_box->e_flags |= p_read->e_flags;
+    p_box->data = p_read->data;
+    p_box->pf_free = p_read->pf_free;
+    p_box->p_first = p_read->p_first;
+    p_box->p_last = p_read->p_last;
+    for( MP4_Box_t *p_child = p_box->p_first; p_child; p_child = p_child->p_next )
+        p_child->p_father = p_box;
+    free( p_read );
+
+    return true;
+}
+
 static void MP4_BoxGet_Internal( const MP4_Box_t **pp_result, const MP4_Box_t *p_box,
                                  const char *psz_fmt, va_list args)
 {
@@ -5499,7 +5620,11 @@ static void MP4_BoxGet_Internal( const MP4_Box_t **pp_result, const MP4_Box_t *p
                 {
                     if( !i_number )
                     {
-                        break;
+                        const MP4_Box_t *p_next = p_box->p_next;
+                        if( MP4_BoxReadDeferred( (MP4_Box_t *) p_box ) )
+                            break;
+                        p_box = p_next; /* unreadable, and removed */
+                        continue;
                     }
                     i_number--;
                 }
@@ -5518,7 +5643,11 @@ static void MP4_BoxGet_Internal( const MP4_Box_t **pp_result, const MP4_Box_t *p
                 }
                 if( !i_number )
                 {
-                    break;
+                    const MP4_Box_t *p_next = p_box->p_next;
+                    if( MP4_BoxReadDeferred( (MP4_Box_t *) p_box ) )
+                        break;
+                    p_box = p_next; /* unreadable, and removed */
+                    continue;
                 }
                 i_number--;
                 p_box = p_box->p_next;
@@ -1873,7 +1873,8 @@ struct MP4_Box_s
     enum
     {
         BOX_FLAG_NONE = 0,
-        BOX_FLAG_INCOMPLETE,
+        BOX_FLAG_INCOMPLETE = 1 << 0,
+        BOX_FLAG_DEFERRED   = 1 << 1, /* not read yet, see MP4_BoxGet */
     }            e_flags;
 
     UUID_t       i_uuid;  /* Set if i_type == "uuid" */
@@ -1887,6 +1888,9 @@ struct MP4_Box_s
 
     void (*pf_free)( MP4_Box_t *p_box ); /* pointer to free function for this box */
 
+    stream_t *p_stream; /* on the root, the stream deferred boxes are read
+                           from, and on those boxes until they are read */
+
     MP4_Box_data_t   data;   /* union of pointers on extended data depending
                                 on i_type (or i_usertype) */
 };
@@ -1938,6 +1942,9 @@ MP4_Box_t *MP4_BoxGetNextChunk( stream_t * );
  *****************************************************************************
  *  The first box is a virtual box "root" and is the father for all first
  *  level boxes
+ *  On seekable streams, the large sample tables and user data boxes are
+ *  only read when first returned by MP4_BoxGet, so the stream must outlive
+ *  the tree.
  *****************************************************************************/
 MP4_Box_t *MP4_BoxGetRoot( stream_t * );
 
@@ -1971,6 +1978,8 @@ void MP4_BoxDumpStructure( stream_t *p_input, const MP4_Box_t *p_box );
  *
  * ex: /moov/trak[12]
  *     ../mdia
+ *
+ * Deferred boxes on the path are read, then the stream position is restored.
  *****************************************************************************/
 MP4_Box_t *MP4_BoxGet( const MP4_Box_t *p_box, const char *psz_fmt, ... );
 
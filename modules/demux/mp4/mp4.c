@@ -107,6 +107,7 @@ typedef struct
     bool         b_seekable;
     bool         b_fastseekable;
     bool         b_error;        /* unrecoverable */
+    bool         b_keyframe_only; /* only the video sync samples are demuxed */
 
     bool            b_index_probed;     /* mFra sync points index */
     bool            b_fragments_probed; /* moof segments index created */
@@ -175,6 +176,8 @@ static int  MP4_TrackSeek   ( demux_t *, mp4_track_t *, vlc_tick_t );
 static uint64_t MP4_TrackGetPos    ( mp4_track_t * );
 static uint32_t MP4_TrackGetReadSize( mp4_track_t *, uint32_t * );
 static int      MP4_TrackNextSample( demux_t *, mp4_track_t *, uint32_t );
+static int      MP4_TrackNextSyncSample( demux_t *, mp4_track_t * );
+static int      TrackCreateSamplesIndex( demux_t *, mp4_track_t * );
 static void     MP4_TrackSetELST( demux_t *, mp4_track_t *, int64_t );
 
 static void     MP4_UpdateSeekpoint( demux_t *, vlc_tick_t );
@@ -315,31 +318,38 @@ static es_out_id_t * MP4_AddTrackES( es_out_t *out, mp4_track_t *p_track )
     return p_es;
 }
 
+/* Returns the track scaled DTS of a sample of the chunk, from its stts
+ * checkpoint */
+static stime_t MP4_ChunkGetDTS( const mp4_track_t *p_track,
+                                const mp4_chunk_t *p_chunk, uint32_t i_sample )
+{
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    stime_t sdts = p_chunk->i_first_dts;
+
+    if( stts == NULL )
+        return sdts;
+
+    uint32_t i_skip = p_chunk->i_dts_entry_skip;
+    for( uint32_t i_entry = p_chunk->i_dts_entry;
+         i_sample > 0 && i_entry < stts->i_entry_count; i_entry++ )
+    {
+        uint32_t i_count = __MIN( stts->pi_sample_count[i_entry] - i_skip,
+                                  i_sample );
+        sdts += (stime_t) i_count * stts->pi_sample_delta[i_entry];
+        i_sample -= i_count;
+        i_skip = 0;
+    }
+    return sdts;
+}
+
 /* Return time in microsecond of a track */
 static inline vlc_tick_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
 
-    unsigned int i_index = 0;
-    unsigned int i_sample = p_track->i_sample - p_chunk->i_sample_first;
-    int64_t sdts = p_chunk->i_first_dts;
-
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
-        {
-            sdts += p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            sdts += i_sample * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
+    stime_t sdts = MP4_ChunkGetDTS( p_track, p_chunk,
+                                    p_track->i_sample - p_chunk->i_sample_first );
 
     vlc_tick_t i_dts = MP4_rescale( sdts, p_track->i_timescale, CLOCK_FREQ );
 
@@ -369,24 +379,30 @@ static inline bool MP4_TrackGetPTSDelta( demux_t *p_demux, mp4_track_t *p_track,
                                          vlc_tick_t *pi_delta )
 {
     VLC_UNUSED( p_demux );
-    mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk];
+    const mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk];
+    const MP4_Box_data_ctts_t *ctts = p_track->p_ctts;
 
-    unsigned int i_index = 0;
-    unsigned int i_sample = p_track->i_sample - ck->i_sample_first;
+    if( ctts == NULL )
+        return false;
 
-    if( ck->p_sample_count_pts == NULL || ck->p_sample_offset_pts == NULL )
+    /* from the start of the checkpoint entry */
+    uint32_t i_sample = p_track->i_sample - ck->i_sample_first;
+    if( UINT32_MAX - i_sample < ck->i_pts_entry_skip )
         return false;
+    i_sample += ck->i_pts_entry_skip;
 
-    for( i_index = 0; i_index < ck->i_entries_pts ; i_index++ )
+    for( uint32_t i_entry = ck->i_pts_entry; i_entry < ctts->i_entry_count;
+         i_entry++ )
     {
-        if( i_sample < ck->p_sample_count_pts[i_index] )
+        if( i_sample < ctts->pi_sample_count[i_entry] )
         {
-            *pi_delta = MP4_rescale( ck->p_sample_offset_pts[i_index],
+            *pi_delta = MP4_rescale( ctts->pi_sample_offset[i_entry] +
+                                     p_track->i_cts_shift,
                                      p_track->i_timescale, CLOCK_FREQ );
             return true;
         }
 
-        i_sample -= ck->p_sample_count_pts[i_index];
+        i_sample -= ctts->pi_sample_count[i_entry];
     }
     return false;
 }
@@ -397,43 +413,15 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
     VLC_UNUSED( p_demux );
 
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    stime_t i_duration = 0;
+    const uint32_t i_sample = p_track->i_sample - p_chunk->i_sample_first;
 
-    /* Forward to right index, and set remaining count in that index */
-    unsigned i_index = 0;
-    unsigned i_remain = 0;
-    for( unsigned i = p_chunk->i_sample_first;
-         i<p_track->i_sample && i_index < p_chunk->i_entries_dts; )
-    {
-        if( p_track->i_sample - i >= p_chunk->p_sample_count_dts[i_index] )
-        {
-            i += p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            i_remain = p_track->i_sample - i;
-            break;
-        }
-    }
+    /* Only the samples of the chunk */
+    if( i_sample >= p_chunk->i_sample_count )
+        return 0;
+    i_nb_samples = __MIN( i_nb_samples, p_chunk->i_sample_count - i_sample );
 
-    /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
-        {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
-            i_index++;
-            i_remain = 0;
-        }
-        else
-        {
-            i_duration += i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
+    stime_t i_duration = MP4_ChunkGetDTS( p_track, p_chunk, i_sample + i_nb_samples )
+                       - MP4_ChunkGetDTS( p_track, p_chunk, i_sample );
 
     return MP4_rescale( i_duration, p_track->i_timescale, CLOCK_FREQ );
 }
@@ -1254,7 +1242,7 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
     uint32_t i_nb_samples = 0;
     uint32_t i_samplessize = 0;
 
-    if( !tk->b_ok || tk->i_sample >= tk->i_sample_count )
+    if( !tk->b_ok || !tk->b_indexed || tk->i_sample >= tk->i_sample_count )
         return VLC_DEMUXER_EOS;
 
     if( tk->b_chapters_source )
@@ -1277,6 +1265,23 @@ static int DemuxTrack( demux_t *p_demux, mp4_track_t *tk, uint64_t i_readpos,
                  MP4_GetMoviePTS( p_demux->p_sys ), i_readpos );
 #endif
 
+        /* Fast forward: go straight to the next sync sample */
+        if( p_sys->b_keyframe_only && tk->fmt.i_cat == VIDEO_ES )
+        {
+            if( MP4_TrackNextSyncSample( p_demux, tk ) != VLC_SUCCESS )
+                return VLC_DEMUXER_EOS;
+
+            vlc_tick_t i_sync_nzdts = MP4_TrackGetDTS( p_demux, tk );
+            if( i_sync_nzdts != i_current_nzdts )
+            {
+                i_current_nzdts = i_sync_nzdts;
+                i_readpos = MP4_TrackGetPos( tk );
+                /* Demuxed when the other tracks catch up */
+                if( i_current_nzdts > i_demux_max_nzdts )
+                    break;
+            }
+        }
+
         i_samplessize = MP4_TrackGetReadSize( tk, &i_nb_samples );
         if( i_samplessize > 0 )
         {
@@ -1384,7 +1389,8 @@ static int DemuxMoov( demux_t *p_demux )
         for( i_track = 0; i_track < p_sys->i_tracks; i_track++ )
         {
             mp4_track_t *tk = &p_sys->track[i_track];
-            if( !tk->b_ok || tk->b_chapters_source || tk->i_sample >= tk->i_sample_count )
+            if( !tk->b_ok || !tk->b_indexed || tk->b_chapters_source ||
+                tk->i_sample >= tk->i_sample_count )
                 continue;
             /* Test for EOF on each track (samples count, edit list) */
             b_eof &= ( i_nztime > MP4_TrackGetDTS( p_demux, tk ) );
@@ -2203,6 +2209,28 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
         case DEMUX_CAN_RECORD:
             return VLC_EGENERIC;
 
+        case DEMUX_SET_KEYFRAME_ONLY:
+        {
+            const bool b_keyframe_only = va_arg( args, int );
+
+            if( p_sys->b_fragmented )
+                return VLC_EGENERIC;
+
+            /* Resume on a sync sample, as the previous ones were skipped */
+            if( p_sys->b_keyframe_only && !b_keyframe_only )
+            {
+                for( unsigned i = 0; i < p_sys->i_tracks; i++ )
+                {
+                    mp4_track_t *tk = &p_sys->track[i];
+                    if( tk->b_ok && tk->b_selected && tk->fmt.i_cat == VIDEO_ES
+                     && tk->i_sample < tk->i_sample_count )
+                        MP4_TrackNextSyncSample( p_demux, tk );
+                }
+            }
+            p_sys->b_keyframe_only = b_keyframe_only;
+            return VLC_SUCCESS;
+        }
+
         case DEMUX_CAN_PAUSE:
         case DEMUX_SET_PAUSE_STATE:
         case DEMUX_CAN_CONTROL_PACE:
@@ -2299,6 +2327,13 @@ static void LoadChapterApple( demux_t  *p_demux, mp4_track_t *tk )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    /* A text track that is not played has no sample index yet */
+    if( !tk->b_indexed && TrackCreateSamplesIndex( p_demux, tk ) )
+    {
+        msg_Warn( p_demux, "cannot create samples index for chapters" );
+        return;
+    }
+
     for( tk->i_sample = 0; tk->i_sample < tk->i_sample_count; tk->i_sample++ )
     {
         const vlc_tick_t i_dts = MP4_TrackGetDTS( p_demux, tk );
@@ -2431,12 +2466,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
 
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2498,52 +2527,56 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
+/* Sets the checkpoint of every chunk in a run-length time table (stts or
+ * ctts), and sums the DTS if pi_sample_delta is set */
+static bool xTTS_CreateCheckpoints( mp4_track_t *p_demux_track, bool b_pts,
+                                   const uint32_t *pi_sample_count,
+                                   const int32_t *pi_sample_delta,
+                                   uint32_t i_entry_count,
+                                   int64_t *pi_next_dts )
 {
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
+    uint32_t i_entry = 0;
+    uint32_t i_skip = 0;
+    bool b_complete = true;
+
+    for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
     {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
+        mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
 
-        if ( i_array_offset >= i_table_count )
+        if( b_pts )
+        {
+            ck->i_pts_entry = i_entry;
+            ck->i_pts_entry_skip = i_skip;
+        }
+        else
         {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_ENOVAR;
+            ck->i_dts_entry = i_entry;
+            ck->i_dts_entry_skip = i_skip;
+            ck->i_first_dts = *pi_next_dts;
         }
 
-        if ( i_index_samples_left )
+        uint32_t i_left = ck->i_sample_count;
+        while( i_left > 0 && i_entry < i_entry_count )
         {
-            if ( i_index_samples_left > i_sample_count )
+            uint32_t i_count = __MIN( pi_sample_count[i_entry] - i_skip, i_left );
+            if( pi_sample_delta )
+                *pi_next_dts += (int64_t) i_count * pi_sample_delta[i_entry];
+            i_left -= i_count;
+            i_skip += i_count;
+            if( i_skip == pi_sample_count[i_entry] )
             {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
+                i_entry++;
+                i_skip = 0;
             }
         }
-        else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
+        if( i_left > 0 )
+            b_complete = false;
+
+        if( !b_pts )
+            ck->i_duration = *pi_next_dts - ck->i_first_dts;
     }
 
-    return VLC_SUCCESS;
+    return b_complete;
 }
 
 static int TrackCreateSamplesIndex( demux_t *p_demux,
@@ -2583,19 +2616,11 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, read from the box */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
+    p_demux_track->offset_cache.i_chunk = 0;
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
     {
@@ -2607,226 +2632,62 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         }
     }
 
-    /* Use stts table to create a sample number -> dts table.
-     * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+    /* The stts and ctts tables are run-length encoded already: rather than
+     * expanding them, each chunk only records where its samples start in
+     * them. */
 
     int64_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "stts" );
-    if( !p_box )
+    if( !p_box || !p_box->data.p_stts )
     {
         msg_Warn( p_demux, "cannot find STTS box" );
         return VLC_EGENERIC;
     }
     else
     {
-        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        const MP4_Box_data_stts_t *stts = p_box->data.p_stts;
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
-        uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
-
-        for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
-        {
-            mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* save first dts */
-            ck->i_first_dts = i_next_dts;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            ck->p_sample_delta_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            if( !ck->p_sample_count_dts || !ck->p_sample_delta_dts )
-            {
-                free( ck->p_sample_count_dts );
-                free( ck->p_sample_delta_dts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-            }
-        }
+        p_demux_track->p_stts = stts;
+        if( !xTTS_CreateCheckpoints( p_demux_track, false,
+                                     stts->pi_sample_count,
+                                     stts->pi_sample_delta,
+                                     stts->i_entry_count, &i_next_dts ) )
+            msg_Warn( p_demux, "STTS table is too small" );
     }
 
-
     /* Find ctts
      *  Gives the delta between decoding time (dts) and composition table (pts)
      */
+    p_demux_track->p_ctts = NULL;
+    p_demux_track->i_cts_shift = 0;
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "ctts" );
     if( p_box && p_box->data.p_ctts )
     {
-        MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        const MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
-        int64_t i_cts_shift = 0;
         const MP4_Box_t *p_cslg = MP4_BoxGet( p_demux_track->p_stbl, "cslg" );
         if( p_cslg && BOXDATA(p_cslg) )
-            i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
-
-        /* Create pts-dts table per chunk */
-        uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
-
-        for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
-        {
-            mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_pts = calloc( ck->i_entries_pts, sizeof( uint32_t ) );
-            ck->p_sample_offset_pts = calloc( ck->i_entries_pts, sizeof( int32_t ) );
-            if( !ck->p_sample_count_pts || !ck->p_sample_offset_pts )
-            {
-                free( ck->p_sample_count_pts );
-                free( ck->p_sample_offset_pts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
+            p_demux_track->i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
 
-            }
-        }
+        p_demux_track->p_ctts = ctts;
+        if( !xTTS_CreateCheckpoints( p_demux_track, true,
+                                     ctts->pi_sample_count, NULL,
+                                     ctts->i_entry_count, &i_next_dts ) )
+            msg_Warn( p_demux, "CTTS table is too small" );
     }
 
     msg_Dbg( p_demux, "track[Id 0x%x] read %"PRIu32" samples length:%"PRId64"s",
              p_demux_track->i_track_ID, p_demux_track->i_sample_count,
              i_next_dts / p_demux_track->i_timescale );
 
+    p_demux_track->b_indexed = true;
     return VLC_SUCCESS;
 }
 
@@ -3076,10 +2937,9 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
     uint64_t     i_dts;
     unsigned int i_sample;
     unsigned int i_chunk;
-    int          i_index;
 
     /* FIXME see if it's needed to check p_track->i_chunk_count */
-    if( p_track->i_chunk_count == 0 )
+    if( p_track->i_chunk_count == 0 || !p_track->b_indexed )
         return( VLC_EGENERIC );
 
     /* handle elst (find the correct one) */
@@ -3119,53 +2979,51 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         i_start = MP4_rescale( i_start, CLOCK_FREQ, p_track->i_timescale );
     }
 
-    /* we start from sample 0/chunk 0, hope it won't take too much time */
-    /* *** find good chunk *** */
-    for( i_chunk = 0; ; i_chunk++ )
+    /* *** find good chunk: the last one starting before i_start *** */
+    unsigned i_low = 1, i_high = p_track->i_chunk_count;
+    while( i_low < i_high )
     {
-        if( i_chunk + 1 >= p_track->i_chunk_count )
-        {
-            /* at the end and can't check if i_start in this chunk,
-               it will be check while searching i_sample */
-            i_chunk = p_track->i_chunk_count - 1;
-            break;
-        }
-
-        if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
-            (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
-        {
-            break;
-        }
+        unsigned i_mid = i_low + (i_high - i_low) / 2;
+        if( p_track->chunk[i_mid].i_first_dts <= (uint64_t)i_start )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
     }
+    i_chunk = i_low - 1;
 
     /* *** find sample in the chunk *** */
-    i_sample = p_track->chunk[i_chunk].i_sample_first;
-    i_dts    = p_track->chunk[i_chunk].i_first_dts;
-    for( i_index = 0; i_sample < p_track->chunk[i_chunk].i_sample_count; )
+    const mp4_chunk_t *ck = &p_track->chunk[i_chunk];
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    i_sample = ck->i_sample_first;
+    i_dts    = ck->i_first_dts;
+    uint32_t i_left = ck->i_sample_count;
+    uint32_t i_skip = ck->i_dts_entry_skip;
+    for( uint32_t i_entry = ck->i_dts_entry;
+         stts && i_left > 0 && i_entry < stts->i_entry_count; i_entry++ )
     {
-        if( i_dts +
-            p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
-        {
-            i_dts    +=
-                p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+        uint32_t i_count = __MIN( stts->pi_sample_count[i_entry] - i_skip, i_left );
+        int32_t i_delta = stts->pi_sample_delta[i_entry];
+        i_skip = 0;
 
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
-            i_index++;
+        if( i_dts + (int64_t) i_count * i_delta < (uint64_t)i_start )
+        {
+            i_dts    += (int64_t) i_count * i_delta;
+            i_sample += i_count;
+            i_left   -= i_count;
         }
         else
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
-            {
-                break;
-            }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            if( i_delta > 0 )
+                i_sample += ( i_start - i_dts ) / i_delta;
             break;
         }
     }
 
+    /* past the last sample DTS of the chunk, but before the next chunk */
+    if( ck->i_sample_count > 0 &&
+        i_sample >= ck->i_sample_first + ck->i_sample_count )
+        i_sample = ck->i_sample_first + ck->i_sample_count - 1;
+
     if( i_sample >= p_track->i_sample_count )
     {
         msg_Warn( p_demux, "track[Id 0x%x] will be disabled "
@@ -3497,9 +3355,8 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
         }
     }
 
-    /* Create chunk index table and sample index table */
-    if( TrackCreateChunksIndex( p_demux,p_track  ) ||
-        TrackCreateSamplesIndex( p_demux, p_track ) )
+    /* Create chunk index table */
+    if( TrackCreateChunksIndex( p_demux,p_track  ) )
     {
         msg_Err( p_demux, "cannot create chunks index" );
         return; /* cannot create chunks index */
@@ -3584,6 +3441,18 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
     if( !p_track->b_enable )
         p_track->fmt.i_priority = ES_PRIORITY_NOT_DEFAULTABLE;
 
+    /* The sample tables of the tracks that are not played are only read on
+     * selection, by MP4_TrackSeek, when we can seek back to them. The audio
+     * setup depends on the sample size though. */
+    bool b_index = !p_sys->b_seekable || p_track->b_chapters_source ||
+                   p_track->fmt.i_cat == AUDIO_ES;
+
+    if( b_index && TrackCreateSamplesIndex( p_demux, p_track ) )
+    {
+        msg_Err( p_demux, "cannot create samples index" );
+        return;
+    }
+
     if( TrackCreateES( p_demux,
                        p_track, p_track->i_chunk,
                       (p_track->b_chapters_source || !b_create_es) ? NULL : &p_track->p_es ) )
@@ -3593,16 +3462,18 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
         return;
     }
 
-    p_track->b_ok = true;
-}
+    if( !b_index && p_track->p_es && !p_demux->b_preparsing )
+        es_out_Control( p_demux->out, ES_OUT_GET_ES_STATE, p_track->p_es,
+                        &b_index );
 
-static void DestroyChunk( mp4_chunk_t *ck )
-{
-    free( ck->p_sample_count_dts );
-    free( ck->p_sample_delta_dts );
-    free( ck->p_sample_count_pts );
-    free( ck->p_sample_offset_pts );
-    free( ck->p_sample_size );
+    if( b_index && !p_track->b_indexed &&
+        TrackCreateSamplesIndex( p_demux, p_track ) )
+    {
+        msg_Err( p_demux, "cannot create samples index" );
+        return;
+    }
+
+    p_track->b_ok = true;
 }
 
 /****************************************************************************
@@ -3617,16 +3488,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            DestroyChunk( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     if ( p_track->asfinfo.p_frame )
         block_ChainRelease( p_track->asfinfo.p_frame );
 
@@ -3668,6 +3531,24 @@ static int MP4_TrackSeek( demux_t *p_demux, mp4_track_t *p_track,
 
     p_track->b_selected = false;
 
+    if( !p_track->b_indexed )
+    {
+        bool b_es_selected = false;
+        if( p_track->p_es )
+            es_out_Control( p_demux->out, ES_OUT_GET_ES_STATE,
+                            p_track->p_es, &b_es_selected );
+        if( !b_es_selected )
+            return VLC_EGENERIC; /* not played, no need for its tables */
+
+        if( TrackCreateSamplesIndex( p_demux, p_track ) )
+        {
+            msg_Err( p_demux, "cannot create samples index for track[Id 0x%x]",
+                     p_track->i_track_ID );
+            p_track->b_ok = false;
+            return VLC_EGENERIC;
+        }
+    }
+
     if( TrackTimeToSampleChunk( p_demux, p_track, i_start,
                                 &i_chunk, &i_sample ) )
     {
@@ -3736,7 +3617,7 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
     uint32_t i_size = 0;
     *pi_nb_samples = 0;
 
-    if ( p_track->i_sample == p_track->i_sample_count )
+    if ( !p_track->b_indexed || p_track->i_sample == p_track->i_sample_count )
         return 0;
 
     if ( p_track->fmt.i_cat != AUDIO_ES )
@@ -3895,6 +3776,9 @@ static uint64_t MP4_TrackGetPos( mp4_track_t *p_track )
 
     i_pos = p_track->chunk[p_track->i_chunk].i_offset;
 
+    if( !p_track->b_indexed ) /* no sample sizes yet */
+        return i_pos;
+
     if( p_track->i_sample_size )
     {
         MP4_Box_data_sample_soun_t *p_soun =
@@ -3932,11 +3816,22 @@ static uint64_t MP4_TrackGetPos( mp4_track_t *p_track )
     }
     else
     {
-        for( i_sample = p_track->chunk[p_track->i_chunk].i_sample_first;
-             i_sample < p_track->i_sample; i_sample++ )
+        /* Sequential reads only add the size of the previous sample */
+        i_sample = p_track->chunk[p_track->i_chunk].i_sample_first;
+        if( p_track->offset_cache.i_chunk == p_track->i_chunk + 1 &&
+            p_track->offset_cache.i_sample >= i_sample &&
+            p_track->offset_cache.i_sample <= p_track->i_sample )
         {
-            i_pos += p_track->p_sample_size[i_sample];
+            i_sample = p_track->offset_cache.i_sample;
+            i_pos = p_track->offset_cache.i_pos;
         }
+
+        for( ; i_sample < p_track->i_sample; i_sample++ )
+            i_pos += p_track->p_sample_size[i_sample];
+
+        p_track->offset_cache.i_chunk = p_track->i_chunk + 1;
+        p_track->offset_cache.i_sample = i_sample;
+        p_track->offset_cache.i_pos = i_pos;
     }
 
     return i_pos;
@@ -3989,6 +3884,44 @@ static int MP4_TrackNextSample( demux_t *p_demux, mp4_track_t *p_track, uint32_t
     return VLC_SUCCESS;
 }
 
+/* Moves the track to its first sync sample from the current one, using the
+ * Sync Sample Box (every sample is a sync sample without it) */
+static int MP4_TrackNextSyncSample( demux_t *p_demux, mp4_track_t *p_track )
+{
+    const MP4_Box_t *p_stss = MP4_BoxGet( p_track->p_stbl, "stss" );
+    if( p_stss == NULL || BOXDATA(p_stss) == NULL )
+        return VLC_SUCCESS;
+
+    const MP4_Box_data_stss_t *p_stss_data = BOXDATA(p_stss);
+    uint32_t i_low = 0, i_high = p_stss_data->i_entry_count;
+    while( i_low < i_high )
+    {
+        uint32_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_stss_data->i_sample_number[i_mid] < p_track->i_sample )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+
+    if( i_low == p_stss_data->i_entry_count ||
+        p_stss_data->i_sample_number[i_low] >= p_track->i_sample_count )
+    {
+        p_track->i_sample = p_track->i_sample_count;
+        return VLC_EGENERIC;
+    }
+
+    const uint32_t i_sync = p_stss_data->i_sample_number[i_low];
+    if( i_sync == p_track->i_sample )
+        return VLC_SUCCESS;
+
+    unsigned i_chunk = p_track->i_chunk;
+    while( i_chunk + 1 < p_track->i_chunk_count &&
+           p_track->chunk[i_chunk + 1].i_sample_first <= i_sync )
+        i_chunk++;
+
+    return TrackGotoChunkSample( p_demux, p_track, i_chunk, i_sync );
+}
+
 static void MP4_TrackSetELST( demux_t *p_demux, mp4_track_t *tk,
                               int64_t i_time )
 {
@@ -40,24 +40,17 @@ typedef struct
     uint32_t     i_sample; /* index of the next sample to read in this chunk */
     uint32_t     i_virtual_run_number; /* chunks interleaving sequence */
 
-    /* now provide way to calculate pts, dts, and offset without too
-        much memory and with fast access */
-
-    /* with this we can calculate dts/pts without waste memory */
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    int32_t      *p_sample_offset_pts;  /* pts-dts */
-
-    uint32_t     *p_sample_size;
-    /* TODO if needed add pts
-        but quickly *add* support for edts and seeking */
+    /* Checkpoints in the run-length stts and ctts tables of the track: the
+     * entry of the first sample, and how many samples of that entry belong
+     * to the previous chunks. The timestamps of the other samples are summed
+     * from there, so that the tables are never expanded. */
+    uint32_t     i_dts_entry;
+    uint32_t     i_dts_entry_skip;
+    uint32_t     i_pts_entry;
+    uint32_t     i_pts_entry_skip;
 
 } mp4_chunk_t;
 
@@ -116,12 +109,26 @@ typedef struct
     uint32_t         i_sample_count;
 
     mp4_chunk_t    *chunk; /* always defined  for each chunk */
+    bool            b_indexed; /* sample tables read, else on selection */
 
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* stsz table */
+
+    /* file offset of a sample of the current chunk, the sizes of the next
+     * samples are summed from there */
+    struct
+    {
+        uint32_t i_chunk; /* chunk index + 1, 0 if unset */
+        uint32_t i_sample;
+        uint64_t i_pos;
+    } offset_cache;
+
+    /* time tables, read from the chunk checkpoints */
+    const MP4_Box_data_stts_t *p_stts;
+    const MP4_Box_data_ctts_t *p_ctts; /* can be NULL */
+    int64_t          i_cts_shift;
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
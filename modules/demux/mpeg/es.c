@@ -36,6 +36,7 @@
 #include <vlc_codec.h>
 #include <vlc_codecs.h>
 #include <vlc_input.h>
+#include <vlc_seek_index.h>
 
 #include "../../packetizer/a52.h"
 #include "../../packetizer/dts_header.h"
@@ -133,6 +134,13 @@ typedef struct
     vlc_tick_t  i_pts;
     vlc_tick_t  i_time_offset;
     int64_t     i_bytes;
+    /* The audio packetizers output the frames whole and in order, so the
+     * offset of each frame follows from the first one */
+    bool        b_exact_pos; /* i_frame_pos and the time are not estimates */
+    uint64_t    i_frame_pos; /* of the next frame output by the packetizer */
+    uint64_t    i_block_end; /* of the data given to the packetizer */
+
+    vlc_seek_index_t *p_seek_index;
 
     bool        b_big_endian;
     bool        b_estimate_bitrate;
@@ -183,6 +191,10 @@ static int MlpInit( demux_t *p_demux );
 static bool Parse( demux_t *p_demux, block_t **pp_output );
 static uint64_t SeekByMlltTable( demux_t *p_demux, vlc_tick_t *pi_time );
 
+/* Farthest recorded point from the requested time, to seek to it rather
+ * than by bitrate */
+#define SEEK_INDEX_MAX_DISTANCE VLC_TICK_FROM_SEC(3)
+
 static const codec_t p_codecs[] = {
     { VLC_CODEC_MP4A, false, "mp4 audio",  AacProbe,  AacInit },
     { VLC_CODEC_MPGA, false, "mpeg audio", MpgaProbe, MpgaInit },
@@ -218,6 +230,8 @@ static int OpenCommon( demux_t *p_demux,
     p_sys->b_start = true;
     p_sys->i_stream_offset = i_bs_offset;
     p_sys->b_estimate_bitrate = true;
+    p_sys->b_exact_pos = true;
+    p_sys->i_frame_pos = i_bs_offset;
     p_sys->i_bitrate_avg = 0;
     p_sys->b_big_endian = false;
     p_sys->f_fps = var_InheritFloat( p_demux, "es-fps" );
@@ -235,6 +249,11 @@ static int OpenCommon( demux_t *p_demux,
         return VLC_EGENERIC;
     }
 
+    /* Every audio frame is a random access point. The AAC packetizer strips
+     * the ADTS or LOAS headers, so the frame offsets cannot be tracked. */
+    if( i_cat == AUDIO_ES && p_codec->i_codec != VLC_CODEC_MP4A )
+        p_sys->p_seek_index = vlc_seek_index_New( p_demux, "es" );
+
     msg_Dbg( p_demux, "detected format %4.4s", (const char*)&p_sys->codec.i_codec );
 
     /* Load the audio packetizer */
@@ -243,6 +262,8 @@ static int OpenCommon( demux_t *p_demux,
     p_sys->p_packetizer = demux_PacketizerNew( p_demux, &fmt, p_sys->codec.psz_name );
     if( !p_sys->p_packetizer )
     {
+        if( p_sys->p_seek_index )
+            vlc_seek_index_Delete( p_sys->p_seek_index );
         free( p_sys );
         return VLC_EGENERIC;
     }
@@ -325,6 +346,8 @@ static int Demux( demux_t *p_demux )
     else
         ret = Parse( p_demux, &p_block_out ) ? 0 : 1;
 
+    bool b_record = p_sys->p_seek_index && p_sys->b_exact_pos;
+
     while( p_block_out )
     {
         block_t *p_next = p_block_out->p_next;
@@ -352,6 +375,21 @@ static int Demux( demux_t *p_demux )
             p_block_out->i_dts += p_sys->i_time_offset;
             es_out_SetPCR( p_demux->out, p_block_out->i_dts );
         }
+        uint64_t i_frame_pos = p_sys->i_frame_pos;
+        p_sys->i_frame_pos += p_block_out->i_buffer;
+        if( b_record && p_block_out->i_pts != VLC_TICK_INVALID )
+        {
+            /* Garbage skipped by the packetizer makes the offsets early,
+             * which only costs a resynchronization. Frames larger than
+             * the data read mean that the offsets are lost. */
+            if( p_sys->i_frame_pos <= p_sys->i_block_end )
+                vlc_seek_index_Add( p_sys->p_seek_index,
+                                    p_sys->i_pts + p_sys->i_time_offset,
+                                    i_frame_pos );
+            else
+                p_sys->b_exact_pos = false;
+            b_record = false;
+        }
         /* Re-estimate bitrate */
         if( p_sys->b_estimate_bitrate && p_sys->i_pts > VLC_TICK_FROM_MS(500) )
             p_sys->i_bitrate_avg = 8 * CLOCK_FREQ * p_sys->i_bytes
@@ -379,6 +417,8 @@ static void Close( vlc_object_t * p_this )
         block_ChainRelease( p_sys->p_packetized_data );
     if( p_sys->mllt.p_bits )
         free( p_sys->mllt.p_bits );
+    if( p_sys->p_seek_index )
+        vlc_seek_index_Delete( p_sys->p_seek_index );
     demux_PacketizerDestroy( p_sys->p_packetizer );
     free( p_sys );
 }
@@ -444,12 +484,52 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
                 if( i_ret != VLC_SUCCESS )
                     return i_ret;
                 p_sys->i_time_offset = i_time - p_sys->i_pts;
+                /* The packetizer keeps the data read before the seek */
+                p_sys->b_exact_pos = false;
                 /* And reset buffered data */
                 if( p_sys->p_packetized_data )
                     block_ChainRelease( p_sys->p_packetized_data );
                 p_sys->p_packetized_data = NULL;
                 return VLC_SUCCESS;
             }
+            else if( p_sys->p_seek_index )
+            {
+                va_list ap;
+                va_copy( ap, args );
+                vlc_tick_t i_time = va_arg( ap, vlc_tick_t ), i_point;
+                bool b_precise = va_arg( ap, int );
+                va_end( ap );
+                uint64_t i_pos;
+
+                /* Played before: resume from the position recorded then */
+                if( vlc_seek_index_Lookup( p_sys->p_seek_index, i_time,
+                                           &i_point, &i_pos ) &&
+                    i_time - i_point <= SEEK_INDEX_MAX_DISTANCE &&
+                    vlc_stream_Seek( p_demux->s, i_pos ) == VLC_SUCCESS )
+                {
+                    if( p_sys->p_packetized_data )
+                        block_ChainRelease( p_sys->p_packetized_data );
+                    p_sys->p_packetized_data = NULL;
+
+                    /* Restart the packetizer at the recorded frame, dated
+                     * from zero as when opening */
+                    if( p_sys->p_packetizer->pf_flush )
+                        p_sys->p_packetizer->pf_flush( p_sys->p_packetizer );
+                    p_sys->b_start = true;
+                    p_sys->i_pts = 0;
+                    p_sys->i_bytes = 0;
+                    p_sys->i_time_offset = i_point;
+                    p_sys->i_frame_pos = i_pos;
+                    p_sys->b_exact_pos = true;
+
+                    /* The point is up to SEEK_INDEX_MAX_DISTANCE early */
+                    if( b_precise )
+                        es_out_Control( p_demux->out,
+                                        ES_OUT_SET_NEXT_DISPLAY_TIME,
+                                        VLC_TICK_0 + i_time );
+                    return VLC_SUCCESS;
+                }
+            }
             /* FIXME TODO: implement a high precision seek (with mp3 parsing)
              * needed for multi-input */
             break;
@@ -460,6 +540,9 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     if( ret != VLC_SUCCESS )
         return ret;
 
+    if( i_query == DEMUX_SET_POSITION || i_query == DEMUX_SET_TIME )
+        p_sys->b_exact_pos = false;
+
     if( p_sys->i_bitrate_avg > 0
      && (i_query == DEMUX_SET_POSITION || i_query == DEMUX_SET_TIME) )
     {
@@ -497,8 +580,11 @@ static bool Parse( demux_t *p_demux, block_t **pp_output )
             return true;
     }
 
+    p_sys->i_block_end = vlc_stream_Tell( p_demux->s );
     p_block_in = vlc_stream_Block( p_demux->s, p_sys->i_packet_size );
     bool b_eof = p_block_in == NULL;
+    if( p_block_in )
+        p_sys->i_block_end += p_block_in->i_buffer;
 
     if( p_block_in )
     {
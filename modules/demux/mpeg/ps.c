@@ -766,6 +766,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             break;
 
         case DEMUX_SET_TIME:
+            /* No seek index (vlc_seek_index.h) here: the packs are not
+             * random access points, as the video must resume on an I frame
+             * that they do not locate, and the time reported comes either
+             * from a track PTS or from the SCR, so that recorded points would
+             * not share the base of the requests */
             i64 = va_arg( args, int64_t );
             if( p_sys->i_time_track_index >= 0 && p_sys->i_current_pts > 0 && p_sys->i_length )
             {
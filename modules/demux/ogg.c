@@ -376,6 +376,7 @@ static int Demux( demux_t * p_demux )
     demux_sys_t *p_sys = p_demux->p_sys;
     ogg_packet  oggpacket;
     int         i_stream;
+    int64_t     i_pagepos = -1;
     bool b_canseek;
 
     int i_active_streams = p_sys->i_streams;
@@ -459,6 +460,10 @@ static int Demux( demux_t * p_demux )
          */
         if( Ogg_ReadPage( p_demux, &p_sys->current_page ) != VLC_SUCCESS )
             return VLC_DEMUXER_EOF; /* EOF */
+        /* The page is the last one out of the sync buffer */
+        i_pagepos = vlc_stream_Tell( p_demux->s )
+                  - ( p_sys->oy.fill - p_sys->oy.returned )
+                  - p_sys->current_page.header_len - p_sys->current_page.body_len;
         /* Test for End of Stream */
         if( ogg_page_eos( &p_sys->current_page ) )
         {
@@ -517,6 +522,17 @@ static int Demux( demux_t * p_demux )
         if ( ! ogg_page_eos( &p_sys->current_page ) && p_sys->p_skelstream != p_stream )
             p_stream->b_finished = false;
 
+        /* Index the pages as we read them, for the next seeks */
+        if ( i_pagepos > 0 && !p_stream->b_initializing &&
+             ogg_page_granulepos( &p_sys->current_page ) > 0 )
+        {
+            OggSeek_IndexAdd( p_stream,
+                              Ogg_GranuleToTime( p_stream,
+                                                 ogg_page_granulepos( &p_sys->current_page ),
+                                                 !p_stream->b_contiguous, false ),
+                              i_pagepos );
+        }
+
         DemuxDebug(
             if ( p_stream->fmt.i_cat == VIDEO_ES )
                 msg_Dbg(p_demux, "DEMUX READ pageno %ld g%"PRId64" (%d packets) cont %d %ld bytes",
@@ -2159,8 +2175,8 @@ static int Ogg_BeginningOfStream( demux_t *p_demux )
 
         p_stream->p_es = NULL;
 
-        /* initialise kframe index */
-        p_stream->idx=NULL;
+        /* initialise page index */
+        oggseek_index_entries_free( p_stream );
 
         if ( p_stream->fmt.i_bitrate == 0  &&
              ( p_stream->fmt.i_cat == VIDEO_ES ||
@@ -2265,10 +2281,7 @@ static void Ogg_LogicalStreamDelete( demux_t *p_demux, logical_stream_t *p_strea
     es_format_Clean( &p_stream->fmt_old );
     es_format_Clean( &p_stream->fmt );
 
-    if ( p_stream->idx != NULL)
-    {
-        oggseek_index_entries_free( p_stream->idx );
-    }
+    oggseek_index_entries_free( p_stream );
 
     Ogg_FreeSkeleton( p_stream->p_skel );
     p_stream->p_skel = NULL;
@@ -3113,6 +3126,7 @@ static void Ogg_ReadSkeletonBones( demux_t *p_demux, ogg_packet *p_oggpacket )
         if ( !p_skel ) return;
         TAB_INIT( p_skel->i_messages, p_skel->ppsz_messages );
         p_skel->p_index = NULL;
+        p_skel->i_index = 0;
         p_target_stream->p_skel = p_skel;
     }
 
@@ -3154,7 +3168,6 @@ unsigned const char * Read7BitsVariableLE( unsigned const char *p_begin,
         if ( (*p_begin++ & 0x80) == 0x80 ) break; /* see prev */
     }
 
-    *pi_value = GetQWLE( pi_value );
     return p_begin;
 }
 
@@ -3182,13 +3195,25 @@ static void Ogg_ReadSkeletonIndex( demux_t *p_demux, ogg_packet *p_oggpacket )
     msg_Dbg( p_demux, "%" PRIi64 " index data for %" PRIi32, i_keypoints, i_serialno );
     if ( !i_keypoints ) return;
 
-    p_stream->p_skel->i_indexstampden = GetQWLE( &p_oggpacket->packet[18] );
-    p_stream->p_skel->i_indexfirstnum = GetQWLE( &p_oggpacket->packet[24] );
-    p_stream->p_skel->i_indexlastnum = GetQWLE( &p_oggpacket->packet[32] );
+    /* Times are fractions of a second, sharing a denominator */
+    const int64_t i_den = GetQWLE( &p_oggpacket->packet[18] );
+    const int64_t i_firstnum = GetQWLE( &p_oggpacket->packet[26] );
+    const int64_t i_lastnum = GetQWLE( &p_oggpacket->packet[34] );
+    if ( i_den <= 0 || i_firstnum < 0 || i_lastnum < i_firstnum ||
+         i_lastnum > INT64_MAX / CLOCK_FREQ ||
+         i_keypoints > (uint64_t)( p_oggpacket->bytes - 42 ) / 2 )
+    {
+        msg_Warn( p_demux, "Invalid Index: bad header" );
+        return;
+    }
+
+    demux_index_entry_t *p_index = vlc_alloc( i_keypoints, sizeof( *p_index ) );
+    if ( !p_index ) return;
+
     unsigned const char *p_fwdbyte = &p_oggpacket->packet[42];
     unsigned const char *p_boundary = p_oggpacket->packet + p_oggpacket->bytes;
     uint64_t i_offset = 0;
-    uint64_t i_time = 0;
+    uint64_t i_timenum = 0;
     uint64_t i_keypoints_found = 0;
 
     while( p_fwdbyte < p_boundary && i_keypoints_found < i_keypoints )
@@ -3197,22 +3222,26 @@ static void Ogg_ReadSkeletonIndex( demux_t *p_demux, ogg_packet *p_oggpacket )
         p_fwdbyte = Read7BitsVariableLE( p_fwdbyte, p_boundary, &i_val );
         i_offset += i_val;
         p_fwdbyte = Read7BitsVariableLE( p_fwdbyte, p_boundary, &i_val );
-        i_time += i_val * p_stream->p_skel->i_indexstampden;
+        i_timenum += i_val;
+        if ( i_offset > INT64_MAX || i_timenum > (uint64_t)i_lastnum )
+            break;
+        p_index[i_keypoints_found].i_pagepos = i_offset;
+        p_index[i_keypoints_found].i_value = CLOCK_FREQ * (int64_t)i_timenum / i_den;
         i_keypoints_found++;
     }
 
     if ( i_keypoints_found != i_keypoints )
     {
         msg_Warn( p_demux, "Invalid Index: missing entries" );
+        free( p_index );
         return;
     }
 
-    p_stream->p_skel->p_index = malloc( p_oggpacket->bytes - 42 );
-    if ( !p_stream->p_skel->p_index ) return;
-    memcpy( p_stream->p_skel->p_index, &p_oggpacket->packet[42],
-            p_oggpacket->bytes - 42 );
+    free( p_stream->p_skel->p_index );
+    p_stream->p_skel->p_index = p_index;
     p_stream->p_skel->i_index = i_keypoints_found;
-    p_stream->p_skel->i_index_size = p_oggpacket->bytes - 42;
+    p_stream->p_skel->i_indexfirst = CLOCK_FREQ * i_firstnum / i_den;
+    p_stream->p_skel->i_indexlast = CLOCK_FREQ * i_lastnum / i_den;
 }
 
 static void Ogg_FreeSkeleton( ogg_skeleton_t *p_skel )
@@ -3255,43 +3284,35 @@ bool Ogg_GetBoundsUsingSkeletonIndex( logical_stream_t *p_stream, vlc_tick_t i_t
     i_time -= VLC_TICK_0;
 
     /* Validate range */
-    if ( i_time < p_stream->p_skel->i_indexfirstnum
-                * p_stream->p_skel->i_indexstampden ||
-         i_time > p_stream->p_skel->i_indexlastnum
-                * p_stream->p_skel->i_indexstampden ) return false;
+    if ( i_time < p_stream->p_skel->i_indexfirst ||
+         i_time > p_stream->p_skel->i_indexlast ) return false;
 
-    /* Then Lookup its index */
-    unsigned const char *p_fwdbyte = p_stream->p_skel->p_index;
-    struct
-    {
-        int64_t i_pos;
-        int64_t i_time;
-    } current = { 0, 0 }, prev = { -1, -1 };
+    /* Then Lookup its index, for the first keypoint at or after i_time */
+    const demux_index_entry_t *p_index = p_stream->p_skel->p_index;
+    size_t i_low = 0, i_high = p_stream->p_skel->i_index;
 
-    uint64_t i_keypoints_found = 0;
-
-    while( p_fwdbyte < p_fwdbyte + p_stream->p_skel->i_index_size
-           && i_keypoints_found < p_stream->p_skel->i_index )
+    while ( i_low < i_high )
     {
-        uint64_t i_val;
-        p_fwdbyte = Read7BitsVariableLE( p_fwdbyte,
-                        p_fwdbyte + p_stream->p_skel->i_index_size, &i_val );
-        current.i_pos += i_val;
-        p_fwdbyte = Read7BitsVariableLE( p_fwdbyte,
-                        p_fwdbyte + p_stream->p_skel->i_index_size, &i_val );
-        current.i_time += i_val * p_stream->p_skel->i_indexstampden;
-        if ( current.i_pos < 0 || current.i_time < 0 ) break;
+        size_t i_mid = i_low + ( i_high - i_low ) / 2;
+        if ( p_index[i_mid].i_value < i_time )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
 
-        i_keypoints_found++;
+    if ( i_low == p_stream->p_skel->i_index ) /* after the last keypoint */
+    {
+        *pi_lower = p_index[i_low - 1].i_pagepos;
+        return false;
+    }
 
-        if ( i_time <= current.i_time )
-        {
-            *pi_lower = prev.i_pos;
-            *pi_upper = current.i_pos;
-            return ( i_time == current.i_time );
-        }
-        prev = current;
+    *pi_upper = p_index[i_low].i_pagepos;
+    if ( p_index[i_low].i_value == i_time )
+    {
+        *pi_lower = p_index[i_low].i_pagepos;
+        return true;
     }
+    *pi_lower = i_low > 0 ? p_index[i_low - 1].i_pagepos : -1;
     return false;
 }
 
@@ -91,8 +91,13 @@ typedef struct logical_stream_s
     /* offset of first keyframe for theora; can be 0 or 1 depending on version number */
     int8_t i_keyframe_offset;
 
-    /* keyframe index for seeking, created as we discover keyframes */
-    demux_index_entry_t *idx;
+    /* page index for seeking, created as we read pages */
+    struct
+    {
+        demux_index_entry_t *p_entries;
+        size_t i_count;
+        size_t i_size;
+    } idx;
 
     /* Skeleton data */
     ogg_skeleton_t *p_skel;
@@ -151,12 +156,10 @@ struct ogg_skeleton_t
 {
     int            i_messages;
     char         **ppsz_messages;
-    unsigned char *p_index;
-    uint64_t       i_index;
-    uint64_t       i_index_size;
-    int64_t        i_indexstampden;/* time denominator */
-    int64_t        i_indexfirstnum;/* first sample time numerator */
-    int64_t        i_indexlastnum;
+    demux_index_entry_t *p_index; /* keypoints */
+    size_t         i_index;
+    vlc_tick_t     i_indexfirst; /* first sample time */
+    vlc_tick_t     i_indexlast;  /* last sample time */
 };
 
 typedef struct
@@ -60,115 +60,106 @@ typedef struct packetStartCoordinates
 * index entries
 *************************************************************/
 
-/* free all entries in index list */
+/* Minimum time between two entries */
+#define OGGSEEK_INDEX_INTERVAL VLC_TICK_FROM_SEC(1)
+#define OGGSEEK_INDEX_MAX_ENTRIES (1 << 20)
 
-void oggseek_index_entries_free ( demux_index_entry_t *idx )
-{
-    demux_index_entry_t *idx_next;
+/* Farthest entry from the target time to resume from it without searching,
+ * when any page is a valid starting point */
+#define OGGSEEK_INDEX_MAX_DISTANCE VLC_TICK_FROM_SEC(2)
 
-    while ( idx != NULL )
-    {
-        idx_next = idx->p_next;
-        free( idx );
-        idx = idx_next;
-    }
-}
+/* free all entries in index */
 
-
-/* internal function to create a new list member */
-
-static demux_index_entry_t *index_entry_new( void )
+void oggseek_index_entries_free ( logical_stream_t *p_stream )
 {
-    demux_index_entry_t *idx = xmalloc( sizeof( demux_index_entry_t ) );
-    if ( !idx ) return NULL;
-    idx->p_next = idx->p_prev = NULL;
-    idx->i_pagepos_end = -1;
-    return idx;
+    free( p_stream->idx.p_entries );
+    p_stream->idx.p_entries = NULL;
+    p_stream->idx.i_count = p_stream->idx.i_size = 0;
 }
 
-/* We insert into index, sorting by pagepos (as a page can match multiple
-   time stamps) */
-const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
-                                             vlc_tick_t i_timestamp,
-                                             int64_t i_pagepos )
+/* index of the first entry after i_timestamp */
+static size_t OggSeekIndexUpperBound( const logical_stream_t *p_stream,
+                                      vlc_tick_t i_timestamp )
 {
-    demux_index_entry_t *idx;
-    demux_index_entry_t *last_idx = NULL;
-
-    if ( p_stream == NULL ) return NULL;
+    const demux_index_entry_t *p_entries = p_stream->idx.p_entries;
+    size_t i_low = 0, i_high = p_stream->idx.i_count;
 
-    idx = p_stream->idx;
-
-    if ( i_timestamp == VLC_TICK_INVALID || i_pagepos < 1 ) return NULL;
-
-    if ( idx == NULL )
+    while ( i_low < i_high )
     {
-        demux_index_entry_t *ie = index_entry_new();
-        if ( !ie ) return NULL;
-        ie->i_value = i_timestamp;
-        ie->i_pagepos = i_pagepos;
-        p_stream->idx = ie;
-        return ie;
+        size_t i_mid = i_low + ( i_high - i_low ) / 2;
+        if ( p_entries[i_mid].i_value <= i_timestamp )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
     }
+    return i_low;
+}
 
-    while ( idx != NULL )
-    {
-        if ( idx->i_pagepos > i_pagepos ) break;
-        last_idx = idx;
-        idx = idx->p_next;
-    }
+/* We insert into index, keeping it sorted by both time and pagepos. Entries
+   too close to their neighbours, or out of order with them (as after a chain
+   or a granule discontinuity), are ignored */
+void OggSeek_IndexAdd ( logical_stream_t *p_stream,
+                        vlc_tick_t i_timestamp,
+                        int64_t i_pagepos )
+{
+    if ( p_stream == NULL || i_timestamp == VLC_TICK_INVALID || i_pagepos < 1 )
+        return;
 
-    /* new entry; insert after last_idx */
-    idx = index_entry_new();
-    if ( !idx ) return NULL;
-    if ( last_idx != NULL )
-    {
-        idx->p_next = last_idx->p_next;
-        last_idx->p_next = idx;
-        idx->p_prev = last_idx;
-    }
-    else
-    {
-        idx->p_next = p_stream->idx;
-        p_stream->idx = idx;
-    }
+    demux_index_entry_t *p_entries = p_stream->idx.p_entries;
+    size_t i_count = p_stream->idx.i_count;
+    size_t i = OggSeekIndexUpperBound( p_stream, i_timestamp );
 
-    if ( idx->p_next != NULL )
+    if ( i > 0 && ( i_timestamp - p_entries[i - 1].i_value < OGGSEEK_INDEX_INTERVAL ||
+                    i_pagepos <= p_entries[i - 1].i_pagepos ) )
+        return;
+    if ( i < i_count && ( p_entries[i].i_value - i_timestamp < OGGSEEK_INDEX_INTERVAL ||
+                          i_pagepos >= p_entries[i].i_pagepos ) )
+        return;
+
+    if ( i_count == p_stream->idx.i_size )
     {
-        idx->p_next->p_prev = idx;
+        if ( i_count >= OGGSEEK_INDEX_MAX_ENTRIES )
+            return;
+        size_t i_size = i_count ? i_count * 2 : 64;
+        p_entries = realloc( p_entries, i_size * sizeof( *p_entries ) );
+        if ( !p_entries )
+            return;
+        p_stream->idx.p_entries = p_entries;
+        p_stream->idx.i_size = i_size;
     }
 
-    idx->i_value = i_timestamp;
-    idx->i_pagepos = i_pagepos;
-
-    return idx;
+    memmove( &p_entries[i + 1], &p_entries[i], ( i_count - i ) * sizeof( *p_entries ) );
+    p_entries[i].i_value = i_timestamp;
+    p_entries[i].i_pagepos = i_pagepos;
+    p_stream->idx.i_count++;
 }
 
+/* Finds the pages around i_timestamp. Upper bound is left untouched if the
+   lower one is the last entry */
 static bool OggSeekIndexFind ( logical_stream_t *p_stream, vlc_tick_t i_timestamp,
-                               int64_t *pi_pos_lower, int64_t *pi_pos_upper )
+                               int64_t *pi_pos_lower, int64_t *pi_pos_upper,
+                               vlc_tick_t *pi_time_lower )
 {
-    demux_index_entry_t *idx = p_stream->idx;
+    const demux_index_entry_t *p_entries = p_stream->idx.p_entries;
+    size_t i = OggSeekIndexUpperBound( p_stream, i_timestamp );
 
-    while ( idx != NULL )
-    {
-        if ( idx->i_value <= i_timestamp )
-        {
-            if ( !idx->p_next ) /* found on last index */
-            {
-                *pi_pos_lower = idx->i_pagepos;
-                return true;
-            }
-            if ( idx->p_next->i_value > i_timestamp )
-            {
-                *pi_pos_lower = idx->i_pagepos;
-                *pi_pos_upper = idx->p_next->i_pagepos;
-                return true;
-            }
-        }
-        idx = idx->p_next;
-    }
+    if ( i == 0 )
+        return false;
 
-    return false;
+    *pi_pos_lower = p_entries[i - 1].i_pagepos;
+    *pi_time_lower = p_entries[i - 1].i_value;
+    if ( i < p_stream->idx.i_count )
+        *pi_pos_upper = p_entries[i].i_pagepos;
+    return true;
+}
+
+/* Whether decoding can start at any page, as each packet is a keyframe.
+ * Only audio qualifies: video codecs such as VP8 keep the granule as is but
+ * still have inter frames */
+static bool OggSeekAnyPageIsKeyframe( const logical_stream_t *p_stream )
+{
+    return !p_stream->b_oggds && p_stream->fmt.i_cat == AUDIO_ES &&
+           Ogg_GetKeyframeGranule( p_stream, 0xFF00FF00 ) == 0xFF00FF00;
 }
 
 /*********************************************************************
@@ -686,7 +677,13 @@ static int64_t OggBisectSearchByTime( demux_t *p_demux, logical_stream_t *p_stre
             msg_Err( p_demux, "Unmatched granule. New codec ?" );
             return -1;
         }
-        else if ( current.i_timestamp < 0 )  /* due to preskip with some codecs */
+        else if ( current.i_pos != -1 && current.i_granule != -1 )
+        {
+            /* remember the probe for the next seeks */
+            OggSeek_IndexAdd( p_stream, current.i_timestamp, current.i_pos );
+        }
+
+        if ( current.i_timestamp < 0 )  /* due to preskip with some codecs */
         {
             current.i_timestamp = 0;
         }
@@ -777,21 +774,30 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
     demux_sys_t *p_sys  = p_demux->p_sys;
     int64_t i_lowerpos = -1;
     int64_t i_upperpos = -1;
+    vlc_tick_t i_lowertime;
     bool b_found = false;
 
-    /* Search in skeleton */
+    /* Search in skeleton, which gives the keyframe before */
     Ogg_GetBoundsUsingSkeletonIndex( p_stream, i_time, &i_lowerpos, &i_upperpos );
     if ( i_lowerpos != -1 ) b_found = true;
 
-    /* And also search in our own index */
-    if ( !b_found && OggSeekIndexFind( p_stream, i_time, &i_lowerpos, &i_upperpos ) )
+    /* And also search in our own index, for a page just before */
+    int64_t i_searchlower = p_stream->i_data_start;
+    int64_t i_searchupper = p_sys->i_total_length;
+    if ( !b_found && OggSeekIndexFind( p_stream, i_time, &i_searchlower,
+                                       &i_searchupper, &i_lowertime ) )
     {
-        b_found = true;
+        if ( OggSeekAnyPageIsKeyframe( p_stream ) &&
+             i_time - i_lowertime <= OGGSEEK_INDEX_MAX_DISTANCE )
+        {
+            i_lowerpos = i_searchlower;
+            b_found = true;
+        }
     }
 
     /* Or try to be smart with audio fixed bitrate streams */
     if ( !b_found && p_stream->fmt.i_cat == AUDIO_ES && p_sys->i_streams == 1
-         && p_sys->i_bitrate && Ogg_GetKeyframeGranule( p_stream, 0xFF00FF00 ) == 0xFF00FF00 )
+         && p_sys->i_bitrate && OggSeekAnyPageIsKeyframe( p_stream ) )
     {
         /* But only if there's no keyframe/preload requirements */
         /* FIXME: add function to get preload time by codec, ex: opus */
@@ -799,11 +805,11 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
         b_found = true;
     }
 
-    /* or search */
+    /* or search, within the indexed pages around */
     if ( !b_found && b_fastseek )
     {
         i_lowerpos = OggBisectSearchByTime( p_demux, p_stream, i_time,
-                                            p_stream->i_data_start, p_sys->i_total_length );
+                                            i_searchlower, i_searchupper );
         b_found = ( i_lowerpos != -1 );
     }
 
@@ -843,6 +849,10 @@ int Oggseek_BlindSeektoPosition( demux_t *p_demux, logical_stream_t *p_stream,
 
     OggDebug( msg_Dbg( p_demux, "Seek start pos is %"PRId64" granule %"PRId64, i_size, i_granule ) );
 
+    OggSeek_IndexAdd( p_stream, Ogg_GranuleToTime( p_stream, i_granule,
+                                                   !p_stream->b_contiguous, false ),
+                      i_size );
+
     i_granule = Ogg_GetKeyframeGranule( p_stream, i_granule );
 
     if ( b_canfastseek )
@@ -876,9 +886,14 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
     int64_t i_offset_lower = -1;
     int64_t i_offset_upper = -1;
 
-    if ( Ogg_GetBoundsUsingSkeletonIndex( p_stream, i_time, &i_offset_lower, &i_offset_upper ) )
+    vlc_tick_t i_time_lower;
+    int64_t i_pagepos;
+
+    /* The keypoints of the skeleton are keyframes: decoding can start from the
+     * one before */
+    if ( Ogg_GetBoundsUsingSkeletonIndex( p_stream, i_time, &i_offset_lower, &i_offset_upper )
+         || i_offset_lower != -1 )
     {
-        /* Exact match */
         OggDebug( msg_Dbg( p_demux, "Found keyframe at %"PRId64" using skeleton index", i_offset_lower ) );
         if ( i_offset_lower == -1 ) i_offset_lower = p_stream->i_data_start;
         p_sys->i_input_position = i_offset_lower;
@@ -886,17 +901,28 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
         ogg_stream_reset( &p_stream->os );
         return i_offset_lower;
     }
-    OggDebug( msg_Dbg( p_demux, "Search bounds set to %"PRId64" %"PRId64" using skeleton index", i_offset_lower, i_offset_upper ) );
 
-    OggNoDebug(
-        OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper )
-    );
+    i_offset_lower = p_stream->i_data_start;
+    i_offset_upper = p_sys->i_total_length;
+    if ( OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper,
+                           &i_time_lower ) &&
+         OggSeekAnyPageIsKeyframe( p_stream ) &&
+         i_time - i_time_lower <= OGGSEEK_INDEX_MAX_DISTANCE )
+    {
+        /* Already read page, close enough */
+        OggDebug( msg_Dbg( p_demux, "Found page at %"PRId64" using own index", i_offset_lower ) );
+        i_pagepos = i_offset_lower;
+    }
+    else
+    {
+        OggDebug( msg_Dbg( p_demux, "Search bounds set to %"PRId64" %"PRId64" using own index", i_offset_lower, i_offset_upper ) );
 
-    i_offset_lower = __MAX( i_offset_lower, p_stream->i_data_start );
-    i_offset_upper = __MIN( i_offset_upper, p_sys->i_total_length );
+        i_offset_lower = __MAX( i_offset_lower, p_stream->i_data_start );
+        i_offset_upper = __MIN( i_offset_upper, p_sys->i_total_length );
 
-    int64_t i_pagepos = OggBisectSearchByTime( p_demux, p_stream, i_time,
-                                       i_offset_lower, i_offset_upper);
+        i_pagepos = OggBisectSearchByTime( p_demux, p_stream, i_time,
+                                           i_offset_lower, i_offset_upper);
+    }
     if ( i_pagepos >= 0 )
     {
         /* be sure to clear any state or read+pagein() will fail on same # */
@@ -904,11 +930,6 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
         p_sys->i_input_position = i_pagepos;
         seek_byte( p_demux, p_sys->i_input_position );
     }
-    /* Insert keyframe position into index */
-    OggNoDebug(
-    if ( i_pagepos >= p_stream->i_data_start )
-        OggSeek_IndexAdd( p_stream, i_time, i_pagepos )
-    );
 
     OggDebug( msg_Dbg( p_demux, "=================== Seeked To %"PRId64" time %"PRId64, i_pagepos, i_time ) );
     return i_pagepos;
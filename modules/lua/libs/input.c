@@ -215,6 +215,7 @@ static int vlclua_input_item_stats( lua_State *L )
         STATS_INT( lost_pictures )
         STATS_INT( played_abuffers )
         STATS_INT( lost_abuffers )
+        STATS_INT( audio_underruns )
 #undef STATS_INT
 #undef STATS_FLOAT
     }
@@ -74,6 +74,9 @@ typedef struct
     /* */
     packetizer_t packetizer;
 
+    /* Only parse what framing and timestamping need */
+    bool    b_lazy;
+
     /* */
     bool    b_slice;
     struct
@@ -192,6 +195,10 @@ static void ActivateSets( decoder_t *p_dec, const h264_sequence_parameter_set_t
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
 
+    /* Replaced sets are deactivated when stored */
+    if( p_sps == p_sys->p_active_sps && p_pps == p_sys->p_active_pps )
+        return;
+
     p_sys->p_active_pps = p_pps;
     p_sys->p_active_sps = p_sps;
 
@@ -290,6 +297,39 @@ static bool IsFirstVCLNALUnit( const h264_slice_t *p_prev, const h264_slice_t *p
     return false;
 }
 
+/* Whether the slice starts a picture, which the lazy mode knows without
+ * comparing the slice headers. The other slices are still compared, as the
+ * first slice of the picture may have been lost. */
+static bool IsFirstSliceOfPicture( const decoder_sys_t *p_sys, const block_t *p_frag )
+{
+    if( !p_sys->b_lazy || !p_sys->p_active_sps || p_frag->i_buffer < 6 )
+        return false;
+
+    /* Arbitrary slice order */
+    if( p_sys->p_active_sps->i_profile == PROFILE_H264_BASELINE ||
+        p_sys->p_active_sps->i_profile == PROFILE_H264_EXTENDED )
+        return false;
+
+    /* first_mb_in_slice is zero, the first ue() bit is set */
+    return p_frag->p_buffer[5] & 0x80;
+}
+
+/* SEI timings, recovery points and frame packing are still needed in lazy
+ * mode, not the captions */
+static bool NeedSEI( const decoder_sys_t *p_sys, const h264_slice_t *p_slice )
+{
+    return !p_sys->b_lazy || !p_sys->b_recovered ||
+           p_slice->type == H264_SLICE_TYPE_I ||
+           ( p_sys->p_active_sps &&
+             p_sys->p_active_sps->vui.b_pic_struct_present_flag );
+}
+
+static bool IsStoredNAL( const block_t *p_stored, const block_t *p_frag )
+{
+    return p_stored && p_stored->i_buffer == p_frag->i_buffer &&
+           !memcmp( p_stored->p_buffer, p_frag->p_buffer, p_frag->i_buffer );
+}
+
 static void DropStoredNAL( decoder_sys_t *p_sys )
 {
     block_ChainRelease( p_sys->frame.p_head );
@@ -336,6 +376,7 @@ static int Open( vlc_object_t *p_this )
                      p_h264_startcode, 1, 5,
                      PacketizeReset, PacketizeParse, PacketizeValidate, p_dec );
 
+    p_sys->b_lazy = var_GetBool( p_dec, "packetizer-lazy" );
     p_sys->b_slice = false;
     p_sys->frame.p_head = NULL;
     p_sys->frame.pp_append = &p_sys->frame.p_head;
@@ -623,11 +664,13 @@ static block_t *ParseNALBlock( decoder_t *p_dec, bool *pb_ts_used, block_t *p_fr
                 if( newslice.i_idr_pic_id == -1 )
                     newslice.i_idr_pic_id = p_sys->slice.i_idr_pic_id;
 
-                bool b_new_picture = IsFirstVCLNALUnit( &p_sys->slice, &newslice );
+                bool b_new_picture = IsFirstSliceOfPicture( p_sys, p_frag ) ||
+                                     IsFirstVCLNALUnit( &p_sys->slice, &newslice );
                 if( b_new_picture )
                 {
                     /* Parse SEI for that frame now we should have matched SPS/PPS */
-                    for( block_t *p_sei = p_sys->leading.p_head; p_sei; p_sei = p_sei->p_next )
+                    for( block_t *p_sei = NeedSEI( p_sys, &newslice ) ? p_sys->leading.p_head : NULL;
+                         p_sei; p_sei = p_sei->p_next )
                     {
                         if( (p_sei->i_flags & BLOCK_FLAG_PRIVATE_SEI) == 0 )
                             continue;
@@ -1045,6 +1088,16 @@ static void PutSPS( decoder_t *p_dec, block_t *p_frag )
     const uint8_t *p_buffer = p_frag->p_buffer;
     size_t i_buffer = p_frag->i_buffer;
 
+    /* Repeated SPS are not decoded again */
+    for( size_t i = 0; i <= H264_SPS_ID_MAX; i++ )
+    {
+        if( IsStoredNAL( p_sys->sps[i].p_block, p_frag ) )
+        {
+            block_Release( p_frag );
+            return;
+        }
+    }
+
     if( !hxxx_strip_AnnexB_startcode( &p_buffer, &i_buffer ) )
     {
         block_Release( p_frag );
@@ -1072,6 +1125,16 @@ static void PutPPS( decoder_t *p_dec, block_t *p_frag )
     const uint8_t *p_buffer = p_frag->p_buffer;
     size_t i_buffer = p_frag->i_buffer;
 
+    /* Repeated PPS are not decoded again */
+    for( size_t i = 0; i <= H264_PPS_ID_MAX; i++ )
+    {
+        if( IsStoredNAL( p_sys->pps[i].p_block, p_frag ) )
+        {
+            block_Release( p_frag );
+            return;
+        }
+    }
+
     if( !hxxx_strip_AnnexB_startcode( &p_buffer, &i_buffer ) )
     {
         block_Release( p_frag );
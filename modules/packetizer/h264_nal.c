@@ -613,16 +613,23 @@ static bool h264_parse_picture_parameter_set_rbsp( bs_t *p_bs,
     h264type * name( const uint8_t *p_buf, size_t i_buf, bool b_escaped ) \
     { \
         h264type *p_h264type = calloc(1, sizeof(h264type)); \
-        if(likely(p_h264type)) \
+        uint8_t *p_rbsp = NULL; \
+        if( b_escaped && likely(p_h264type) ) \
         { \
-            bs_t bs; \
-            struct hxxx_bsfw_ep3b_ctx_s bsctx; \
-            if( b_escaped ) \
+            /* Unescape at once, rather than on every bitstream read */ \
+            p_rbsp = malloc( i_buf ); \
+            if( unlikely(!p_rbsp) ) \
             { \
-                hxxx_bsfw_ep3b_ctx_init( &bsctx ); \
-                bs_init_custom( &bs, p_buf, i_buf, &hxxx_bsfw_ep3b_callbacks, &bsctx );\
+                free( p_h264type ); \
+                return NULL; \
             } \
-            else bs_init( &bs, p_buf, i_buf ); \
+            i_buf = hxxx_ep3b_unescape( p_rbsp, p_buf, i_buf ); \
+            p_buf = p_rbsp; \
+        } \
+        if(likely(p_h264type)) \
+        { \
+            bs_t bs; \
+            bs_init( &bs, p_buf, i_buf ); \
             bs_skip( &bs, 8 ); /* Skip nal_unit_header */ \
             if( !decode( &bs, p_h264type ) ) \
             { \
@@ -630,6 +637,7 @@ static bool h264_parse_picture_parameter_set_rbsp( bs_t *p_bs,
                 p_h264type = NULL; \
             } \
         } \
+        free( p_rbsp ); \
         return p_h264type; \
     }
 
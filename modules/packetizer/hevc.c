@@ -78,6 +78,9 @@ typedef struct
     /* */
     packetizer_t packetizer;
 
+    /* Only parse what framing and timestamping need */
+    bool b_lazy;
+
     struct
     {
         block_t *p_chain;
@@ -176,6 +179,8 @@ static int Open(vlc_object_t *p_this)
     if (!p_dec->p_sys)
         return VLC_ENOMEM;
 
+    p_sys->b_lazy = var_GetBool(p_dec, "packetizer-lazy");
+
     p_sys->p_ccs = cc_storage_new();
     if(unlikely(!p_sys->p_ccs))
     {
@@ -539,6 +544,12 @@ static void ActivateSets(decoder_t *p_dec,
                          const hevc_video_parameter_set_t *p_vps)
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
+
+    /* Replaced sets are deactivated when stored */
+    if(p_pps == p_sys->p_active_pps && p_sps == p_sys->p_active_sps &&
+       p_vps == p_sys->p_active_vps)
+        return;
+
     p_sys->p_active_pps = p_pps;
     p_sys->p_active_sps = p_sps;
     p_sys->p_active_vps = p_vps;
@@ -609,6 +620,15 @@ static void GetXPSSet(uint8_t i_pps_id, void *priv,
             *pp_vps = p_sys->rg_vps[hevc_get_sps_vps_id(*pp_sps)].p_decoded;
 }
 
+/* SEI timings and metadata are still needed in lazy mode, not the
+ * captions */
+static bool NeedSEI( const decoder_sys_t *p_sys, bool b_irap )
+{
+    return !p_sys->b_lazy || !p_sys->b_init_sequence_complete || b_irap ||
+           ( p_sys->p_active_sps &&
+             hevc_sps_needs_pic_timing( p_sys->p_active_sps ) );
+}
+
 static void ParseStoredSEI( decoder_t *p_dec )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
@@ -662,7 +682,9 @@ static block_t *ParseVCL(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_frag)
             ActivateSets(p_dec, p_pps, p_sps, p_vps);
         }
 
-        ParseStoredSEI( p_dec );
+        if( NeedSEI( p_sys, i_nal_type >= HEVC_NAL_BLA_W_LP &&
+                            i_nal_type <= HEVC_NAL_IRAP_VCL23 ) )
+            ParseStoredSEI( p_dec );
 
         switch(i_nal_type)
         {
@@ -767,8 +789,10 @@ static block_t * ParseAUTail(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_na
             break;
 
         case HEVC_NAL_SUFF_SEI:
-            HxxxParse_AnnexB_SEI( p_nalb->p_buffer, p_nalb->i_buffer,
-                                  2 /* nal header */, ParseSEICallback, p_dec );
+            if( NeedSEI( p_sys, p_sys->frame.p_chain &&
+                                (p_sys->frame.p_chain->i_flags & BLOCK_FLAG_TYPE_I) ) )
+                HxxxParse_AnnexB_SEI( p_nalb->p_buffer, p_nalb->i_buffer,
+                                      2 /* nal header */, ParseSEICallback, p_dec );
             break;
     }
 
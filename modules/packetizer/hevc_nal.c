@@ -698,16 +698,23 @@ void hevc_rbsp_release_vps( hevc_video_parameter_set_t *p_vps )
     hevctype * name( const uint8_t *p_buf, size_t i_buf, bool b_escaped ) \
     { \
         hevctype *p_hevctype = calloc(1, sizeof(hevctype)); \
-        if(likely(p_hevctype)) \
+        uint8_t *p_rbsp = NULL; \
+        if( b_escaped && likely(p_hevctype) ) \
         { \
-            bs_t bs; \
-            struct hxxx_bsfw_ep3b_ctx_s bsctx; \
-            if( b_escaped ) \
+            /* Unescape at once, rather than on every bitstream read */ \
+            p_rbsp = malloc( i_buf ); \
+            if( unlikely(!p_rbsp) ) \
             { \
-                hxxx_bsfw_ep3b_ctx_init( &bsctx ); \
-                bs_init_custom( &bs, p_buf, i_buf, &hxxx_bsfw_ep3b_callbacks, &bsctx );\
+                free( p_hevctype ); \
+                return NULL; \
             } \
-            else bs_init( &bs, p_buf, i_buf ); \
+            i_buf = hxxx_ep3b_unescape( p_rbsp, p_buf, i_buf ); \
+            p_buf = p_rbsp; \
+        } \
+        if(likely(p_hevctype)) \
+        { \
+            bs_t bs; \
+            bs_init( &bs, p_buf, i_buf ); \
             bs_skip( &bs, 7 ); /* nal_unit_header */ \
             uint8_t i_nuh_layer_id = bs_read( &bs, 6 ); \
             bs_skip( &bs, 3 ); /* !nal_unit_header */ \
@@ -717,6 +724,7 @@ void hevc_rbsp_release_vps( hevc_video_parameter_set_t *p_vps )
                 p_hevctype = NULL; \
             } \
         } \
+        free( p_rbsp ); \
         return p_hevctype; \
     }
 
@@ -1641,6 +1649,12 @@ bool hevc_frame_is_progressive( const hevc_sequence_parameter_set_t *p_sps,
     return true;
 }
 
+bool hevc_sps_needs_pic_timing( const hevc_sequence_parameter_set_t *p_sps )
+{
+    return p_sps->vui_parameters_present_flag &&
+           p_sps->vui.frame_field_info_present_flag;
+}
+
 uint8_t hevc_get_num_clock_ts( const hevc_sequence_parameter_set_t *p_sps,
                                const hevc_sei_pic_timing_t *p_timing )
 {
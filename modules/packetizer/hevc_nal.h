@@ -278,5 +278,7 @@ uint8_t hevc_get_num_clock_ts( const hevc_sequence_parameter_set_t *,
                                const hevc_sei_pic_timing_t * /* can be NULL */ );
 bool hevc_frame_is_progressive( const hevc_sequence_parameter_set_t *,
                                 const hevc_sei_pic_timing_t * /* can be NULL */);
+/* Whether the pictures timings depend on the pic timing SEI */
+bool hevc_sps_needs_pic_timing( const hevc_sequence_parameter_set_t * );
 
 #endif /* HEVC_NAL_H */
@@ -19,6 +19,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 #include <vlc_bits.h>
+#include "startcode_helper.h"
 
 static inline uint8_t *hxxx_ep3b_to_rbsp( uint8_t *p, uint8_t *end, unsigned *pi_prev, size_t i_count )
 {
@@ -34,37 +35,40 @@ static inline uint8_t *hxxx_ep3b_to_rbsp( uint8_t *p, uint8_t *end, unsigned *pi
         {
             if( (*pi_prev & 0x06) == 0x06 )
             {
+                /* The escaped zeros can't start another sequence */
                 ++p;
-                *pi_prev = ((*pi_prev >> 1) << 1) | (!*p);
+                *pi_prev = !*p;
             }
         }
     }
     return p;
 }
 
-#if 0
-/* Discards emulation prevention three bytes */
-static inline uint8_t * hxxx_ep3b_to_rbsp(const uint8_t *p_src, size_t i_src, size_t *pi_ret)
+/* Returns the first emulation prevention three byte, or NULL */
+static inline const uint8_t * hxxx_ep3b_find( const uint8_t *p, const uint8_t *end )
 {
-    uint8_t *p_dst;
-    if(!p_src || !(p_dst = malloc(i_src)))
+    /* Never escape sequence if no next byte */
+    if( end - p < 4 )
         return NULL;
+    p = startcode_FindSequence( p, end - 1, 0x03 );
+    return p ? p + 2 : NULL;
+}
 
-    size_t j = 0;
-    for (size_t i = 0; i < i_src; i++) {
-        if (i < i_src - 3 &&
-            p_src[i] == 0 && p_src[i+1] == 0 && p_src[i+2] == 3) {
-            p_dst[j++] = 0;
-            p_dst[j++] = 0;
-            i += 2;
-            continue;
-        }
-        p_dst[j++] = p_src[i];
+/* Discards emulation prevention three bytes, copying the data between them
+ * at once. dst can be src. Returns the unescaped size. */
+static inline size_t hxxx_ep3b_unescape( uint8_t *dst, const uint8_t *src, size_t i_src )
+{
+    const uint8_t *end = src + i_src;
+    uint8_t *p_dst = dst;
+
+    for( const uint8_t *ep; (ep = hxxx_ep3b_find( src, end )) != NULL; src = ep + 1 )
+    {
+        memmove( p_dst, src, ep - src );
+        p_dst += ep - src;
     }
-    *pi_ret = j;
-    return p_dst;
+    memmove( p_dst, src, end - src );
+    return p_dst + (end - src) - dst;
 }
-#endif
 
 /* vlc_bits's bs_t forward callback for stripping emulation prevention three bytes */
 struct hxxx_bsfw_ep3b_ctx_s
@@ -84,14 +88,11 @@ static void hxxx_bsfw_ep3b_ctx_init( struct hxxx_bsfw_ep3b_ctx_s *ctx )
 static size_t hxxx_ep3b_total_size( const uint8_t *p, const uint8_t *p_end )
 {
     /* compute final size */
-    unsigned i_prev = 0;
-    size_t i = 0;
-    while( p < p_end )
+    size_t i = p_end - p;
+    while( (p = hxxx_ep3b_find( p, p_end )) != NULL )
     {
-        uint8_t *n = hxxx_ep3b_to_rbsp( (uint8_t *)p, (uint8_t *)p_end, &i_prev, 1 );
-        if( n > p )
-            ++i;
-        p = n;
+        --i;
+        ++p;
     }
     return i;
 }
@@ -101,8 +102,9 @@ static size_t hxxx_bsfw_byte_forward_ep3b( bs_t *s, size_t i_count )
     struct hxxx_bsfw_ep3b_ctx_s *ctx = (struct hxxx_bsfw_ep3b_ctx_s *) s->p_priv;
     if( s->p == NULL )
     {
-        ctx->i_bytesize = hxxx_ep3b_total_size( s->p_start, s->p_end );
+        /* The size is only computed if ever requested */
         s->p = s->p_start;
+        ctx->i_prev = s->p < s->p_end && !*s->p;
         ctx->i_bytepos = 1;
         return 1;
     }
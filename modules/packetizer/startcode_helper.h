@@ -22,8 +22,11 @@
 
 #include <vlc_cpu.h>
 
-#if !defined(CAN_COMPILE_SSE2) && defined(HAVE_SSE2_INTRINSICS)
-   #include <emmintrin.h>
+#if defined(HAVE_SSE2_INTRINSICS)
+   #include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+   #include <arm_neon.h>
+   #define HAVE_NEON_INTRINSICS 1
 #endif
 
 /* Looks up efficiently for an AnnexB startcode 0x00 0x00 0x01
@@ -57,7 +60,7 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
             return p;
     }
 
-    if( p == end )
+    if( p > end )
         return NULL;
 
     alignedend = end - ((intptr_t) end & 15);
@@ -140,14 +143,130 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
+/* Looks up for a 0x00 0x00 xx sequence: any of the three bytes rules out
+ * some of the next positions. */
+static inline const uint8_t * startcode_FindSequence_C( const uint8_t *p, const uint8_t *end,
+                                                        uint8_t xx )
+{
+    while (end - p >= 3) {
+        if (p[2] != xx && p[2] != 0)
+            p += 3;
+        else if (p[1] != 0)
+            p += 2;
+        else if (p[0] != 0 || p[2] != xx)
+            p++;
+        else
+            return p;
+    }
+    return NULL;
+}
+
+/* The SIMD versions compare a vector of first bytes, a vector of second
+ * bytes and a vector of third bytes at once, using unaligned loads. */
+#ifdef HAVE_SSE2_INTRINSICS
+__attribute__ ((__target__ ("sse2")))
+static inline const uint8_t * startcode_FindSequence_SSE2( const uint8_t *p, const uint8_t *end,
+                                                           uint8_t xx )
+{
+    const __m128i zeros = _mm_setzero_si128();
+    const __m128i last = _mm_set1_epi8( xx );
+
+    for( ; end - p >= 16 + 2; p += 16 )
+    {
+        __m128i a = _mm_loadu_si128( (const __m128i *)p );
+        __m128i b = _mm_loadu_si128( (const __m128i *)(p + 1) );
+        __m128i c = _mm_loadu_si128( (const __m128i *)(p + 2) );
+        __m128i m = _mm_and_si128( _mm_and_si128( _mm_cmpeq_epi8( a, zeros ),
+                                                  _mm_cmpeq_epi8( b, zeros ) ),
+                                   _mm_cmpeq_epi8( c, last ) );
+        unsigned match = _mm_movemask_epi8( m );
+        if( match )
+            return p + ctz( match );
+    }
+    return startcode_FindSequence_C( p, end, xx );
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindSequence_AVX2( const uint8_t *p, const uint8_t *end,
+                                                           uint8_t xx )
+{
+    const __m256i zeros = _mm256_setzero_si256();
+    const __m256i last = _mm256_set1_epi8( xx );
+
+    for( ; end - p >= 32 + 2; p += 32 )
+    {
+        __m256i a = _mm256_loadu_si256( (const __m256i *)p );
+        __m256i b = _mm256_loadu_si256( (const __m256i *)(p + 1) );
+        __m256i c = _mm256_loadu_si256( (const __m256i *)(p + 2) );
+        __m256i m = _mm256_and_si256( _mm256_and_si256( _mm256_cmpeq_epi8( a, zeros ),
+                                                        _mm256_cmpeq_epi8( b, zeros ) ),
+                                      _mm256_cmpeq_epi8( c, last ) );
+        unsigned match = _mm256_movemask_epi8( m );
+        if( match )
+            return p + ctz( match );
+    }
+    return startcode_FindSequence_SSE2( p, end, xx );
+}
+#endif
+#endif
+
+#ifdef HAVE_NEON_INTRINSICS
+static inline const uint8_t * startcode_FindSequence_NEON( const uint8_t *p, const uint8_t *end,
+                                                           uint8_t xx )
+{
+    const uint8x16_t zeros = vdupq_n_u8( 0 );
+    const uint8x16_t last = vdupq_n_u8( xx );
+
+    for( ; end - p >= 16 + 2; p += 16 )
+    {
+        uint8x16_t m = vandq_u8( vandq_u8( vceqq_u8( vld1q_u8( p ), zeros ),
+                                           vceqq_u8( vld1q_u8( p + 1 ), zeros ) ),
+                                 vceqq_u8( vld1q_u8( p + 2 ), last ) );
+        /* There is no movemask: fold the vector to test for any match, then
+         * locate it in the 16 bytes */
+        uint8x8_t any = vorr_u8( vget_low_u8( m ), vget_high_u8( m ) );
+        if( vget_lane_u64( vreinterpret_u64_u8( any ), 0 ) )
+            return startcode_FindSequence_C( p, p + 16 + 2, xx );
+    }
+    return startcode_FindSequence_C( p, end, xx );
+}
+#endif
+
+/* Looks up for the first 0x00 0x00 xx sequence */
+static inline const uint8_t * startcode_FindSequence( const uint8_t *p, const uint8_t *end,
+                                                      uint8_t xx )
+{
+#if defined(HAVE_SSE2_INTRINSICS)
+# ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return startcode_FindSequence_AVX2(p, end, xx);
+# endif
+    if (vlc_CPU_SSE2())
+        return startcode_FindSequence_SSE2(p, end, xx);
+#elif defined(HAVE_NEON_INTRINSICS)
+    return startcode_FindSequence_NEON(p, end, xx);
+#endif
+    return startcode_FindSequence_C(p, end, xx);
+}
+
 #if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return startcode_FindSequence_AVX2(p, end, 0x01);
+#endif
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
     else
         return startcode_FindAnnexB_Bits(p, end);
 }
+#elif defined(HAVE_NEON_INTRINSICS)
+static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_FindSequence_NEON(p, end, 0x01);
+}
 #else
     #define startcode_FindAnnexB startcode_FindAnnexB_Bits
 #endif
@@ -80,6 +80,7 @@ struct vout_display_sys_t
 static picture_pool_t *Pool (vout_display_t *, unsigned);
 static void PictureRender (vout_display_t *, picture_t *, subpicture_t *, vlc_tick_t);
 static void PictureDisplay (vout_display_t *, picture_t *, subpicture_t *);
+static void PictureCancel (vout_display_t *, picture_t *, subpicture_t *);
 static int Control (vout_display_t *, int, va_list);
 
 /**
@@ -149,6 +150,7 @@ static int Open (vlc_object_t *obj)
     vd->info.subpicture_chromas = spu_chromas;
     vd->pool = Pool;
     vd->prepare = PictureRender;
+    vd->cancel = PictureCancel;
     vd->display = PictureDisplay;
     vd->control = Control;
     return VLC_SUCCESS;
@@ -220,6 +222,15 @@ static void PictureDisplay (vout_display_t *vd, picture_t *pic, subpicture_t *su
         subpicture_Delete(subpicture);
 }
 
+static void PictureCancel (vout_display_t *vd, picture_t *pic, subpicture_t *subpicture)
+{
+    VLC_UNUSED(vd);
+    /* The textures are uploaded again by the next prepare */
+    picture_Release (pic);
+    if (subpicture != NULL)
+        subpicture_Delete(subpicture);
+}
+
 static int Control (vout_display_t *vd, int query, va_list ap)
 {
     vout_display_sys_t *sys = vd->sys;
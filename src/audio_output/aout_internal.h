@@ -87,6 +87,7 @@ typedef struct
 
     atomic_uint buffers_lost;
     atomic_uint buffers_played;
+    atomic_uint underruns; /**< Pull model ring buffer underruns */
     atomic_uchar restart;
 } aout_owner_t;
 
@@ -142,7 +143,8 @@ int aout_DecNew(audio_output_t *, const audio_sample_format_t *,
                 const audio_replay_gain_t *, const aout_request_vout_t *);
 void aout_DecDelete(audio_output_t *);
 int aout_DecPlay(audio_output_t *aout, block_t *block);
-void aout_DecGetResetStats(audio_output_t *, unsigned *, unsigned *);
+void aout_DecGetResetStats(audio_output_t *, unsigned *, unsigned *,
+                           unsigned *);
 void aout_DecChangePause(audio_output_t *, bool b_paused, vlc_tick_t i_date);
 void aout_DecChangeRate(audio_output_t *aout, float rate);
 void aout_DecFlush(audio_output_t *, bool wait);
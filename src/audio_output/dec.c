@@ -107,6 +107,7 @@ error:
 
     atomic_init (&owner->buffers_lost, 0);
     atomic_init (&owner->buffers_played, 0);
+    atomic_init (&owner->underruns, 0);
     atomic_store_explicit(&owner->vp.update, true, memory_order_relaxed);
     return 0;
 }
@@ -395,7 +396,8 @@ lost:
 }
 
 void aout_DecGetResetStats(audio_output_t *aout, unsigned *restrict lost,
-                           unsigned *restrict played)
+                           unsigned *restrict played,
+                           unsigned *restrict underruns)
 {
     aout_owner_t *owner = aout_owner (aout);
 
@@ -403,6 +405,8 @@ void aout_DecGetResetStats(audio_output_t *aout, unsigned *restrict lost,
                                      memory_order_relaxed);
     *played = atomic_exchange_explicit(&owner->buffers_played, 0,
                                        memory_order_relaxed);
+    *underruns = atomic_exchange_explicit(&owner->underruns, 0,
+                                          memory_order_relaxed);
 }
 
 void aout_DecChangePause (audio_output_t *aout, bool paused, vlc_tick_t date)
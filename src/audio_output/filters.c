@@ -274,6 +274,30 @@ error:
     return -1;
 }
 
+/* Number of samples going through in-place filters at once */
+#define AOUT_PROCESS_SLICE 256
+
+/**
+ * Filters an audio buffer in place through consecutive filters, one slice at
+ * a time, rather than walking the whole buffer once per filter.
+ */
+static void aout_FiltersPipelineProcess(filter_t *const *filters,
+                                        unsigned count, block_t *block)
+{
+    const unsigned channels = filters[0]->fmt_in.audio.i_channels;
+    float *samples = (float *)block->p_buffer;
+
+    for (unsigned done = 0; done < block->i_nb_samples;
+         done += AOUT_PROCESS_SLICE)
+    {
+        unsigned slice = __MIN(block->i_nb_samples - done, AOUT_PROCESS_SLICE);
+
+        for (unsigned i = 0; i < count; i++)
+            filters[i]->pf_audio_process(filters[i], samples + done * channels,
+                                         slice);
+    }
+}
+
 /**
  * Filters an audio buffer through a chain of filters.
  */
@@ -284,6 +308,17 @@ static block_t *aout_FiltersPipelinePlay(filter_t *const *filters,
     for (unsigned i = 0; (i < count) && (block != NULL); i++)
     {
         filter_t *filter = filters[i];
+        unsigned fused = 0;
+
+        while (i + fused < count && filters[i + fused]->pf_audio_process)
+            fused++;
+        if (fused > 1)
+        {
+            assert(filter->fmt_in.audio.i_format == VLC_CODEC_FL32);
+            aout_FiltersPipelineProcess(&filters[i], fused, block);
+            i += fused - 1;
+            continue;
+        }
 
         /* Please note that p_block->i_nb_samples & i_buffer
          * shall be set by the filter plug-in. */
@@ -0,0 +1,599 @@
+/*****************************************************************************
+ * loudness.c : EBU R128 loudness meter
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_cpu.h>
+#include <vlc_loudness.h>
+
+#ifdef HAVE_SSE2_INTRINSICS
+# include <immintrin.h>
+#endif
+
+/* Loudness is measured over 100 ms sub-blocks: a momentary block (400 ms)
+ * and a short-term block (3 s) end on each sub-block. */
+#define SUBBLOCKS_PER_SEC 10
+#define MOMENTARY_SUBBLOCKS 4
+#define SHORT_TERM_SUBBLOCKS 30
+
+/* Gated blocks are kept in histograms of 0.1 LU bins from -70 to +30 LUFS,
+ * so that memory does not grow with the length of the stream. */
+#define ABSOLUTE_GATE (-70.)
+#define HIST_STEP .1
+#define HIST_BINS 1000
+
+/* True peak 4x over-sampling filter, as long as BS.1770-4 Annex 2 */
+#define TP_TAPS 12 /* per phase */
+#define TP_MAX_FACTOR 4
+
+struct vlc_loudness_hist
+{
+    uint64_t count[HIST_BINS];
+    double energy[HIST_BINS];
+};
+
+struct vlc_loudness_meter
+{
+    unsigned channels;
+    unsigned subblock_frames;
+    unsigned subblock_done; /**< Frames of the current sub-block */
+
+    /* K-weighting: a high shelf then a high pass biquad */
+    struct
+    {
+        double b0, b1, b2, a1, a2;
+    } shelf, highpass;
+
+    double *weights; /**< Channel weights */
+    double *state; /**< Biquads states, four per channel */
+    double *energy; /**< Energy of the current sub-block, per channel */
+
+    unsigned factor; /**< True peak over-sampling factor */
+    unsigned tp_pos;
+    double tp_coeffs[TP_MAX_FACTOR][TP_TAPS];
+    double *tp_history; /**< Last inputs, twice, per channel */
+    double *tp_peak; /**< Maximum true peak, per channel */
+
+    void (*kweight)(vlc_loudness_meter_t *, const float *, size_t);
+    void (*true_peak)(vlc_loudness_meter_t *, const float *, size_t);
+
+    uint64_t subblocks; /**< Number of complete sub-blocks */
+    double subblock_energy[SHORT_TERM_SUBBLOCKS]; /**< Last sub-blocks */
+
+    struct vlc_loudness_hist integrated;
+    struct vlc_loudness_hist range;
+};
+
+/* The arrays are rounded up to an even number of channels, so that the SIMD
+ * code can load channel pairs. */
+static unsigned meter_Stride(const vlc_loudness_meter_t *meter)
+{
+    return (meter->channels + 1) & ~1u;
+}
+
+static double Loudness(double energy)
+{
+    return energy > 0. ? -0.691 + 10. * log10(energy) : -INFINITY;
+}
+
+static int HistBin(double loudness)
+{
+    int bin = floor((loudness - ABSOLUTE_GATE) / HIST_STEP);
+
+    return bin < HIST_BINS ? bin : HIST_BINS - 1;
+}
+
+/*** K-weighting ***/
+static void KWeightChannel(vlc_loudness_meter_t *meter, const float *in,
+                           size_t frames, unsigned c)
+{
+    const unsigned channels = meter->channels, stride = meter_Stride(meter);
+    const double sb0 = meter->shelf.b0, sb1 = meter->shelf.b1,
+                 sb2 = meter->shelf.b2, sa1 = meter->shelf.a1,
+                 sa2 = meter->shelf.a2;
+    const double hb0 = meter->highpass.b0, hb1 = meter->highpass.b1,
+                 hb2 = meter->highpass.b2, ha1 = meter->highpass.a1,
+                 ha2 = meter->highpass.a2;
+    double *state = meter->state;
+    double s1 = state[c], s2 = state[stride + c];
+    double h1 = state[2 * stride + c], h2 = state[3 * stride + c];
+    double energy = meter->energy[c];
+
+    in += c;
+    for (size_t i = 0; i < frames; i++)
+    {   /* Transposed direct form II */
+        double x = in[i * channels];
+        double y = sb0 * x + s1;
+
+        s1 = sb1 * x - sa1 * y + s2;
+        s2 = sb2 * x - sa2 * y;
+        x = y;
+        y = hb0 * x + h1;
+        h1 = hb1 * x - ha1 * y + h2;
+        h2 = hb2 * x - ha2 * y;
+        energy += y * y;
+    }
+
+    state[c] = s1;
+    state[stride + c] = s2;
+    state[2 * stride + c] = h1;
+    state[3 * stride + c] = h2;
+    meter->energy[c] = energy;
+}
+
+static void KWeight_c(vlc_loudness_meter_t *meter, const float *in,
+                      size_t frames)
+{
+    for (unsigned c = 0; c < meter->channels; c++)
+        KWeightChannel(meter, in, frames, c);
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+/* Filters two channels at once */
+VLC_SSE
+static void KWeight_sse2(vlc_loudness_meter_t *meter, const float *in,
+                         size_t frames)
+{
+    const unsigned channels = meter->channels, stride = meter_Stride(meter);
+    const __m128d sb0 = _mm_set1_pd(meter->shelf.b0),
+                  sb1 = _mm_set1_pd(meter->shelf.b1),
+                  sb2 = _mm_set1_pd(meter->shelf.b2),
+                  sa1 = _mm_set1_pd(meter->shelf.a1),
+                  sa2 = _mm_set1_pd(meter->shelf.a2);
+    const __m128d hb0 = _mm_set1_pd(meter->highpass.b0),
+                  hb1 = _mm_set1_pd(meter->highpass.b1),
+                  hb2 = _mm_set1_pd(meter->highpass.b2),
+                  ha1 = _mm_set1_pd(meter->highpass.a1),
+                  ha2 = _mm_set1_pd(meter->highpass.a2);
+    double *state = meter->state;
+    unsigned c = 0;
+
+    for (; c + 2 <= channels; c += 2)
+    {
+        __m128d s1 = _mm_loadu_pd(state + c);
+        __m128d s2 = _mm_loadu_pd(state + stride + c);
+        __m128d h1 = _mm_loadu_pd(state + 2 * stride + c);
+        __m128d h2 = _mm_loadu_pd(state + 3 * stride + c);
+        __m128d energy = _mm_loadu_pd(meter->energy + c);
+        const float *p = in + c;
+
+        for (size_t i = 0; i < frames; i++, p += channels)
+        {
+            __m128d x = _mm_cvtps_pd(_mm_castsi128_ps(
+                                _mm_loadl_epi64((const __m128i *)p)));
+            __m128d y = _mm_add_pd(_mm_mul_pd(sb0, x), s1);
+
+            s1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(sb1, x),
+                                       _mm_mul_pd(sa1, y)), s2);
+            s2 = _mm_sub_pd(_mm_mul_pd(sb2, x), _mm_mul_pd(sa2, y));
+            x = y;
+            y = _mm_add_pd(_mm_mul_pd(hb0, x), h1);
+            h1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(hb1, x),
+                                       _mm_mul_pd(ha1, y)), h2);
+            h2 = _mm_sub_pd(_mm_mul_pd(hb2, x), _mm_mul_pd(ha2, y));
+            energy = _mm_add_pd(energy, _mm_mul_pd(y, y));
+        }
+
+        _mm_storeu_pd(state + c, s1);
+        _mm_storeu_pd(state + stride + c, s2);
+        _mm_storeu_pd(state + 2 * stride + c, h1);
+        _mm_storeu_pd(state + 3 * stride + c, h2);
+        _mm_storeu_pd(meter->energy + c, energy);
+    }
+
+    if (c < channels)
+        KWeightChannel(meter, in, frames, c);
+}
+#endif
+
+/*** True peak ***/
+static void TruePeak_c(vlc_loudness_meter_t *meter, const float *in,
+                       size_t frames)
+{
+    const unsigned channels = meter->channels, stride = meter_Stride(meter);
+    double *history = meter->tp_history;
+    unsigned pos = meter->tp_pos;
+
+    for (size_t i = 0; i < frames; i++, in += channels)
+    {
+        /* The history is stored twice, so that the last TP_TAPS inputs are
+         * always contiguous, from the oldest at pos + 1. */
+        for (unsigned c = 0; c < channels; c++)
+            history[pos * stride + c] =
+            history[(pos + TP_TAPS) * stride + c] = in[c];
+        pos = (pos + 1) % TP_TAPS;
+
+        const double *window = history + pos * stride;
+
+        for (unsigned c = 0; c < channels; c++)
+        {
+            double peak = meter->tp_peak[c];
+
+            for (unsigned p = 0; p < meter->factor; p++)
+            {
+                double y = 0.;
+
+                for (unsigned k = 0; k < TP_TAPS; k++)
+                    y += meter->tp_coeffs[p][k] * window[k * stride + c];
+                peak = fmax(peak, fabs(y));
+            }
+            meter->tp_peak[c] = peak;
+        }
+    }
+    meter->tp_pos = pos;
+}
+
+#ifdef HAVE_SSE2_INTRINSICS
+VLC_SSE
+static void TruePeak_sse2(vlc_loudness_meter_t *meter, const float *in,
+                          size_t frames)
+{
+    const unsigned channels = meter->channels, stride = meter_Stride(meter);
+    const __m128d abs_mask = _mm_castsi128_pd(
+                                _mm_set1_epi64x(INT64_C(0x7fffffffffffffff)));
+    double *history = meter->tp_history;
+    unsigned pos = meter->tp_pos;
+
+    for (size_t i = 0; i < frames; i++, in += channels)
+    {
+        for (unsigned c = 0; c < channels; c++)
+            history[pos * stride + c] =
+            history[(pos + TP_TAPS) * stride + c] = in[c];
+        pos = (pos + 1) % TP_TAPS;
+
+        const double *window = history + pos * stride;
+
+        /* The arrays are padded, so the last odd channel can be computed
+         * alongside the padding channel. */
+        for (unsigned c = 0; c < channels; c += 2)
+        {
+            __m128d peak = _mm_loadu_pd(meter->tp_peak + c);
+
+            for (unsigned p = 0; p < meter->factor; p++)
+            {
+                __m128d y = _mm_setzero_pd();
+
+                for (unsigned k = 0; k < TP_TAPS; k++)
+                    y = _mm_add_pd(y, _mm_mul_pd(
+                            _mm_set1_pd(meter->tp_coeffs[p][k]),
+                            _mm_loadu_pd(window + k * stride + c)));
+                peak = _mm_max_pd(peak, _mm_and_pd(y, abs_mask));
+            }
+            _mm_storeu_pd(meter->tp_peak + c, peak);
+        }
+    }
+    meter->tp_pos = pos;
+}
+#endif
+
+/*** Gating ***/
+static void HistAdd(struct vlc_loudness_hist *hist, double energy)
+{
+    double loudness = Loudness(energy);
+
+    if (loudness < ABSOLUTE_GATE)
+        return;
+
+    int bin = HistBin(loudness);
+
+    hist->count[bin]++;
+    hist->energy[bin] += energy;
+}
+
+/* Returns the first bin above the relative gate, or -1 if no blocks */
+static int HistGate(const struct vlc_loudness_hist *hist, double gate)
+{
+    uint64_t count = 0;
+    double energy = 0.;
+
+    for (unsigned i = 0; i < HIST_BINS; i++)
+    {
+        count += hist->count[i];
+        energy += hist->energy[i];
+    }
+    if (count == 0)
+        return -1;
+
+    double threshold = Loudness(energy / count) + gate;
+
+    if (threshold < ABSOLUTE_GATE)
+        return 0;
+    return ceil((threshold - ABSOLUTE_GATE) / HIST_STEP);
+}
+
+static void EndSubblock(vlc_loudness_meter_t *meter)
+{
+    const unsigned stride = meter_Stride(meter);
+    double energy = 0.;
+
+    for (unsigned c = 0; c < meter->channels; c++)
+    {
+        energy += meter->weights[c] * meter->energy[c];
+        meter->energy[c] = 0.;
+    }
+
+    /* Flush denormals after silence */
+    for (unsigned i = 0; i < 4 * stride; i++)
+        if (fabs(meter->state[i]) < 1e-30)
+            meter->state[i] = 0.;
+
+    meter->subblock_energy[meter->subblocks % SHORT_TERM_SUBBLOCKS] = energy;
+    meter->subblocks++;
+    meter->subblock_done = 0;
+
+    if (meter->subblocks >= MOMENTARY_SUBBLOCKS)
+    {
+        energy = 0.;
+        for (unsigned i = 0; i < MOMENTARY_SUBBLOCKS; i++)
+            energy += meter->subblock_energy[(meter->subblocks - 1 - i)
+                                             % SHORT_TERM_SUBBLOCKS];
+        HistAdd(&meter->integrated,
+                energy / (MOMENTARY_SUBBLOCKS * meter->subblock_frames));
+    }
+
+    if (meter->subblocks >= SHORT_TERM_SUBBLOCKS)
+    {
+        energy = 0.;
+        for (unsigned i = 0; i < SHORT_TERM_SUBBLOCKS; i++)
+            energy += meter->subblock_energy[i];
+        HistAdd(&meter->range,
+                energy / (SHORT_TERM_SUBBLOCKS * meter->subblock_frames));
+    }
+}
+
+/*** Meter ***/
+static double ChannelWeight(uint32_t chan)
+{
+    switch (chan)
+    {
+        case AOUT_CHAN_LEFT:
+        case AOUT_CHAN_RIGHT:
+        case AOUT_CHAN_CENTER:
+            return 1.;
+        case AOUT_CHAN_LFE:
+            return 0.;
+        default: /* surround channels: +1.5 dB */
+            return 1.41;
+    }
+}
+
+/* Designs the K-weighting filter for the sample rate, from the 48 kHz
+ * coefficients of BS.1770. */
+static void KWeightSetup(vlc_loudness_meter_t *meter, unsigned rate)
+{
+    double f0 = 1681.974450955533;
+    double G = 3.999843853973347;
+    double Q = 0.7071752369554196;
+    double K = tan(M_PI * f0 / rate);
+    double Vh = pow(10., G / 20.);
+    double Vb = pow(Vh, 0.4996667741545416);
+    double a0 = 1. + K / Q + K * K;
+
+    meter->shelf.b0 = (Vh + Vb * K / Q + K * K) / a0;
+    meter->shelf.b1 = 2. * (K * K - Vh) / a0;
+    meter->shelf.b2 = (Vh - Vb * K / Q + K * K) / a0;
+    meter->shelf.a1 = 2. * (K * K - 1.) / a0;
+    meter->shelf.a2 = (1. - K / Q + K * K) / a0;
+
+    f0 = 38.13547087602444;
+    Q = 0.5003270373238773;
+    K = tan(M_PI * f0 / rate);
+    a0 = 1. + K / Q + K * K;
+
+    meter->highpass.b0 = 1.;
+    meter->highpass.b1 = -2.;
+    meter->highpass.b2 = 1.;
+    meter->highpass.a1 = 2. * (K * K - 1.) / a0;
+    meter->highpass.a2 = (1. - K / Q + K * K) / a0;
+}
+
+/* Designs the polyphase over-sampling filter: a Hann-windowed sinc */
+static void TruePeakSetup(vlc_loudness_meter_t *meter, unsigned rate)
+{
+    unsigned factor = rate < 96000 ? 4 : rate < 192000 ? 2 : 1;
+    unsigned length = factor * TP_TAPS;
+
+    meter->factor = factor;
+    for (unsigned p = 0; p < factor; p++)
+    {
+        double sum = 0.;
+
+        for (unsigned i = 0; i < TP_TAPS; i++)
+        {
+            /* The newest input is last in the history */
+            unsigned j = p + factor * (TP_TAPS - 1 - i);
+            /* Centered on a tap, so that the phases fall on the inputs and
+             * evenly in between, such as half-way */
+            double m = (double)j - length / 2;
+            double h = m != 0. ? sin(M_PI * m / factor) / (M_PI * m / factor)
+                               : 1.;
+
+            h *= .5 * (1. - cos(2. * M_PI * j / length));
+            meter->tp_coeffs[p][i] = h;
+            sum += h;
+        }
+        for (unsigned i = 0; i < TP_TAPS; i++)
+            meter->tp_coeffs[p][i] /= sum;
+    }
+}
+
+vlc_loudness_meter_t *vlc_loudness_meter_New(const audio_sample_format_t *fmt)
+{
+    assert(fmt->i_format == VLC_CODEC_FL32);
+    assert(fmt->channel_type == AUDIO_CHANNEL_TYPE_BITMAP);
+
+    unsigned channels = vlc_popcount(fmt->i_physical_channels);
+    if (channels == 0 || fmt->i_rate < SUBBLOCKS_PER_SEC)
+        return NULL;
+
+    vlc_loudness_meter_t *meter = malloc(sizeof (*meter));
+    if (unlikely(meter == NULL))
+        return NULL;
+
+    meter->channels = channels;
+
+    /* weights, state (4), energy, history (2 * TP_TAPS), peak */
+    const unsigned stride = meter_Stride(meter);
+    double *buf = vlc_alloc(stride * (7 + 2 * TP_TAPS), sizeof (*buf));
+    if (unlikely(buf == NULL))
+    {
+        free(meter);
+        return NULL;
+    }
+
+    meter->weights = buf;
+    meter->state = meter->weights + stride;
+    meter->energy = meter->state + 4 * stride;
+    meter->tp_history = meter->energy + stride;
+    meter->tp_peak = meter->tp_history + 2 * TP_TAPS * stride;
+
+    for (unsigned c = 0; c < stride; c++)
+        meter->weights[c] = 0.;
+    for (unsigned i = 0, c = 0; pi_vlc_chan_order_wg4[i]; i++)
+        if (fmt->i_physical_channels & pi_vlc_chan_order_wg4[i])
+            meter->weights[c++] = ChannelWeight(pi_vlc_chan_order_wg4[i]);
+
+    meter->subblock_frames = (fmt->i_rate + SUBBLOCKS_PER_SEC / 2)
+                           / SUBBLOCKS_PER_SEC;
+    KWeightSetup(meter, fmt->i_rate);
+    TruePeakSetup(meter, fmt->i_rate);
+
+    meter->kweight = KWeight_c;
+    meter->true_peak = TruePeak_c;
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE2())
+    {
+        meter->kweight = KWeight_sse2;
+        meter->true_peak = TruePeak_sse2;
+    }
+#endif
+
+    vlc_loudness_meter_Reset(meter);
+    return meter;
+}
+
+void vlc_loudness_meter_Delete(vlc_loudness_meter_t *meter)
+{
+    free(meter->weights);
+    free(meter);
+}
+
+void vlc_loudness_meter_Reset(vlc_loudness_meter_t *meter)
+{
+    const unsigned stride = meter_Stride(meter);
+
+    memset(meter->state, 0, stride * (6 + 2 * TP_TAPS) * sizeof (double));
+    meter->subblock_done = 0;
+    meter->tp_pos = 0;
+    meter->subblocks = 0;
+    memset(&meter->integrated, 0, sizeof (meter->integrated));
+    memset(&meter->range, 0, sizeof (meter->range));
+}
+
+void vlc_loudness_meter_Process(vlc_loudness_meter_t *meter,
+                                const float *samples, size_t frames)
+{
+    while (frames > 0)
+    {
+        size_t count = __MIN(frames,
+                             meter->subblock_frames - meter->subblock_done);
+
+        meter->kweight(meter, samples, count);
+        meter->true_peak(meter, samples, count);
+        samples += count * meter->channels;
+        frames -= count;
+
+        meter->subblock_done += count;
+        if (meter->subblock_done == meter->subblock_frames)
+            EndSubblock(meter);
+    }
+}
+
+static double SubblocksLoudness(const vlc_loudness_meter_t *meter,
+                                unsigned count)
+{
+    if (meter->subblocks < count)
+        return -INFINITY;
+
+    double energy = 0.;
+
+    for (unsigned i = 0; i < count; i++)
+        energy += meter->subblock_energy[(meter->subblocks - 1 - i)
+                                         % SHORT_TERM_SUBBLOCKS];
+    return Loudness(energy / (count * meter->subblock_frames));
+}
+
+void vlc_loudness_meter_Get(const vlc_loudness_meter_t *meter,
+                            struct vlc_loudness_report *report)
+{
+    report->momentary = SubblocksLoudness(meter, MOMENTARY_SUBBLOCKS);
+    report->short_term = SubblocksLoudness(meter, SHORT_TERM_SUBBLOCKS);
+
+    /* Integrated: mean of the momentary blocks, with a -10 LU relative gate */
+    const struct vlc_loudness_hist *hist = &meter->integrated;
+    int gate = HistGate(hist, -10.);
+    uint64_t count = 0;
+    double energy = 0.;
+
+    for (int i = gate; i >= 0 && i < HIST_BINS; i++)
+    {
+        count += hist->count[i];
+        energy += hist->energy[i];
+    }
+    report->integrated = count > 0 ? Loudness(energy / count) : -INFINITY;
+
+    /* Range: spread of the short-term blocks, with a -20 LU relative gate,
+     * between the 10th and 95th percentiles */
+    hist = &meter->range;
+    gate = HistGate(hist, -20.);
+    count = 0;
+    for (int i = gate; i >= 0 && i < HIST_BINS; i++)
+        count += hist->count[i];
+
+    report->range = 0.;
+    if (count > 0)
+    {
+        uint64_t low = count / 10, high = count - count / 20 - 1, sum = 0;
+        int low_bin = -1, high_bin = -1;
+
+        for (int i = gate; i < HIST_BINS; i++)
+        {
+            sum += hist->count[i];
+            if (low_bin < 0 && sum > low)
+                low_bin = i;
+            if (high_bin < 0 && sum > high)
+                high_bin = i;
+        }
+        report->range = (high_bin - low_bin) * HIST_STEP;
+    }
+
+    double peak = 0.;
+    for (unsigned c = 0; c < meter->channels; c++)
+        peak = fmax(peak, meter->tp_peak[c]);
+    report->true_peak = peak > 0. ? 20. * log10(peak) : -INFINITY;
+}
@@ -0,0 +1,245 @@
+/*****************************************************************************
+ * ring.c : lock-free ring buffer for pull model audio outputs
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_atomic.h>
+#include "aout_internal.h"
+
+/* Positions are byte counts modulo 2^32. Only the producer moves the write
+ * position, and only the consumer moves the read position. A flush cannot
+ * move the read position from the producer side, so it is deferred to the
+ * next read through the flush position. */
+struct aout_ring
+{
+    audio_output_t *aout;
+    uint8_t *buffer;
+    unsigned size; /**< Capacity in bytes, a power of two */
+    unsigned frame_size;
+    unsigned rate;
+    uint8_t silence;
+    vlc_tick_t duration; /**< Stall time-out */
+
+    atomic_uint read; /**< Consumer position */
+    atomic_uint write; /**< Producer position */
+    atomic_uint flush; /**< Position to skip to on the next read */
+    atomic_bool flushing; /**< The flush position is pending */
+    atomic_bool primed; /**< Samples were queued since the last flush/drain */
+    atomic_bool waiting; /**< The producer sleeps on the read position */
+};
+
+aout_ring_t *aout_RingNew(audio_output_t *aout,
+                          const audio_sample_format_t *fmt,
+                          vlc_tick_t duration)
+{
+    assert(AOUT_FMT_LINEAR(fmt));
+    assert(fmt->i_bytes_per_frame > 0 && fmt->i_rate > 0);
+
+    uint64_t bytes = (uint64_t)duration * fmt->i_rate / CLOCK_FREQ
+                   * fmt->i_bytes_per_frame;
+    if (bytes == 0 || bytes > (UINT_MAX / 2) + 1)
+        return NULL;
+
+    aout_ring_t *ring = malloc(sizeof (*ring));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    ring->size = 1;
+    while (ring->size < bytes)
+        ring->size <<= 1;
+
+    ring->buffer = malloc(ring->size);
+    if (unlikely(ring->buffer == NULL))
+    {
+        free(ring);
+        return NULL;
+    }
+
+    ring->aout = aout;
+    ring->frame_size = fmt->i_bytes_per_frame;
+    ring->rate = fmt->i_rate;
+    ring->silence = fmt->i_format == VLC_CODEC_U8 ? 0x80 : 0;
+    ring->duration = duration;
+    atomic_init(&ring->read, 0);
+    atomic_init(&ring->write, 0);
+    atomic_init(&ring->flush, 0);
+    atomic_init(&ring->flushing, false);
+    atomic_init(&ring->primed, false);
+    atomic_init(&ring->waiting, false);
+
+    msg_Dbg(aout, "pull model ring buffer: %u bytes", ring->size);
+    return ring;
+}
+
+void aout_RingDelete(aout_ring_t *ring)
+{
+    free(ring->buffer);
+    free(ring);
+}
+
+/* Returns the read position, including any pending flush. The read position
+ * never goes backward, even if the consumer went past the flush position. */
+static unsigned aout_RingReadPosition(aout_ring_t *ring, bool consume)
+{
+    unsigned read = atomic_load_explicit(&ring->read, memory_order_acquire);
+    bool flushing = consume
+        ? atomic_exchange_explicit(&ring->flushing, false,
+                                   memory_order_acquire)
+        : atomic_load_explicit(&ring->flushing, memory_order_acquire);
+
+    if (flushing)
+    {
+        unsigned flush = atomic_load_explicit(&ring->flush,
+                                              memory_order_relaxed);
+        if ((int)(flush - read) > 0)
+            read = flush;
+    }
+    return read;
+}
+
+size_t aout_RingQueued(aout_ring_t *ring)
+{
+    unsigned write = atomic_load_explicit(&ring->write, memory_order_acquire);
+    unsigned queued = write - aout_RingReadPosition(ring, false);
+
+    return queued - (queued % ring->frame_size);
+}
+
+/* Sleeps until the consumer moves the read position away from the given
+ * value, or the time-out elapses. */
+static bool aout_RingWait(aout_ring_t *ring, unsigned read, vlc_tick_t delay)
+{
+    bool woken = true;
+
+    atomic_store(&ring->waiting, true);
+    if (atomic_load(&ring->read) == read)
+        woken = vlc_addr_timedwait(&ring->read, read, delay);
+    atomic_store(&ring->waiting, false);
+    return woken;
+}
+
+void aout_RingPlay(aout_ring_t *ring, block_t *block)
+{
+    const uint8_t *p = block->p_buffer;
+    size_t length = block->i_buffer;
+    unsigned write = atomic_load_explicit(&ring->write, memory_order_relaxed);
+
+    while (length > 0)
+    {
+        unsigned read = atomic_load_explicit(&ring->read, memory_order_acquire);
+        size_t room = ring->size - (write - read);
+
+        if (room == 0)
+        {
+            if (!aout_RingWait(ring, read, ring->duration))
+            {
+                msg_Warn(ring->aout, "output stalled, dropping %zu bytes",
+                         length);
+                break;
+            }
+            continue;
+        }
+
+        size_t count = __MIN(room, length);
+        unsigned offset = write & (ring->size - 1);
+        size_t first = __MIN(count, ring->size - offset);
+
+        memcpy(ring->buffer + offset, p, first);
+        memcpy(ring->buffer, p + first, count - first);
+        write += count;
+        p += count;
+        length -= count;
+        atomic_store_explicit(&ring->write, write, memory_order_release);
+    }
+
+    atomic_store_explicit(&ring->primed, true, memory_order_release);
+    block_Release(block);
+}
+
+size_t aout_RingRead(aout_ring_t *ring, void *buf, size_t bytes)
+{
+    unsigned read = aout_RingReadPosition(ring, true);
+    unsigned write = atomic_load_explicit(&ring->write, memory_order_acquire);
+    size_t count = __MIN(bytes, (size_t)(write - read));
+
+    count -= count % ring->frame_size;
+
+    unsigned offset = read & (ring->size - 1);
+    size_t first = __MIN(count, ring->size - offset);
+
+    memcpy(buf, ring->buffer + offset, first);
+    memcpy((uint8_t *)buf + first, ring->buffer, count - first);
+    atomic_store(&ring->read, read + count);
+
+    if (count < bytes)
+    {
+        memset((uint8_t *)buf + count, ring->silence, bytes - count);
+
+        if (atomic_exchange_explicit(&ring->primed, false,
+                                     memory_order_relaxed))
+            atomic_fetch_add_explicit(&aout_owner(ring->aout)->underruns, 1,
+                                      memory_order_relaxed);
+    }
+
+    if (atomic_exchange(&ring->waiting, false))
+        vlc_addr_signal(&ring->read);
+    return count;
+}
+
+void aout_RingFlush(aout_ring_t *ring)
+{
+    unsigned write = atomic_load_explicit(&ring->write, memory_order_relaxed);
+
+    atomic_store_explicit(&ring->primed, false, memory_order_relaxed);
+    atomic_store_explicit(&ring->flush, write, memory_order_relaxed);
+    atomic_store_explicit(&ring->flushing, true, memory_order_release);
+}
+
+void aout_RingDrain(aout_ring_t *ring)
+{
+    /* Running out of samples is expected from now on */
+    atomic_store_explicit(&ring->primed, false, memory_order_relaxed);
+
+    size_t queued = aout_RingQueued(ring);
+    vlc_tick_t deadline = vlc_tick_now() + ring->duration / 2
+        + CLOCK_FREQ * (queued / ring->frame_size) / ring->rate;
+
+    while (aout_RingQueued(ring) > 0)
+    {
+        unsigned read = atomic_load_explicit(&ring->read,
+                                             memory_order_acquire);
+        vlc_tick_t delay = deadline - vlc_tick_now();
+
+        if (delay <= 0)
+        {
+            msg_Warn(ring->aout, "output stalled, cannot drain");
+            break;
+        }
+        aout_RingWait(ring, read, delay);
+    }
+}
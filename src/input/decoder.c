@@ -42,12 +42,14 @@
 #include <vlc_meta.h>
 #include <vlc_dialog.h>
 #include <vlc_modules.h>
+#include <vlc_loudness.h>
 
 #include "audio_output/aout_internal.h"
 #include "stream_output/stream_output.h"
 #include "input_internal.h"
 #include "../clock/input_clock.h"
 #include "decoder.h"
+#include "decoder_pool.h"
 #include "event.h"
 #include "resource.h"
 
@@ -78,6 +80,15 @@ struct decoder_owner
     sout_packetizer_input_t *p_sout_input;
 
     vlc_thread_t     thread;
+    /* Direct stream output: blocks are processed on the input thread */
+    bool             b_direct;
+    /* Light decoders run on the shared pool instead of their own thread */
+    decoder_pool_t          *p_pool;
+    struct decoder_pool_task task;
+
+    /* Stream output throughput */
+    uint64_t         i_sout_bytes;
+    vlc_tick_t       i_sout_start;
 
     void (*pf_update_stat)( struct decoder_owner *, unsigned decoded, unsigned lost );
 
@@ -92,6 +103,8 @@ struct decoder_owner
     bool           b_fmt_description;
     vlc_meta_t     *p_description;
     atomic_int     reload;
+    atomic_bool    keyframe_only;
+    atomic_bool    wait_keyframe; /* since keyframe only mode ended */
 
     /* fifo */
     block_fifo_t *p_fifo;
@@ -108,6 +121,10 @@ struct decoder_owner
 
     vout_thread_t   *p_vout;
 
+    /* Loudness scanning */
+    aout_filters_t       *p_scan_filters;
+    vlc_loudness_meter_t *p_loudness;
+
     /* -- Theses variables need locking on read *and* write -- */
     /* Preroll */
     vlc_tick_t i_preroll_end;
@@ -117,6 +134,9 @@ struct decoder_owner
     float rate;
     unsigned frames_countdown;
     bool paused;
+    /* State of the output, only used by the decoder loop */
+    float output_rate;
+    bool output_paused;
 
     bool error;
 
@@ -127,6 +147,7 @@ struct decoder_owner
 
     /* Flushing */
     bool flushing;
+    bool closing;
     bool b_draining;
     atomic_bool drained;
     bool b_idle;
@@ -690,6 +711,13 @@ static float DecoderGetDisplayRate( decoder_t *p_dec )
     return input_clock_GetRate( p_owner->p_clock ) / (float) INPUT_RATE_DEFAULT;
 }
 
+static bool DecoderIsKeyframeOnly( decoder_t *p_dec )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    return atomic_load( &p_owner->keyframe_only );
+}
+
 /*****************************************************************************
  * Public functions
  *****************************************************************************/
@@ -845,6 +873,10 @@ static int DecoderPlaySout( decoder_t *p_dec, block_t *p_sout_block )
 
     vlc_mutex_unlock( &p_owner->lock );
 
+    if( p_owner->i_sout_start == VLC_TICK_INVALID )
+        p_owner->i_sout_start = vlc_tick_now();
+    p_owner->i_sout_bytes += p_sout_block->i_buffer;
+
     /* FIXME --VLC_TICK_INVALID inspect stream_output*/
     return sout_InputSendBuffer( p_owner->p_sout_input, p_sout_block );
 }
@@ -918,6 +950,23 @@ static void DecoderProcessSout( decoder_t *p_dec, block_t *p_block )
         }
     }
 }
+
+static void DecoderReportSout( decoder_t *p_dec )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    if( p_owner->i_sout_start == VLC_TICK_INVALID )
+        return;
+
+    vlc_tick_t i_elapsed = vlc_tick_now() - p_owner->i_sout_start;
+    if( i_elapsed <= 0 )
+        i_elapsed = 1;
+
+    msg_Info( p_dec, "%s stream output: %"PRIu64" bytes in %"PRId64" ms "
+              "(%"PRIu64" bytes/s)", p_owner->b_direct ? "direct" : "threaded",
+              p_owner->i_sout_bytes, MS_FROM_VLC_TICK( i_elapsed ),
+              p_owner->i_sout_bytes * CLOCK_FREQ / i_elapsed );
+}
 #endif
 
 static void DecoderPlayCc( decoder_t *p_dec, block_t *p_cc,
@@ -941,15 +990,25 @@ static void DecoderPlayCc( decoder_t *p_dec, block_t *p_cc,
         if( !p_ccdec )
             continue;
 
+        block_t *p_block;
         if( i_bitmap > 1 )
         {
-            block_FifoPut( p_ccowner->p_fifo, block_Duplicate(p_cc) );
+            p_block = block_Duplicate(p_cc);
         }
         else
         {
-            block_FifoPut( p_ccowner->p_fifo, p_cc );
+            p_block = p_cc;
             p_cc = NULL; /* was last dec */
         }
+        if( unlikely(p_block == NULL) )
+            continue;
+
+        vlc_fifo_Lock( p_ccowner->p_fifo );
+        vlc_fifo_QueueUnlocked( p_ccowner->p_fifo, p_block );
+        /* Pooled CC decoders only run when scheduled */
+        if( p_ccowner->p_pool != NULL )
+            decoder_pool_Schedule( p_ccowner->p_pool, &p_ccowner->task );
+        vlc_fifo_Unlock( p_ccowner->p_fifo );
     }
 
     vlc_mutex_unlock( &p_owner->lock );
@@ -1044,6 +1103,10 @@ static void DecoderPlayVideo( decoder_t *p_dec, picture_t *p_picture,
         p_picture->b_force = true;
     }
 
+    /* Keyframes are displayed as they come, rather than dropped as late */
+    if( atomic_load( &p_owner->keyframe_only ) )
+        p_picture->b_force = true;
+
     const bool b_dated = p_picture->date != VLC_TICK_INVALID;
     int i_rate = INPUT_RATE_DEFAULT;
     DecoderFixTs( p_dec, &p_picture->date, NULL, NULL,
@@ -1130,6 +1193,60 @@ static void DecoderQueueVideo( decoder_t *p_dec, picture_t *p_pic )
     p_owner->pf_update_stat( p_owner, 1, i_lost );
 }
 
+static int thumbnailer_update_format( decoder_t *p_dec )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    p_dec->fmt_out.video.i_chroma = p_dec->fmt_out.i_codec;
+
+    vlc_mutex_lock( &p_owner->lock );
+    DecoderUpdateFormatLocked( p_dec );
+    vlc_mutex_unlock( &p_owner->lock );
+    return 0;
+}
+
+static picture_t *thumbnailer_buffer_new( decoder_t *p_dec )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    /* Do not allocate anything once the thumbnail for the current seek point
+     * was generated: the decoder drops the pictures it cannot output */
+    vlc_mutex_lock( &p_owner->lock );
+    bool b_first = p_owner->b_first;
+    vlc_mutex_unlock( &p_owner->lock );
+
+    if( !b_first )
+        return NULL;
+    return picture_NewFromFormat( &p_dec->fmt_out.video );
+}
+
+static void DecoderQueueThumbnail( decoder_t *p_dec, picture_t *p_pic )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    vlc_mutex_lock( &p_owner->lock );
+    vlc_fifo_Lock( p_owner->p_fifo );
+    /* Pictures decoded from blocks queued before a seek, or still within the
+     * preroll of a precise seek, do not make thumbnails */
+    bool b_thumbnail = p_owner->b_first && !p_owner->flushing
+                    && p_owner->i_preroll_end <= p_pic->date;
+    vlc_fifo_Unlock( p_owner->p_fifo );
+
+    if( b_thumbnail )
+    {
+        p_owner->b_first = false;
+        p_owner->i_preroll_end = (vlc_tick_t)INT64_MIN;
+        /* Unblock the input if it waits for the end of the buffering */
+        p_owner->b_has_data = true;
+        vlc_cond_signal( &p_owner->wait_acknowledge );
+    }
+    vlc_mutex_unlock( &p_owner->lock );
+
+    if( b_thumbnail )
+        input_SendEventThumbnailReady( p_owner->p_input, p_pic );
+    picture_Release( p_pic );
+}
+
 static void DecoderPlayAudio( decoder_t *p_dec, block_t *p_audio,
                              unsigned *restrict pi_lost_sum )
 {
@@ -1217,7 +1334,7 @@ static void DecoderUpdateStatAudio( struct decoder_owner *p_owner,
                                     unsigned decoded, unsigned lost )
 {
     input_thread_t *p_input = p_owner->p_input;
-    unsigned played = 0;
+    unsigned played = 0, underruns = 0;
 
     /* Update ugly stat */
     if( p_input == NULL )
@@ -1227,7 +1344,8 @@ static void DecoderUpdateStatAudio( struct decoder_owner *p_owner,
     {
         unsigned aout_lost;
 
-        aout_DecGetResetStats( p_owner->p_aout, &aout_lost, &played );
+        aout_DecGetResetStats( p_owner->p_aout, &aout_lost, &played,
+                               &underruns );
         lost += aout_lost;
     }
 
@@ -1239,6 +1357,8 @@ static void DecoderUpdateStatAudio( struct decoder_owner *p_owner,
                                   memory_order_relaxed);
         atomic_fetch_add_explicit(&stats->played_abuffers, played,
                                   memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats->audio_underruns, underruns,
+                                  memory_order_relaxed);
         atomic_fetch_add_explicit(&stats->decoded_audio, decoded,
                                   memory_order_relaxed);
     }
@@ -1254,6 +1374,104 @@ static void DecoderQueueAudio( decoder_t *p_dec, block_t *p_aout_buf )
     p_owner->pf_update_stat( p_owner, 1, lost );
 }
 
+static int scanner_update_format( decoder_t *p_dec )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    p_dec->fmt_out.audio.i_format = p_dec->fmt_out.i_codec;
+
+    audio_sample_format_t format = p_dec->fmt_out.audio;
+    aout_FormatPrepare( &format );
+
+    if( p_owner->p_scan_filters != NULL
+     && AOUT_FMTS_IDENTICAL( &format, &p_owner->fmt.audio ) )
+        return 0;
+
+    /* The meter takes interleaved floats, in the bitmap channel order */
+    audio_sample_format_t meter_fmt = format;
+
+    meter_fmt.i_format = VLC_CODEC_FL32;
+    meter_fmt.channel_type = AUDIO_CHANNEL_TYPE_BITMAP;
+    meter_fmt.i_chan_mode = 0;
+    if( format.channel_type != AUDIO_CHANNEL_TYPE_BITMAP
+     || format.i_physical_channels == 0 )
+        meter_fmt.i_physical_channels = AOUT_CHANS_STEREO;
+    aout_FormatPrepare( &meter_fmt );
+
+    if( p_owner->p_scan_filters != NULL )
+        aout_FiltersDelete( (vlc_object_t *)NULL, p_owner->p_scan_filters );
+
+    const aout_filters_cfg_t cfg = AOUT_FILTERS_CFG_INIT;
+    p_owner->p_scan_filters = aout_FiltersNew( p_dec, &format, &meter_fmt,
+                                               NULL, &cfg );
+    if( p_owner->p_scan_filters == NULL )
+    {
+        msg_Err( p_dec, "cannot convert samples for loudness measurement" );
+        return -1;
+    }
+
+    if( p_owner->p_loudness != NULL )
+    {
+        /* The measurements cannot carry over another rate or layout */
+        msg_Warn( p_dec, "audio format changed, restarting measurement" );
+        vlc_loudness_meter_Delete( p_owner->p_loudness );
+    }
+    p_owner->p_loudness = vlc_loudness_meter_New( &meter_fmt );
+    if( p_owner->p_loudness == NULL )
+        return -1;
+
+    vlc_mutex_lock( &p_owner->lock );
+    DecoderUpdateFormatLocked( p_dec );
+    aout_FormatPrepare( &p_owner->fmt.audio );
+    vlc_mutex_unlock( &p_owner->lock );
+
+    p_dec->fmt_out.audio.i_bytes_per_frame =
+        p_owner->fmt.audio.i_bytes_per_frame;
+    p_dec->fmt_out.audio.i_frame_length =
+        p_owner->fmt.audio.i_frame_length;
+    return 0;
+}
+
+/* Measures samples already converted by the scan filters */
+static void DecoderMeasureAudio( struct decoder_owner *p_owner,
+                                 block_t *p_block )
+{
+    vlc_loudness_meter_Process( p_owner->p_loudness,
+                                (const float *)p_block->p_buffer,
+                                p_block->i_nb_samples );
+    block_Release( p_block );
+}
+
+static void DecoderQueueLoudness( decoder_t *p_dec, block_t *p_block )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+    unsigned lost = 0;
+
+    /* Unblock the input if it waits for the end of the buffering: there is
+     * no clock to wait for */
+    vlc_mutex_lock( &p_owner->lock );
+    if( p_owner->b_waiting )
+    {
+        p_owner->b_has_data = true;
+        vlc_cond_signal( &p_owner->wait_acknowledge );
+    }
+    vlc_mutex_unlock( &p_owner->lock );
+
+    if( p_owner->p_loudness != NULL )
+    {
+        p_block = aout_FiltersPlay( p_owner->p_scan_filters, p_block, 1.f );
+        if( p_block != NULL )
+            DecoderMeasureAudio( p_owner, p_block );
+    }
+    else
+    {
+        block_Release( p_block );
+        lost = 1;
+    }
+
+    p_owner->pf_update_stat( p_owner, 1, lost );
+}
+
 static void DecoderPlaySpu( decoder_t *p_dec, subpicture_t *p_subpic )
 {
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
@@ -1326,6 +1544,23 @@ static void DecoderDecode( decoder_t *p_dec, block_t *p_block )
 {
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
 
+    /* Frames known not to be keyframes are dropped before decoding. They are
+     * skipped on purpose, hence not accounted as lost pictures. Once the
+     * keyframe only mode ended, they are dropped until the next keyframe,
+     * as their references were. */
+    if( p_block != NULL && p_dec->fmt_in.i_cat == VIDEO_ES
+     && ( p_block->i_flags & BLOCK_FLAG_TYPE_MASK ) )
+    {
+        if( p_block->i_flags & BLOCK_FLAG_TYPE_I )
+            atomic_store( &p_owner->wait_keyframe, false );
+        else if( atomic_load( &p_owner->keyframe_only )
+              || atomic_load( &p_owner->wait_keyframe ) )
+        {
+            block_Release( p_block );
+            return;
+        }
+    }
+
     int ret = p_dec->pf_decode( p_dec, p_block );
     switch( ret )
     {
@@ -1552,20 +1787,17 @@ static void OutputChangeRate( decoder_t *p_dec, float rate )
 }
 
 /**
- * The decoding main loop
+ * The decoding main loop, called with the fifo locked
+ *
+ * A decoder thread never returns from it. A pooled decoder returns, with the
+ * fifo still locked, when it would otherwise wait for more work.
  *
  * \param p_dec the decoder
  */
-static void *DecoderThread( void *p_data )
+static void DecoderLoop( decoder_t *p_dec )
 {
-    decoder_t *p_dec = (decoder_t *)p_data;
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
-    float rate = 1.f;
-    bool paused = false;
-
-    /* The decoder's main loop */
-    vlc_fifo_Lock( p_owner->p_fifo );
-    vlc_fifo_CleanupPush( p_owner->p_fifo );
+    const bool b_pooled = p_owner->p_pool != NULL;
 
     for( ;; )
     {
@@ -1595,17 +1827,17 @@ static void *DecoderThread( void *p_data )
          * if needed. */
         if( p_owner->reset_out_state )
         {
-            rate = 1.f;
-            paused = false;
+            p_owner->output_rate = 1.f;
+            p_owner->output_paused = false;
             p_owner->reset_out_state = false;
         }
 
-        if( paused != p_owner->paused )
+        if( p_owner->output_paused != p_owner->paused )
         {   /* Update playing/paused status of the output */
             int canc = vlc_savecancel();
             vlc_tick_t date = p_owner->pause_date;
+            bool paused = p_owner->output_paused = p_owner->paused;
 
-            paused = p_owner->paused;
             vlc_fifo_Unlock( p_owner->p_fifo );
 
             vlc_mutex_lock( &p_owner->lock );
@@ -1617,11 +1849,11 @@ static void *DecoderThread( void *p_data )
             continue;
         }
 
-        if( rate != p_owner->rate )
+        if( p_owner->output_rate != p_owner->rate )
         {
             int canc = vlc_savecancel();
+            float rate = p_owner->output_rate = p_owner->rate;
 
-            rate = p_owner->rate;
             vlc_fifo_Unlock( p_owner->p_fifo );
 
             vlc_mutex_lock( &p_owner->lock );
@@ -1636,12 +1868,16 @@ static void *DecoderThread( void *p_data )
         {   /* Wait for resumption from pause */
             p_owner->b_idle = true;
             vlc_cond_signal( &p_owner->wait_acknowledge );
+            if( b_pooled )
+                return;
             vlc_fifo_Wait( p_owner->p_fifo );
             p_owner->b_idle = false;
             continue;
         }
 
         vlc_cond_signal( &p_owner->wait_fifo );
+        if( p_owner->closing ) /* pooled decoders are not cancelled */
+            return;
         vlc_testcancel(); /* forced expedited cancellation in case of stop */
 
         block_t *p_block = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
@@ -1651,6 +1887,8 @@ static void *DecoderThread( void *p_data )
             {   /* Wait for a block to decode (or a request to drain) */
                 p_owner->b_idle = true;
                 vlc_cond_signal( &p_owner->wait_acknowledge );
+                if( b_pooled )
+                    return;
                 vlc_fifo_Wait( p_owner->p_fifo );
                 p_owner->b_idle = false;
                 continue;
@@ -1683,10 +1921,41 @@ static void *DecoderThread( void *p_data )
         vlc_cond_signal( &p_owner->wait_acknowledge );
         vlc_mutex_unlock( &p_owner->lock );
     }
+}
+
+static void *DecoderThread( void *p_data )
+{
+    decoder_t *p_dec = (decoder_t *)p_data;
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    vlc_fifo_Lock( p_owner->p_fifo );
+    vlc_fifo_CleanupPush( p_owner->p_fifo );
+    DecoderLoop( p_dec );
     vlc_cleanup_pop();
     vlc_assert_unreachable();
 }
 
+static void DecoderTask( void *p_data )
+{
+    decoder_t *p_dec = (decoder_t *)p_data;
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    vlc_fifo_Lock( p_owner->p_fifo );
+    p_owner->b_idle = false;
+    DecoderLoop( p_dec );
+    vlc_fifo_Unlock( p_owner->p_fifo );
+}
+
+/* Wakes the decoder up, the fifo must be locked */
+static void DecoderSignal( decoder_t *p_dec )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    vlc_fifo_Signal( p_owner->p_fifo );
+    if( p_owner->p_pool != NULL )
+        decoder_pool_Schedule( p_owner->p_pool, &p_owner->task );
+}
+
 static const struct decoder_owner_callbacks dec_video_cbs =
 {
     .video = {
@@ -1696,6 +1965,16 @@ static const struct decoder_owner_callbacks dec_video_cbs =
         .queue_cc = DecoderQueueCc,
         .get_display_date = DecoderGetDisplayDate,
         .get_display_rate = DecoderGetDisplayRate,
+        .is_keyframe_only = DecoderIsKeyframeOnly,
+    },
+    .get_attachments = DecoderGetInputAttachments,
+};
+static const struct decoder_owner_callbacks dec_thumbnailer_cbs =
+{
+    .video = {
+        .format_update = thumbnailer_update_format,
+        .buffer_new = thumbnailer_buffer_new,
+        .queue = DecoderQueueThumbnail,
     },
     .get_attachments = DecoderGetInputAttachments,
 };
@@ -1707,6 +1986,14 @@ static const struct decoder_owner_callbacks dec_audio_cbs =
     },
     .get_attachments = DecoderGetInputAttachments,
 };
+static const struct decoder_owner_callbacks dec_scanner_cbs =
+{
+    .audio = {
+        .format_update = scanner_update_format,
+        .queue = DecoderQueueLoudness,
+    },
+    .get_attachments = DecoderGetInputAttachments,
+};
 static const struct decoder_owner_callbacks dec_spu_cbs =
 {
     .spu = {
@@ -1744,6 +2031,8 @@ static decoder_t * CreateDecoder( vlc_object_t *p_parent,
     p_owner->p_resource = p_resource;
     p_owner->p_aout = NULL;
     p_owner->p_vout = NULL;
+    p_owner->p_scan_filters = NULL;
+    p_owner->p_loudness = NULL;
     p_owner->i_spu_channel = 0;
     p_owner->i_spu_order = 0;
     p_owner->p_sout = p_sout;
@@ -1756,6 +2045,8 @@ static decoder_t * CreateDecoder( vlc_object_t *p_parent,
     p_owner->reset_out_state = false;
     p_owner->rate = 1.f;
     p_owner->paused = false;
+    p_owner->output_rate = 1.f;
+    p_owner->output_paused = false;
     p_owner->pause_date = VLC_TICK_INVALID;
     p_owner->frames_countdown = 0;
 
@@ -1766,11 +2057,20 @@ static decoder_t * CreateDecoder( vlc_object_t *p_parent,
     p_owner->error = false;
 
     p_owner->flushing = false;
+    p_owner->closing = false;
     p_owner->b_draining = false;
     p_owner->drained = false;
     atomic_init( &p_owner->reload, RELOAD_NO_REQUEST );
+    atomic_init( &p_owner->keyframe_only, false );
+    atomic_init( &p_owner->wait_keyframe, false );
     p_owner->b_idle = false;
 
+    p_owner->b_direct = false;
+    p_owner->p_pool = NULL;
+    decoder_pool_task_Init( &p_owner->task, DecoderTask, p_dec );
+    p_owner->i_sout_bytes = 0;
+    p_owner->i_sout_start = VLC_TICK_INVALID;
+
     p_owner->mouse_event = NULL;
     p_owner->opaque = NULL;
 
@@ -1814,11 +2114,17 @@ static decoder_t * CreateDecoder( vlc_object_t *p_parent,
     switch( fmt->i_cat )
     {
         case VIDEO_ES:
-            p_dec->cbs = &dec_video_cbs;
+            if( p_input != NULL && input_priv(p_input)->b_thumbnailing )
+                p_dec->cbs = &dec_thumbnailer_cbs;
+            else
+                p_dec->cbs = &dec_video_cbs;
             p_owner->pf_update_stat = DecoderUpdateStatVideo;
             break;
         case AUDIO_ES:
-            p_dec->cbs = &dec_audio_cbs;
+            if( p_input != NULL && input_priv(p_input)->b_scanning )
+                p_dec->cbs = &dec_scanner_cbs;
+            else
+                p_dec->cbs = &dec_audio_cbs;
             p_owner->pf_update_stat = DecoderUpdateStatAudio;
             break;
         case SPU_ES:
@@ -1830,6 +2136,11 @@ static decoder_t * CreateDecoder( vlc_object_t *p_parent,
             return p_dec;
     }
 
+    /* The stream output packetizer output is not decoded: let it skip the
+     * parsing only decoders need */
+    if( p_sout != NULL )
+        var_Create( p_dec, "packetizer-lazy", VLC_VAR_BOOL | VLC_VAR_DOINHERIT );
+
     /* Find a suitable decoder/packetizer module */
     if( LoadDecoder( p_dec, p_sout != NULL, fmt ) )
         return p_dec;
@@ -1888,6 +2199,7 @@ static void DeleteDecoder( decoder_t * p_dec )
 #ifdef ENABLE_SOUT
     if( p_owner->p_sout_input )
     {
+        DecoderReportSout( p_dec );
         sout_InputDelete( p_owner->p_sout_input );
     }
 #endif
@@ -1904,6 +2216,22 @@ static void DeleteDecoder( decoder_t * p_dec )
                 if( p_owner->p_input != NULL )
                     input_SendEventAout( p_owner->p_input );
             }
+            if( p_owner->p_loudness != NULL )
+            {
+                block_t *p_block = aout_FiltersDrain( p_owner->p_scan_filters );
+                if( p_block != NULL )
+                    DecoderMeasureAudio( p_owner, p_block );
+
+                struct vlc_loudness_report report;
+
+                vlc_loudness_meter_Get( p_owner->p_loudness, &report );
+                if( p_owner->p_input != NULL )
+                    input_SendEventLoudnessReady( p_owner->p_input, &report );
+                vlc_loudness_meter_Delete( p_owner->p_loudness );
+            }
+            if( p_owner->p_scan_filters != NULL )
+                aout_FiltersDelete( (vlc_object_t *)NULL,
+                                    p_owner->p_scan_filters );
             break;
         case VIDEO_ES:
             if( p_owner->p_vout )
@@ -2025,8 +2353,29 @@ static decoder_t *decoder_New( vlc_object_t *p_parent, input_thread_t *p_input,
             p_owner->error = true;
         }
     }
+
+    /* Remuxing only needs the packetizer: run it on the input thread */
+    if( p_sout && var_InheritBool( p_dec, "sout-direct" ) )
+    {
+        p_owner->b_direct = true;
+        p_owner->b_idle = true;
+        return p_dec;
+    }
 #endif
 
+    /* Subtitles and audio are seldom busy enough for a thread of their own */
+    if( p_dec->fmt_in.i_cat != VIDEO_ES
+     && var_InheritBool( p_dec, "decoder-pool" ) )
+    {
+        p_owner->p_pool = decoder_pool_Hold();
+        if( p_owner->p_pool != NULL )
+        {
+            p_owner->b_idle = true;
+            return p_dec;
+        }
+        msg_Warn( p_dec, "cannot use the decoder pool" );
+    }
+
     /* Spawn the decoder thread */
     if( vlc_clone( &p_owner->thread, DecoderThread, p_dec, i_priority ) )
     {
@@ -2075,11 +2424,19 @@ void input_DecoderDelete( decoder_t *p_dec )
 {
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
 
-    vlc_cancel( p_owner->thread );
+    if( p_owner->b_direct )
+    {
+        DeleteDecoder( p_dec );
+        return;
+    }
+
+    if( p_owner->p_pool == NULL )
+        vlc_cancel( p_owner->thread );
 
     vlc_fifo_Lock( p_owner->p_fifo );
     /* Signal DecoderTimedWait */
     p_owner->flushing = true;
+    p_owner->closing = p_owner->p_pool != NULL;
     vlc_cond_signal( &p_owner->wait_timed );
     vlc_fifo_Unlock( p_owner->p_fifo );
 
@@ -2099,7 +2456,13 @@ void input_DecoderDelete( decoder_t *p_dec )
         vout_Cancel( p_owner->p_vout, true );
     vlc_mutex_unlock( &p_owner->lock );
 
-    vlc_join( p_owner->thread, NULL );
+    if( p_owner->p_pool != NULL )
+    {
+        decoder_pool_Cancel( p_owner->p_pool, &p_owner->task );
+        decoder_pool_Release( p_owner->p_pool );
+    }
+    else
+        vlc_join( p_owner->thread, NULL );
 
     /* */
     if( p_owner->cc.b_supported )
@@ -2112,6 +2475,42 @@ void input_DecoderDelete( decoder_t *p_dec )
     DeleteDecoder( p_dec );
 }
 
+#ifdef ENABLE_SOUT
+/**
+ * Processes the pending blocks, and the pending drain request if any, of a
+ * direct decoder. The blocks queued while waiting are handed over in one
+ * batch.
+ */
+static void DecoderProcessDirect( decoder_t *p_dec )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+
+    vlc_fifo_Lock( p_owner->p_fifo );
+    block_t *p_chain = vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo );
+    bool b_draining = p_owner->b_draining;
+    vlc_fifo_Unlock( p_owner->p_fifo );
+
+    while( p_chain != NULL )
+    {
+        block_t *p_next = p_chain->p_next;
+
+        p_chain->p_next = NULL;
+        DecoderProcess( p_dec, p_chain );
+        p_chain = p_next;
+    }
+
+    if( b_draining )
+    {
+        DecoderProcess( p_dec, NULL );
+
+        vlc_fifo_Lock( p_owner->p_fifo );
+        p_owner->b_draining = false;
+        p_owner->drained = true;
+        vlc_fifo_Unlock( p_owner->p_fifo );
+    }
+}
+#endif
+
 /**
  * Put a block_t in the decoder's fifo.
  * Thread-safe w.r.t. the decoder. May be a cancellation point.
@@ -2147,7 +2546,14 @@ void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
     }
 
     vlc_fifo_QueueUnlocked( p_owner->p_fifo, p_block );
+    if( p_owner->p_pool != NULL )
+        decoder_pool_Schedule( p_owner->p_pool, &p_owner->task );
     vlc_fifo_Unlock( p_owner->p_fifo );
+
+#ifdef ENABLE_SOUT
+    if( p_owner->b_direct && !p_owner->b_waiting )
+        DecoderProcessDirect( p_dec );
+#endif
 }
 
 bool input_DecoderIsEmpty( decoder_t * p_dec )
@@ -2197,8 +2603,13 @@ void input_DecoderDrain( decoder_t *p_dec )
 
     vlc_fifo_Lock( p_owner->p_fifo );
     p_owner->b_draining = true;
-    vlc_fifo_Signal( p_owner->p_fifo );
+    DecoderSignal( p_dec );
     vlc_fifo_Unlock( p_owner->p_fifo );
+
+#ifdef ENABLE_SOUT
+    if( p_owner->b_direct && !p_owner->b_waiting )
+        DecoderProcessDirect( p_dec );
+#endif
 }
 
 /**
@@ -2214,6 +2625,13 @@ void input_DecoderFlush( decoder_t *p_dec )
     /* Empty the fifo */
     block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_owner->p_fifo ) );
 
+    if( p_owner->b_direct )
+    {
+        vlc_fifo_Unlock( p_owner->p_fifo );
+        DecoderProcessFlush( p_dec );
+        return;
+    }
+
     /* Don't need to wait for the DecoderThread to flush. Indeed, if called a
      * second time, this function will clear the FIFO again before anything was
      * dequeued by DecoderThread and there is no need to flush a second time in
@@ -2227,7 +2645,7 @@ void input_DecoderFlush( decoder_t *p_dec )
      && p_owner->frames_countdown == 0 )
         p_owner->frames_countdown++;
 
-    vlc_fifo_Signal( p_owner->p_fifo );
+    DecoderSignal( p_dec );
     vlc_cond_signal( &p_owner->wait_timed );
 
     vlc_fifo_Unlock( p_owner->p_fifo );
@@ -2346,7 +2764,7 @@ void input_DecoderChangePause( decoder_t *p_dec, bool b_paused, vlc_tick_t i_dat
     p_owner->paused = b_paused;
     p_owner->pause_date = i_date;
     p_owner->frames_countdown = 0;
-    vlc_fifo_Signal( p_owner->p_fifo );
+    DecoderSignal( p_dec );
     vlc_fifo_Unlock( p_owner->p_fifo );
 }
 
@@ -2356,10 +2774,19 @@ void input_DecoderChangeRate( decoder_t *dec, float rate )
 
     vlc_fifo_Lock( owner->p_fifo );
     owner->rate = rate;
-    vlc_fifo_Signal( owner->p_fifo );
+    DecoderSignal( dec );
     vlc_fifo_Unlock( owner->p_fifo );
 }
 
+void input_DecoderSetKeyframeOnly( decoder_t *dec, bool b_keyframe_only )
+{
+    struct decoder_owner *owner = dec_get_owner( dec );
+
+    if( atomic_exchange( &owner->keyframe_only, b_keyframe_only )
+     && !b_keyframe_only )
+        atomic_store( &owner->wait_keyframe, true );
+}
+
 void input_DecoderChangeDelay( decoder_t *p_dec, vlc_tick_t i_delay )
 {
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
@@ -2393,6 +2820,11 @@ void input_DecoderStopWait( decoder_t *p_dec )
     p_owner->b_waiting = false;
     vlc_cond_signal( &p_owner->wait_request );
     vlc_mutex_unlock( &p_owner->lock );
+
+#ifdef ENABLE_SOUT
+    if( p_owner->b_direct )
+        DecoderProcessDirect( p_dec );
+#endif
 }
 
 void input_DecoderWait( decoder_t *p_dec )
@@ -2401,6 +2833,10 @@ void input_DecoderWait( decoder_t *p_dec )
 
     assert( p_owner->b_waiting );
 
+    /* Direct decoders only process their data once the wait stops */
+    if( p_owner->b_direct )
+        return;
+
     vlc_mutex_lock( &p_owner->lock );
     while( !p_owner->b_has_data )
     {
@@ -2430,7 +2866,7 @@ void input_DecoderFrameNext( decoder_t *p_dec, vlc_tick_t *pi_duration )
 
     vlc_fifo_Lock( p_owner->p_fifo );
     p_owner->frames_countdown++;
-    vlc_fifo_Signal( p_owner->p_fifo );
+    DecoderSignal( p_dec );
     vlc_fifo_Unlock( p_owner->p_fifo );
 
     vlc_mutex_lock( &p_owner->lock );
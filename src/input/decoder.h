@@ -48,6 +48,13 @@ void input_DecoderChangePause( decoder_t *, bool b_paused, vlc_tick_t i_date );
  */
 void input_DecoderChangeRate( decoder_t *dec, float rate );
 
+/**
+ * This function enables or disables keyframe only decoding (fast forward).
+ * The other video frames are then dropped, and the keyframes are displayed
+ * as soon as decoded.
+ */
+void input_DecoderSetKeyframeOnly( decoder_t *dec, bool b_keyframe_only );
+
 /**
  * This function changes the delay.
  */
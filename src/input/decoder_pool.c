@@ -0,0 +1,223 @@
+/*****************************************************************************
+ * decoder_pool.c: Shared decoder threads
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_list.h>
+
+#include "decoder_pool.h"
+
+struct decoder_pool
+{
+    vlc_mutex_t lock;
+    vlc_cond_t  wait_task; /* signaled when a task is queued */
+    vlc_cond_t  wait_done; /* broadcast when a task returns */
+
+    struct vlc_list queue;
+    size_t i_queued;
+
+    vlc_thread_t *threads;
+    size_t i_threads;
+    size_t i_busy; /* threads running a task */
+    bool b_closing;
+
+    unsigned i_refs; /* protected by pool_lock */
+};
+
+static vlc_mutex_t pool_lock = VLC_STATIC_MUTEX;
+static decoder_pool_t *pool_instance = NULL;
+
+static void *Thread( void *data )
+{
+    decoder_pool_t *pool = data;
+
+    vlc_mutex_lock( &pool->lock );
+    for( ;; )
+    {
+        while( pool->i_queued == 0 && !pool->b_closing )
+            vlc_cond_wait( &pool->wait_task, &pool->lock );
+
+        if( pool->i_queued == 0 )
+            break;
+
+        struct decoder_pool_task *task =
+            vlc_list_first_entry_or_null( &pool->queue,
+                                          struct decoder_pool_task, node );
+        vlc_list_remove( &task->node );
+        pool->i_queued--;
+        task->b_queued = false;
+        task->b_running = true;
+        pool->i_busy++;
+        vlc_mutex_unlock( &pool->lock );
+
+        task->pf_run( task->opaque );
+
+        vlc_mutex_lock( &pool->lock );
+        pool->i_busy--;
+        task->b_running = false;
+        if( task->b_rerun )
+        {   /* Back of the queue, so that a busy task does not starve the
+             * others */
+            task->b_rerun = false;
+            task->b_queued = true;
+            vlc_list_append( &task->node, &pool->queue );
+            pool->i_queued++;
+        }
+        vlc_cond_broadcast( &pool->wait_done );
+    }
+    vlc_mutex_unlock( &pool->lock );
+    return NULL;
+}
+
+/* Spawns a thread, the pool must be locked */
+static int Spawn( decoder_pool_t *pool )
+{
+    vlc_thread_t *threads = realloc( pool->threads,
+                                (pool->i_threads + 1) * sizeof (*threads) );
+    if( unlikely(threads == NULL) )
+        return VLC_ENOMEM;
+    pool->threads = threads;
+
+    if( vlc_clone( &threads[pool->i_threads], Thread, pool,
+                   VLC_THREAD_PRIORITY_AUDIO ) )
+        return VLC_EGENERIC;
+    pool->i_threads++;
+    return VLC_SUCCESS;
+}
+
+static decoder_pool_t *Create( void )
+{
+    decoder_pool_t *pool = malloc( sizeof (*pool) );
+    if( unlikely(pool == NULL) )
+        return NULL;
+
+    vlc_mutex_init( &pool->lock );
+    vlc_cond_init( &pool->wait_task );
+    vlc_cond_init( &pool->wait_done );
+    vlc_list_init( &pool->queue );
+    pool->i_queued = 0;
+    pool->threads = NULL;
+    pool->i_threads = 0;
+    pool->i_busy = 0;
+    pool->b_closing = false;
+    pool->i_refs = 1;
+
+    if( Spawn( pool ) )
+    {
+        free( pool->threads );
+        vlc_cond_destroy( &pool->wait_done );
+        vlc_cond_destroy( &pool->wait_task );
+        vlc_mutex_destroy( &pool->lock );
+        free( pool );
+        return NULL;
+    }
+    return pool;
+}
+
+static void Destroy( decoder_pool_t *pool )
+{
+    vlc_mutex_lock( &pool->lock );
+    assert( pool->i_queued == 0 );
+    pool->b_closing = true;
+    vlc_cond_broadcast( &pool->wait_task );
+    vlc_mutex_unlock( &pool->lock );
+
+    /* No threads are spawned anymore: the tasks are all cancelled */
+    for( size_t i = 0; i < pool->i_threads; i++ )
+        vlc_join( pool->threads[i], NULL );
+
+    free( pool->threads );
+    vlc_cond_destroy( &pool->wait_done );
+    vlc_cond_destroy( &pool->wait_task );
+    vlc_mutex_destroy( &pool->lock );
+    free( pool );
+}
+
+decoder_pool_t *decoder_pool_Hold( void )
+{
+    decoder_pool_t *pool;
+
+    vlc_mutex_lock( &pool_lock );
+    pool = pool_instance;
+    if( pool != NULL )
+        pool->i_refs++;
+    else
+        pool = pool_instance = Create();
+    vlc_mutex_unlock( &pool_lock );
+    return pool;
+}
+
+void decoder_pool_Release( decoder_pool_t *pool )
+{
+    vlc_mutex_lock( &pool_lock );
+    assert( pool == pool_instance );
+    bool b_last = --pool->i_refs == 0;
+    if( b_last )
+        pool_instance = NULL;
+    vlc_mutex_unlock( &pool_lock );
+
+    if( b_last )
+        Destroy( pool );
+}
+
+void decoder_pool_Schedule( decoder_pool_t *pool,
+                            struct decoder_pool_task *task )
+{
+    vlc_mutex_lock( &pool->lock );
+    if( task->b_running )
+        task->b_rerun = true;
+    else if( !task->b_queued )
+    {
+        task->b_queued = true;
+        vlc_list_append( &task->node, &pool->queue );
+        pool->i_queued++;
+
+        /* Every free thread already has a task to run: add one. If that
+         * fails, the task waits for a busy thread. */
+        if( pool->i_threads - pool->i_busy < pool->i_queued )
+            Spawn( pool );
+        vlc_cond_signal( &pool->wait_task );
+    }
+    vlc_mutex_unlock( &pool->lock );
+}
+
+void decoder_pool_Cancel( decoder_pool_t *pool, struct decoder_pool_task *task )
+{
+    vlc_mutex_lock( &pool->lock );
+    for( ;; )
+    {
+        task->b_rerun = false;
+        if( task->b_queued )
+        {
+            vlc_list_remove( &task->node );
+            pool->i_queued--;
+            task->b_queued = false;
+        }
+        if( !task->b_running )
+            break;
+        vlc_cond_wait( &pool->wait_done, &pool->lock );
+    }
+    vlc_mutex_unlock( &pool->lock );
+}
@@ -0,0 +1,86 @@
+/*****************************************************************************
+ * decoder_pool.h: Shared decoder threads
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_INPUT_DECODER_POOL_H
+#define LIBVLC_INPUT_DECODER_POOL_H 1
+
+#include <vlc_common.h>
+#include <vlc_list.h>
+
+/**
+ * The decoder pool runs tasks on a set of threads shared by all the inputs.
+ *
+ * A task is run until it returns, and is never run by two threads at once.
+ * The pool spawns a thread whenever every other one is busy, so that a task
+ * may block (e.g. waiting for its output) without starving the others. The
+ * threads are joined when the last reference to the pool is released.
+ */
+typedef struct decoder_pool decoder_pool_t;
+
+struct decoder_pool_task
+{
+    void (*pf_run)( void *opaque );
+    void *opaque;
+
+    /* Private, protected by the pool lock */
+    struct vlc_list node;
+    bool b_queued;
+    bool b_running;
+    bool b_rerun;
+};
+
+static inline void decoder_pool_task_Init( struct decoder_pool_task *task,
+                                           void (*pf_run)( void * ),
+                                           void *opaque )
+{
+    task->pf_run = pf_run;
+    task->opaque = opaque;
+    task->b_queued = false;
+    task->b_running = false;
+    task->b_rerun = false;
+}
+
+/**
+ * Gets a reference to the shared pool, creating it if needed.
+ *
+ * \return the pool, or NULL if its first thread could not be spawned
+ */
+decoder_pool_t *decoder_pool_Hold( void ) VLC_USED;
+
+/**
+ * Releases a reference to the pool. The last one joins its threads, so it
+ * must not be released from a task.
+ */
+void decoder_pool_Release( decoder_pool_t * );
+
+/**
+ * Requests a run of the task. If the task is running, it is run once more
+ * after it returns.
+ */
+void decoder_pool_Schedule( decoder_pool_t *, struct decoder_pool_task * );
+
+/**
+ * Cancels the pending runs of the task and waits for the current one, if any,
+ * to return. The caller must make sure the task returns promptly and that it
+ * is not scheduled anymore.
+ */
+void decoder_pool_Cancel( decoder_pool_t *, struct decoder_pool_task * );
+
+#endif
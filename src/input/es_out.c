@@ -163,6 +163,7 @@ typedef struct
     vlc_tick_t  i_pts_jitter;
     int         i_cr_average;
     int         i_rate;
+    bool        b_keyframe_only;
 
     /* */
     bool        b_paused;
@@ -325,6 +326,7 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, int i_rate )
     p_sys->i_pause_date = -1;
 
     p_sys->i_rate = i_rate;
+    p_sys->b_keyframe_only = false;
 
     p_sys->b_buffering = true;
     p_sys->i_preroll_end = -1;
@@ -613,6 +615,18 @@ static void EsOutChangeRate( es_out_t *out, int i_rate )
             input_DecoderChangeRate( es->p_dec, rate );
 }
 
+static void EsOutSetKeyframeOnly( es_out_t *out, bool b_keyframe_only )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+    es_out_id_t *es;
+
+    p_sys->b_keyframe_only = b_keyframe_only;
+
+    foreach_es_then_es_slaves(es)
+        if( es->p_dec != NULL )
+            input_DecoderSetKeyframeOnly( es->p_dec, b_keyframe_only );
+}
+
 static void EsOutChangePosition( es_out_t *out )
 {
     es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
@@ -1673,6 +1687,7 @@ static void EsCreateDecoder( es_out_t *out, es_out_id_t *p_es )
         float rate = (float)p_sys->i_rate / (float)INPUT_RATE_DEFAULT;
 
         input_DecoderChangeRate( dec, rate );
+        input_DecoderSetKeyframeOnly( dec, p_sys->b_keyframe_only );
 
         if( p_sys->b_buffering )
             input_DecoderStartWait( dec );
@@ -2814,6 +2829,10 @@ static int EsOutVaControlLocked( es_out_t *out, int i_query, va_list args )
         return VLC_SUCCESS;
     }
 
+    case ES_OUT_SET_KEYFRAME_ONLY:
+        EsOutSetKeyframeOnly( out, va_arg( args, int ) );
+        return VLC_SUCCESS;
+
     case ES_OUT_SET_FRAME_NEXT:
         EsOutFrameNext( out );
         return VLC_SUCCESS;
@@ -71,6 +71,9 @@ enum es_out_query_private_e
     /* Set rate */
     ES_OUT_SET_RATE,                                /* arg1=int i_source_rate arg2=int i_rate                  res=can fail */
 
+    /* Set keyframe only decoding */
+    ES_OUT_SET_KEYFRAME_ONLY,                       /* arg1=bool                res=cannot fail */
+
     /* Set next frame */
     ES_OUT_SET_FRAME_NEXT,                          /*                          res=can fail */
 
@@ -133,6 +136,11 @@ static inline int es_out_SetRate( es_out_t *p_out, int i_source_rate, int i_rate
 {
     return es_out_Control( p_out, ES_OUT_SET_RATE, i_source_rate, i_rate );
 }
+static inline void es_out_SetKeyframeOnly( es_out_t *p_out, bool b_keyframe_only )
+{
+    int i_ret = es_out_Control( p_out, ES_OUT_SET_KEYFRAME_ONLY, b_keyframe_only );
+    assert( !i_ret );
+}
 static inline int es_out_SetFrameNext( es_out_t *p_out )
 {
     return es_out_Control( p_out, ES_OUT_SET_FRAME_NEXT );
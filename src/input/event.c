@@ -297,3 +297,20 @@ void input_SendEventParsing( input_thread_t *p_input, input_item_node_t *p_root
         .subitems = p_root,
     });
 }
+
+void input_SendEventThumbnailReady( input_thread_t *p_input, picture_t *p_pic )
+{
+    input_SendEvent( p_input, &(struct vlc_input_event) {
+        .type = INPUT_EVENT_THUMBNAIL_READY,
+        .thumbnail = p_pic,
+    });
+}
+
+void input_SendEventLoudnessReady( input_thread_t *p_input,
+                                   const struct vlc_loudness_report *report )
+{
+    input_SendEvent( p_input, &(struct vlc_input_event) {
+        .type = INPUT_EVENT_LOUDNESS_READY,
+        .loudness = report,
+    });
+}
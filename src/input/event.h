@@ -50,6 +50,9 @@ void input_SendEventMetaInfo( input_thread_t *p_input );
 void input_SendEventMetaEpg( input_thread_t *p_input );
 
 void input_SendEventParsing( input_thread_t *p_input, input_item_node_t *p_root );
+void input_SendEventThumbnailReady( input_thread_t *p_input, picture_t *p_pic );
+void input_SendEventLoudnessReady( input_thread_t *p_input,
+                                   const struct vlc_loudness_report *report );
 
 /*****************************************************************************
  * Event for es_out.c
@@ -63,7 +63,7 @@ static  void *Run( void * );
 static  void *Preparse( void * );
 
 static input_thread_t * Create  ( vlc_object_t *, input_thread_events_cb, void *,
-                                  input_item_t *, const char *, bool,
+                                  input_item_t *, const char *, bool, bool, bool,
                                   input_resource_t *, vlc_renderer_item_t * );
 static  int             Init    ( input_thread_t *p_input );
 static void             End     ( input_thread_t *p_input );
@@ -132,7 +132,7 @@ input_thread_t *input_Create( vlc_object_t *p_parent,
                               vlc_renderer_item_t *p_renderer )
 {
     return Create( p_parent, events_cb, events_data, p_item, psz_log, false,
-                   p_resource, p_renderer );
+                   false, false, p_resource, p_renderer );
 }
 
 #undef input_Read
@@ -147,7 +147,7 @@ int input_Read( vlc_object_t *p_parent, input_item_t *p_item,
                 input_thread_events_cb events_cb, void *events_data )
 {
     input_thread_t *p_input = Create( p_parent, events_cb, events_data, p_item,
-                                      NULL, false, NULL, NULL );
+                                      NULL, false, false, false, NULL, NULL );
     if( !p_input )
         return VLC_EGENERIC;
 
@@ -165,7 +165,25 @@ input_thread_t *input_CreatePreparser( vlc_object_t *parent,
                                        input_thread_events_cb events_cb,
                                        void *events_data, input_item_t *item )
 {
-    return Create( parent, events_cb, events_data, item, NULL, true, NULL, NULL );
+    return Create( parent, events_cb, events_data, item, NULL, true, false,
+                   false, NULL, NULL );
+}
+
+input_thread_t *input_CreateThumbnailer( vlc_object_t *parent,
+                                         input_thread_events_cb events_cb,
+                                         void *events_data, input_item_t *item )
+{
+    return Create( parent, events_cb, events_data, item, NULL, false, true,
+                   false, NULL, NULL );
+}
+
+input_thread_t *input_CreateLoudnessScanner( vlc_object_t *parent,
+                                             input_thread_events_cb events_cb,
+                                             void *events_data,
+                                             input_item_t *item )
+{
+    return Create( parent, events_cb, events_data, item, NULL, false, false,
+                   true, NULL, NULL );
 }
 
 /**
@@ -309,7 +327,8 @@ input_item_t *input_GetItem( input_thread_t *p_input )
 static input_thread_t *Create( vlc_object_t *p_parent,
                                input_thread_events_cb events_cb, void *events_data,
                                input_item_t *p_item, const char *psz_header,
-                               bool b_preparsing, input_resource_t *p_resource,
+                               bool b_preparsing, bool b_thumbnailing,
+                               bool b_scanning, input_resource_t *p_resource,
                                vlc_renderer_item_t *p_renderer )
 {
     /* Allocate descriptor */
@@ -323,7 +342,9 @@ static input_thread_t *Create( vlc_object_t *p_parent,
 
     char * psz_name = input_item_GetName( p_item );
     msg_Dbg( p_input, "Creating an input for %s'%s'",
-             b_preparsing ? "preparsing " : "", psz_name);
+             b_preparsing ? "preparsing " :
+             b_thumbnailing ? "thumbnailing " :
+             b_scanning ? "loudness scanning " : "", psz_name);
     free( psz_name );
 
     /* Parse input options */
@@ -335,6 +356,8 @@ static input_thread_t *Create( vlc_object_t *p_parent,
     priv->events_cb = events_cb;
     priv->events_data = events_data;
     priv->b_preparsing = b_preparsing;
+    priv->b_thumbnailing = b_thumbnailing;
+    priv->b_scanning = b_scanning;
     priv->b_can_pace_control = true;
     priv->i_start = 0;
     priv->i_time  = 0;
@@ -347,13 +370,16 @@ static input_thread_t *Create( vlc_object_t *p_parent,
     priv->is_stopped = false;
     priv->b_recording = false;
     priv->i_rate = INPUT_RATE_DEFAULT;
+    priv->b_keyframe_only = false;
     memset( &priv->bookmark, 0, sizeof(priv->bookmark) );
     TAB_INIT( priv->i_bookmark, priv->pp_bookmark );
     TAB_INIT( priv->i_attachment, priv->attachment );
     priv->attachment_demux = NULL;
     priv->p_sout   = NULL;
-    priv->b_out_pace_control = false;
-    priv->p_renderer = p_renderer && b_preparsing == false ?
+    /* A scanner decodes as fast as possible, not at the pace of the clock */
+    priv->b_out_pace_control = b_scanning;
+    priv->p_renderer = p_renderer && !b_preparsing && !b_thumbnailing
+                    && !b_scanning ?
                 vlc_renderer_item_hold( p_renderer ) : NULL;
 
     priv->viewpoint_changed = false;
@@ -378,7 +404,7 @@ static input_thread_t *Create( vlc_object_t *p_parent,
 
     /* setup the preparse depth of the item
      * if we are preparsing, use the i_preparse_depth of the parent item */
-    if( !priv->b_preparsing )
+    if( !priv->b_preparsing && !priv->b_thumbnailing && !priv->b_scanning )
     {
         char *psz_rec = var_InheritString( p_parent, "recursive" );
 
@@ -436,8 +462,39 @@ static input_thread_t *Create( vlc_object_t *p_parent,
     /* Create Object Variables for private use only */
     input_ConfigVarInit( p_input );
 
+    if( priv->b_thumbnailing )
+    {
+        /* Only decode the video track, and hand the pictures to the owner */
+        var_SetBool( p_input, "video", true );
+        var_SetBool( p_input, "audio", false );
+        var_SetBool( p_input, "spu", false );
+        var_SetString( p_input, "sout", "" );
+        var_SetString( p_input, "input-slave", "" );
+        var_SetBool( p_input, "sub-autodetect-file", false );
+        var_SetInteger( p_input, "input-repeat", 0 );
+        /* Without a video output, there is nowhere to get hardware
+         * surfaces from */
+        var_Create( p_input, "avcodec-hw", VLC_VAR_STRING );
+        var_SetString( p_input, "avcodec-hw", "none" );
+    }
+    else if( priv->b_scanning )
+    {
+        /* Only decode the audio track, and measure the samples */
+        var_SetBool( p_input, "video", false );
+        var_SetBool( p_input, "audio", true );
+        var_SetBool( p_input, "spu", false );
+        var_SetString( p_input, "sout", "" );
+        var_SetString( p_input, "input-slave", "" );
+        var_SetBool( p_input, "sub-autodetect-file", false );
+        var_SetInteger( p_input, "input-repeat", 0 );
+        /* Measure the samples as decoded, regardless of the filters the
+         * user may have set */
+        var_Create( p_input, "audio-time-stretch", VLC_VAR_BOOL );
+        var_Create( p_input, "audio-filter", VLC_VAR_STRING );
+    }
+
     /* */
-    if( !priv->b_preparsing )
+    if( !priv->b_preparsing && !priv->b_thumbnailing && !priv->b_scanning )
     {
         char *psz_bookmarks = var_GetNonEmptyString( p_input, "bookmarks" );
         if( psz_bookmarks )
@@ -494,7 +551,8 @@ static input_thread_t *Create( vlc_object_t *p_parent,
     input_item_SetESNowPlaying( p_item, NULL );
 
     /* */
-    if( !priv->b_preparsing && var_InheritBool( p_input, "stats" ) )
+    if( !priv->b_preparsing && !priv->b_thumbnailing && !priv->b_scanning
+     && var_InheritBool( p_input, "stats" ) )
         priv->stats = input_stats_Create();
     else
         priv->stats = NULL;
@@ -529,7 +587,8 @@ static void *Run( void *data )
             vlc_set_priority( priv->thread, VLC_THREAD_PRIORITY_LOW );
         }
 
-        MainLoop( p_input, true ); /* FIXME it can be wrong (like with VLM) */
+        /* FIXME it can be wrong (like with VLM) */
+        MainLoop( p_input, !priv->b_thumbnailing && !priv->b_scanning );
 
         /* Clean up */
         End( p_input );
@@ -725,6 +784,17 @@ static void MainLoop( input_thread_t *p_input, bool b_interactive )
     demux_t *p_demux = input_priv(p_input)->master->p_demux;
     const bool b_can_demux = p_demux->pf_demux != NULL;
 
+    /* A thumbnailer must seek before anything gets demuxed, otherwise the
+     * first picture of the media would be reported as the thumbnail */
+    if( input_priv(p_input)->b_thumbnailing )
+    {
+        int i_type;
+        input_control_param_t param;
+
+        while( !ControlPop( p_input, &i_type, &param, 0, false ) )
+            Control( p_input, i_type, param );
+    }
+
     while( !input_Stopped( p_input ) && input_priv(p_input)->i_state != ERROR_S )
     {
         vlc_tick_t i_wakeup = -1;
@@ -840,7 +910,7 @@ static int InitSout( input_thread_t * p_input )
 {
     input_thread_private_t *priv = input_priv(p_input);
 
-    if( priv->b_preparsing )
+    if( priv->b_preparsing || priv->b_thumbnailing || priv->b_scanning )
         return VLC_SUCCESS;
 
     /* Find a usable sout and attach it to p_input */
@@ -2022,6 +2092,21 @@ static bool Control( input_thread_t *p_input,
 
                 b_force_update = true;
             }
+
+            /* Fast forward only keeps up if the other frames are skipped */
+            float f_keyframe_rate = var_InheritFloat( p_input, "rate-keyframe-only" );
+            bool b_keyframe_only = f_keyframe_rate > 0.f &&
+                (float)INPUT_RATE_DEFAULT / abs( input_priv(p_input)->i_rate ) >= f_keyframe_rate;
+            if( b_keyframe_only != input_priv(p_input)->b_keyframe_only )
+            {
+                msg_Dbg( p_input, "%s keyframe only decoding",
+                         b_keyframe_only ? "starting" : "stopping" );
+                input_priv(p_input)->b_keyframe_only = b_keyframe_only;
+                demux_Control( input_priv(p_input)->master->p_demux,
+                               DEMUX_SET_KEYFRAME_ONLY, b_keyframe_only );
+                es_out_SetKeyframeOnly( input_priv(p_input)->p_es_out,
+                                        b_keyframe_only );
+            }
             break;
         }
 
@@ -108,6 +108,8 @@ typedef struct input_thread_private_t
 
     /* Global properties */
     bool        b_preparsing;
+    bool        b_thumbnailing;
+    bool        b_scanning;
     bool        b_can_pause;
     bool        b_can_rate_control;
     bool        b_can_pace_control;
@@ -118,6 +120,7 @@ typedef struct input_thread_private_t
     bool        is_stopped;
     bool        b_recording;
     int         i_rate;
+    bool        b_keyframe_only;
 
     /* Playtime configuration and state */
     vlc_tick_t  i_start;    /* :start-time,0 by default */
@@ -261,6 +264,29 @@ static inline void input_ControlPushHelper( input_thread_t *p_input, int i_type,
 
 bool input_Stopped( input_thread_t * );
 
+/**
+ * Creates a thumbnailing input.
+ *
+ * Only the video track is decoded, without any output. Decoded pictures are
+ * reported through INPUT_EVENT_THUMBNAIL_READY, one after each seek. Seek
+ * requests issued before input_Start() are handled before demuxing starts.
+ */
+input_thread_t *input_CreateThumbnailer( vlc_object_t *parent,
+                                         input_thread_events_cb events_cb,
+                                         void *events_data, input_item_t *item );
+
+/**
+ * Creates a loudness scanning input.
+ *
+ * Only the audio track is decoded, without any output and as fast as
+ * possible. The loudness of the whole track is reported through
+ * INPUT_EVENT_LOUDNESS_READY, once the decoder is deleted.
+ */
+input_thread_t *input_CreateLoudnessScanner( vlc_object_t *parent,
+                                             input_thread_events_cb events_cb,
+                                             void *events_data,
+                                             input_item_t *item );
+
 /* Bound pts_delay */
 #define INPUT_PTS_DELAY_MAX VLC_TICK_FROM_SEC(60)
 
@@ -309,6 +335,7 @@ struct input_stats {
     atomic_uintmax_t decoded_video;
     atomic_uintmax_t played_abuffers;
     atomic_uintmax_t lost_abuffers;
+    atomic_uintmax_t audio_underruns;
     atomic_uintmax_t displayed_pictures;
     atomic_uintmax_t lost_pictures;
 };
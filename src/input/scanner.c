@@ -0,0 +1,325 @@
+/*****************************************************************************
+ * scanner.c: Loudness scanning API
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <limits.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_charset.h>
+#include <vlc_cpu.h>
+#include <vlc_loudness.h>
+#include <vlc_meta.h>
+#include "input_internal.h"
+#include "misc/background_worker.h"
+
+struct vlc_loudness_scanner
+{
+    vlc_object_t* parent;
+    struct background_worker* worker;
+};
+
+struct vlc_loudness_request
+{
+    vlc_loudness_scanner_t *scanner;
+    input_item_t *input_item;
+    input_thread_t *input_thread;
+    vlc_atomic_rc_t rc;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait_cb;
+    /* Set to NULL once the request is being destroyed */
+    vlc_loudness_scanner_cb cb;
+    void* userdata;
+    /* Callbacks running, that the destruction waits for */
+    unsigned running_cbs;
+    /* Measurements of the last audio decoder */
+    struct vlc_loudness_report report;
+    bool b_measured;
+    bool b_error;
+    bool done;
+};
+
+static void scanner_request_Hold( void* data )
+{
+    vlc_loudness_request_t *request = data;
+    vlc_atomic_rc_inc( &request->rc );
+}
+
+static void scanner_request_Release( void* data )
+{
+    vlc_loudness_request_t *request = data;
+    if( !vlc_atomic_rc_dec( &request->rc ) )
+        return;
+
+    assert( request->input_thread == NULL );
+    input_item_Release( request->input_item );
+    vlc_cond_destroy( &request->wait_cb );
+    vlc_mutex_destroy( &request->lock );
+    free( request );
+}
+
+/* Stores the ReplayGain 2.0 values as extra metadata */
+static void scanner_request_SetMeta( vlc_loudness_request_t *request )
+{
+    const struct vlc_loudness_report *report = &request->report;
+    input_item_t *item = request->input_item;
+    char *gain, *peak;
+
+    if( us_asprintf( &gain, "%.2f dB", VLC_LOUDNESS_REPLAYGAIN_REFERENCE
+                                       - report->integrated ) < 0 )
+        return;
+    if( us_asprintf( &peak, "%.6f", pow( 10., report->true_peak / 20. ) ) < 0 )
+    {
+        free( gain );
+        return;
+    }
+
+    vlc_mutex_lock( &item->lock );
+    if( item->p_meta == NULL )
+        item->p_meta = vlc_meta_New();
+    if( item->p_meta != NULL )
+    {
+        vlc_meta_AddExtra( item->p_meta, "REPLAYGAIN_TRACK_GAIN", gain );
+        vlc_meta_AddExtra( item->p_meta, "REPLAYGAIN_TRACK_PEAK", peak );
+    }
+    vlc_mutex_unlock( &item->lock );
+
+    free( gain );
+    free( peak );
+}
+
+/* Invokes the callback with the lock released, so that it may call the
+ * scanner back */
+static void scanner_request_FinishLocked( vlc_loudness_request_t *request,
+                                          bool b_success )
+{
+    vlc_assert_locked( &request->lock );
+
+    /* Done before reporting, as the lock is released meanwhile */
+    request->done = true;
+
+    vlc_loudness_scanner_cb cb = request->cb;
+    if( cb == NULL )
+        return;
+
+    request->running_cbs++;
+    vlc_mutex_unlock( &request->lock );
+    cb( request->userdata, b_success ? &request->report : NULL );
+    vlc_mutex_lock( &request->lock );
+    if( --request->running_cbs == 0 )
+        vlc_cond_broadcast( &request->wait_cb );
+}
+
+static void on_scanner_input_event( input_thread_t *input, void *userdata,
+                                    const struct vlc_input_event *event )
+{
+    VLC_UNUSED(input);
+    if( event->type != INPUT_EVENT_LOUDNESS_READY &&
+        event->type != INPUT_EVENT_DEAD &&
+        ( event->type != INPUT_EVENT_STATE || event->state != ERROR_S ) )
+         return;
+
+    vlc_loudness_request_t* request = userdata;
+
+    vlc_mutex_lock( &request->lock );
+    if( request->done )
+    {
+        vlc_mutex_unlock( &request->lock );
+        return;
+    }
+
+    switch( event->type )
+    {
+        case INPUT_EVENT_STATE:
+            request->b_error = true;
+            break;
+        case INPUT_EVENT_LOUDNESS_READY:
+            /* The decoders are deleted once the input ended */
+            request->report = *event->loudness;
+            request->b_measured = true;
+            break;
+        case INPUT_EVENT_DEAD:
+        {
+            /* Silence cannot be gained */
+            bool b_success = !request->b_error && request->b_measured
+                          && isfinite( request->report.integrated );
+            if( b_success )
+                scanner_request_SetMeta( request );
+            scanner_request_FinishLocked( request, b_success );
+            break;
+        }
+        default:
+            vlc_assert_unreachable();
+    }
+
+    bool done = request->done;
+    vlc_mutex_unlock( &request->lock );
+
+    if( done )
+        background_worker_RequestProbe( request->scanner->worker );
+}
+
+static int scanner_request_Start( void* owner, void* entity, void** out )
+{
+    vlc_loudness_scanner_t* scanner = owner;
+    vlc_loudness_request_t* request = entity;
+    input_thread_t* input = request->input_thread =
+            input_CreateLoudnessScanner( scanner->parent,
+                                         on_scanner_input_event, request,
+                                         request->input_item );
+    if( unlikely( input == NULL ) )
+        goto error;
+
+    if( input_Start( input ) != VLC_SUCCESS )
+    {
+        input_Close( input );
+        request->input_thread = NULL;
+        goto error;
+    }
+    *out = request;
+    return VLC_SUCCESS;
+
+error:
+    vlc_mutex_lock( &request->lock );
+    scanner_request_FinishLocked( request, false );
+    vlc_mutex_unlock( &request->lock );
+    return VLC_EGENERIC;
+}
+
+static int scanner_request_Probe( void* owner, void* handle )
+{
+    VLC_UNUSED(owner);
+    vlc_loudness_request_t* request = handle;
+
+    vlc_mutex_lock( &request->lock );
+    bool done = request->done;
+    vlc_mutex_unlock( &request->lock );
+    return done;
+}
+
+static void scanner_request_Stop( void* owner, void* handle )
+{
+    VLC_UNUSED(owner);
+    vlc_loudness_request_t* request = handle;
+
+    /* Timed out or cancelled: partial measurements are not reported */
+    vlc_mutex_lock( &request->lock );
+    if( !request->done )
+        scanner_request_FinishLocked( request, false );
+    vlc_mutex_unlock( &request->lock );
+
+    assert( request->input_thread != NULL );
+    input_Stop( request->input_thread );
+    input_Close( request->input_thread );
+    request->input_thread = NULL;
+}
+
+vlc_loudness_request_t*
+vlc_loudness_scanner_Request( vlc_loudness_scanner_t *scanner,
+                              input_item_t *input_item, vlc_tick_t timeout,
+                              vlc_loudness_scanner_cb cb, void* userdata )
+{
+    vlc_loudness_request_t *request = malloc( sizeof( *request ) );
+    if( unlikely( request == NULL ) )
+        return NULL;
+
+    request->scanner = scanner;
+    request->input_item = input_item_Hold( input_item );
+    request->input_thread = NULL;
+    request->cb = cb;
+    request->userdata = userdata;
+    request->running_cbs = 0;
+    request->b_measured = false;
+    request->b_error = false;
+    request->done = false;
+    vlc_atomic_rc_init( &request->rc );
+    vlc_mutex_init( &request->lock );
+    vlc_cond_init( &request->wait_cb );
+
+    int i_timeout = -1;
+    if( timeout != VLC_TICK_INVALID )
+    {
+        int64_t i_ms = MS_FROM_VLC_TICK( timeout );
+        i_timeout = i_ms < 0 ? 0 : i_ms > INT_MAX ? INT_MAX : (int)i_ms;
+    }
+
+    if( background_worker_Push( scanner->worker, request, request,
+                                i_timeout ) != VLC_SUCCESS )
+    {
+        scanner_request_Release( request );
+        return NULL;
+    }
+    return request;
+}
+
+void vlc_loudness_scanner_DestroyRequest( vlc_loudness_scanner_t* scanner,
+                                          vlc_loudness_request_t* request )
+{
+    /* Ensure we won't invoke the callback if the input is running */
+    vlc_mutex_lock( &request->lock );
+    request->cb = NULL;
+    while( request->running_cbs > 0 )
+        vlc_cond_wait( &request->wait_cb, &request->lock );
+    vlc_mutex_unlock( &request->lock );
+
+    background_worker_Cancel( scanner->worker, request );
+    scanner_request_Release( request );
+}
+
+vlc_loudness_scanner_t *vlc_loudness_scanner_Create( vlc_object_t* parent )
+{
+    vlc_loudness_scanner_t *scanner = malloc( sizeof( *scanner ) );
+    if( unlikely( scanner == NULL ) )
+        return NULL;
+
+    int threads = var_InheritInteger( parent, "loudness-threads" );
+    if( threads <= 0 )
+        threads = vlc_GetCPUCount();
+
+    struct background_worker_config cfg = {
+        .default_timeout = -1,
+        .max_threads = threads,
+        .pf_release = scanner_request_Release,
+        .pf_hold = scanner_request_Hold,
+        .pf_start = scanner_request_Start,
+        .pf_probe = scanner_request_Probe,
+        .pf_stop = scanner_request_Stop,
+    };
+    scanner->worker = background_worker_New( scanner, &cfg );
+    if( unlikely( scanner->worker == NULL ) )
+    {
+        free( scanner );
+        return NULL;
+    }
+    scanner->parent = parent;
+    return scanner;
+}
+
+void vlc_loudness_scanner_Release( vlc_loudness_scanner_t *scanner )
+{
+    background_worker_Delete( scanner->worker );
+    free( scanner );
+}
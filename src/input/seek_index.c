@@ -0,0 +1,412 @@
+/*****************************************************************************
+ * seek_index.c: Persistent seek index for demuxers
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <dirent.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_fs.h>
+#include <vlc_md5.h>
+#include <vlc_seek_index.h>
+
+/* Cache file: the magic, the big endian count of points, then the big
+ * endian time and offset of each point */
+#define SEEK_INDEX_MAGIC "VLCSIDX1"
+#define SEEK_INDEX_MAGIC_SIZE 8
+#define SEEK_INDEX_POINT_SIZE 16
+#define SEEK_INDEX_MAX_POINTS (1 << 20)
+
+/* Minimum time between two points */
+#define SEEK_INDEX_INTERVAL VLC_TICK_FROM_SEC(1)
+
+/* Bytes of the source identifying it along with its size */
+#define SEEK_INDEX_HEAD_SIZE 65536
+
+/* Cache files kept, the least recently saved ones are deleted beyond */
+#define SEEK_INDEX_MAX_FILES 256
+
+struct vlc_seek_index_point
+{
+    vlc_tick_t time;
+    uint64_t offset;
+};
+
+struct vlc_seek_index
+{
+    vlc_object_t *obj;
+    char *path; /* cache file */
+    struct vlc_seek_index_point *points;
+    size_t count;
+    size_t size;
+    bool modified;
+};
+
+static char *GetCacheDir(void)
+{
+    char *cachedir = config_GetUserDir(VLC_CACHE_DIR);
+    char *dir;
+
+    if (cachedir == NULL)
+        return NULL;
+    if (asprintf(&dir, "%s" DIR_SEP "seekindex", cachedir) == -1)
+        dir = NULL;
+    free(cachedir);
+    return dir;
+}
+
+/* Identifies the source by its size, modification time and first bytes */
+static char *GetCachePath(demux_t *demux, const char *format)
+{
+    stream_t *s = demux->s;
+    uint64_t size;
+    uint8_t buf[8];
+    struct md5_s md5;
+
+    if (vlc_stream_GetSize(s, &size) || size == 0)
+        return NULL;
+
+    InitMD5(&md5);
+    AddMD5(&md5, format, strlen(format) + 1);
+    SetQWBE(buf, size);
+    AddMD5(&md5, buf, sizeof (buf));
+
+    struct stat st;
+    if (demux->psz_filepath != NULL && vlc_stat(demux->psz_filepath, &st) == 0)
+    {
+        SetQWBE(buf, st.st_mtime);
+        AddMD5(&md5, buf, sizeof (buf));
+    }
+
+    uint64_t pos = vlc_stream_Tell(s);
+    const uint8_t *peek;
+    ssize_t len;
+
+    if (pos != 0 && vlc_stream_Seek(s, 0))
+        return NULL;
+    len = vlc_stream_Peek(s, &peek, SEEK_INDEX_HEAD_SIZE);
+    if (len > 0)
+        AddMD5(&md5, peek, len);
+    if (pos != 0 && vlc_stream_Seek(s, pos))
+        return NULL;
+    if (len <= 0)
+        return NULL;
+    EndMD5(&md5);
+
+    char *dir = GetCacheDir();
+    char *hash = psz_md5_hash(&md5);
+    char *path;
+
+    if (dir == NULL || hash == NULL
+     || asprintf(&path, "%s" DIR_SEP "%s", dir, hash) == -1)
+        path = NULL;
+    free(hash);
+    free(dir);
+    return path;
+}
+
+static void Load(vlc_seek_index_t *index)
+{
+    FILE *file = vlc_fopen(index->path, "rb");
+    if (file == NULL)
+        return;
+
+    uint8_t header[SEEK_INDEX_MAGIC_SIZE + 4];
+    if (fread(header, sizeof (header), 1, file) != 1
+     || memcmp(header, SEEK_INDEX_MAGIC, SEEK_INDEX_MAGIC_SIZE))
+        goto error;
+
+    uint32_t count = GetDWBE(&header[SEEK_INDEX_MAGIC_SIZE]);
+    if (count == 0 || count > SEEK_INDEX_MAX_POINTS)
+        goto error;
+
+    index->points = vlc_alloc(count, sizeof (*index->points));
+    if (unlikely(index->points == NULL))
+        goto error;
+    index->size = count;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t buf[SEEK_INDEX_POINT_SIZE];
+        if (fread(buf, sizeof (buf), 1, file) != 1)
+            goto error;
+
+        struct vlc_seek_index_point *point = &index->points[i];
+        point->time = (int64_t)GetQWBE(buf);
+        point->offset = GetQWBE(&buf[8]);
+
+        /* Sorted by time and offset, as recorded */
+        if (i > 0 && (point->time <= point[-1].time
+                   || point->offset <= point[-1].offset))
+            goto error;
+    }
+    index->count = count;
+    fclose(file);
+
+    msg_Dbg(index->obj, "loaded %zu seek points from %s", index->count,
+            index->path);
+    return;
+
+error:
+    msg_Warn(index->obj, "ignoring invalid seek index %s", index->path);
+    index->count = 0;
+    fclose(file);
+}
+
+struct cache_file
+{
+    char *path;
+    time_t mtime;
+};
+
+static int CompareFiles(const void *a, const void *b)
+{
+    const struct cache_file *fa = a, *fb = b;
+
+    return (fa->mtime > fb->mtime) - (fa->mtime < fb->mtime);
+}
+
+/* Deletes the oldest files of the cache directory beyond the maximum */
+static void Prune(vlc_object_t *obj, const char *dir)
+{
+    DIR *dh = vlc_opendir(dir);
+    if (dh == NULL)
+        return;
+
+    struct cache_file *files = NULL;
+    size_t count = 0, size = 0;
+    const char *name;
+
+    while ((name = vlc_readdir(dh)) != NULL)
+    {
+        struct stat st;
+        char *path;
+
+        if (name[0] == '.')
+            continue;
+        if (asprintf(&path, "%s" DIR_SEP "%s", dir, name) == -1)
+            break;
+        if (vlc_stat(path, &st) || !S_ISREG(st.st_mode))
+        {
+            free(path);
+            continue;
+        }
+
+        if (count == size)
+        {
+            size_t newsize = size ? size * 2 : 64;
+            struct cache_file *newfiles =
+                realloc(files, newsize * sizeof (*files));
+            if (unlikely(newfiles == NULL))
+            {
+                free(path);
+                break;
+            }
+            files = newfiles;
+            size = newsize;
+        }
+        files[count].path = path;
+        files[count].mtime = st.st_mtime;
+        count++;
+    }
+    closedir(dh);
+
+    if (count > SEEK_INDEX_MAX_FILES)
+    {
+        qsort(files, count, sizeof (*files), CompareFiles);
+        for (size_t i = 0; i < count - SEEK_INDEX_MAX_FILES; i++)
+        {
+            msg_Dbg(obj, "deleting old seek index %s", files[i].path);
+            vlc_unlink(files[i].path);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+        free(files[i].path);
+    free(files);
+}
+
+static void Save(vlc_seek_index_t *index)
+{
+    char *dir = GetCacheDir();
+    char *tmp;
+
+    if (dir == NULL)
+        return;
+    /* The cache directory itself may not exist yet */
+    char *sep = strrchr(dir, DIR_SEP_CHAR);
+    *sep = '\0';
+    vlc_mkdir(dir, 0700);
+    *sep = DIR_SEP_CHAR;
+    vlc_mkdir(dir, 0700);
+
+    if (asprintf(&tmp, "%s.tmp", index->path) == -1)
+    {
+        free(dir);
+        return;
+    }
+
+    FILE *file = vlc_fopen(tmp, "wb");
+    if (file == NULL)
+        goto error;
+
+    uint8_t header[SEEK_INDEX_MAGIC_SIZE + 4];
+    memcpy(header, SEEK_INDEX_MAGIC, SEEK_INDEX_MAGIC_SIZE);
+    SetDWBE(&header[SEEK_INDEX_MAGIC_SIZE], index->count);
+    bool ok = fwrite(header, sizeof (header), 1, file) == 1;
+
+    for (size_t i = 0; ok && i < index->count; i++)
+    {
+        uint8_t buf[SEEK_INDEX_POINT_SIZE];
+        SetQWBE(buf, index->points[i].time);
+        SetQWBE(&buf[8], index->points[i].offset);
+        ok = fwrite(buf, sizeof (buf), 1, file) == 1;
+    }
+
+    if (fclose(file) || !ok || vlc_rename(tmp, index->path))
+    {
+        vlc_unlink(tmp);
+        goto error;
+    }
+    free(tmp);
+
+    msg_Dbg(index->obj, "saved %zu seek points to %s", index->count,
+            index->path);
+    Prune(index->obj, dir);
+    free(dir);
+    return;
+
+error:
+    msg_Warn(index->obj, "cannot save seek index %s: %s", index->path,
+             vlc_strerror_c(errno));
+    free(tmp);
+    free(dir);
+}
+
+vlc_seek_index_t *vlc_seek_index_New(demux_t *demux, const char *format)
+{
+    bool can_seek;
+
+    if (demux->b_preparsing || !var_InheritBool(demux, "input-seek-index")
+     || vlc_stream_Control(demux->s, STREAM_CAN_SEEK, &can_seek) || !can_seek)
+        return NULL;
+
+    vlc_seek_index_t *index = malloc(sizeof (*index));
+    if (unlikely(index == NULL))
+        return NULL;
+
+    index->obj = VLC_OBJECT(demux);
+    index->points = NULL;
+    index->count = 0;
+    index->size = 0;
+    index->modified = false;
+    index->path = GetCachePath(demux, format);
+    if (index->path == NULL)
+    {
+        free(index);
+        return NULL;
+    }
+
+    Load(index);
+    return index;
+}
+
+void vlc_seek_index_Delete(vlc_seek_index_t *index)
+{
+    if (index->modified)
+        Save(index);
+    free(index->points);
+    free(index->path);
+    free(index);
+}
+
+/* Index of the first point after the time */
+static size_t UpperBound(const vlc_seek_index_t *index, vlc_tick_t time)
+{
+    size_t low = 0, high = index->count;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (index->points[mid].time <= time)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+void vlc_seek_index_Add(vlc_seek_index_t *index, vlc_tick_t time,
+                        uint64_t offset)
+{
+    size_t i = UpperBound(index, time);
+    const struct vlc_seek_index_point *prev = i > 0 ? &index->points[i - 1]
+                                                    : NULL;
+    const struct vlc_seek_index_point *next = i < index->count
+                                            ? &index->points[i] : NULL;
+
+    if ((prev != NULL && (time - prev->time < SEEK_INDEX_INTERVAL
+                       || offset <= prev->offset))
+     || (next != NULL && (next->time - time < SEEK_INDEX_INTERVAL
+                       || offset >= next->offset)))
+        return;
+
+    if (index->count == index->size)
+    {
+        if (index->size >= SEEK_INDEX_MAX_POINTS)
+            return;
+
+        size_t size = index->size ? index->size * 2 : 256;
+        struct vlc_seek_index_point *points =
+            realloc(index->points, size * sizeof (*points));
+        if (unlikely(points == NULL))
+            return;
+        index->points = points;
+        index->size = size;
+    }
+
+    memmove(&index->points[i + 1], &index->points[i],
+            (index->count - i) * sizeof (*index->points));
+    index->points[i].time = time;
+    index->points[i].offset = offset;
+    index->count++;
+    index->modified = true;
+}
+
+bool vlc_seek_index_Lookup(const vlc_seek_index_t *index, vlc_tick_t time,
+                           vlc_tick_t *point_time, uint64_t *offset)
+{
+    size_t i = UpperBound(index, time);
+
+    if (i == 0)
+        return false;
+
+    *point_time = index->points[i - 1].time;
+    *offset = index->points[i - 1].offset;
+    return true;
+}
@@ -66,6 +66,7 @@ struct input_stats *input_stats_Create(void)
     atomic_init(&stats->decoded_video, 0);
     atomic_init(&stats->played_abuffers, 0);
     atomic_init(&stats->lost_abuffers, 0);
+    atomic_init(&stats->audio_underruns, 0);
     atomic_init(&stats->displayed_pictures, 0);
     atomic_init(&stats->lost_pictures, 0);
     return stats;
@@ -103,6 +104,8 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
                                                  memory_order_relaxed);
     st->i_lost_abuffers = atomic_load_explicit(&stats->lost_abuffers,
                                                memory_order_relaxed);
+    st->i_audio_underruns = atomic_load_explicit(&stats->audio_underruns,
+                                                 memory_order_relaxed);
 
     /* Vouts */
     st->i_decoded_video = atomic_load_explicit(&stats->decoded_video,
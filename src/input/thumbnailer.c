@@ -0,0 +1,380 @@
+/*****************************************************************************
+ * thumbnailer.c: Thumbnailing API
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <limits.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_cpu.h>
+#include <vlc_thumbnailer.h>
+#include "input_internal.h"
+#include "misc/background_worker.h"
+
+struct vlc_thumbnailer_t
+{
+    vlc_object_t* parent;
+    struct background_worker* worker;
+};
+
+struct vlc_thumbnailer_request_t
+{
+    vlc_thumbnailer_t *thumbnailer;
+    input_item_t *input_item;
+    input_thread_t *input_thread;
+    vlc_atomic_rc_t rc;
+
+    enum vlc_thumbnailer_seek_speed speed;
+    bool b_by_time;
+    vlc_tick_t time;
+    /* Positions to take thumbnails at: a single one unless this is a strip */
+    float *positions;
+    unsigned count;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait_cb;
+    /* Set to NULL once the request is being destroyed */
+    vlc_thumbnailer_cb cb;
+    void* userdata;
+    /* Callbacks running, that the destruction waits for */
+    unsigned running_cbs;
+    /* Index of the next thumbnail to report */
+    unsigned current;
+    bool done;
+};
+
+static void thumbnailer_request_Hold( void* data )
+{
+    vlc_thumbnailer_request_t *request = data;
+    vlc_atomic_rc_inc( &request->rc );
+}
+
+static void thumbnailer_request_Release( void* data )
+{
+    vlc_thumbnailer_request_t *request = data;
+    if( !vlc_atomic_rc_dec( &request->rc ) )
+        return;
+
+    assert( request->input_thread == NULL );
+    input_item_Release( request->input_item );
+    vlc_cond_destroy( &request->wait_cb );
+    vlc_mutex_destroy( &request->lock );
+    free( request->positions );
+    free( request );
+}
+
+/* Seeks to the target of the thumbnail that is to be reported next */
+static void thumbnailer_request_Seek( vlc_thumbnailer_request_t *request )
+{
+    const bool b_fast = request->speed == VLC_THUMBNAILER_SEEK_FAST;
+
+    if( request->b_by_time )
+        input_SetTime( request->input_thread, request->time, b_fast );
+    else
+        input_SetPosition( request->input_thread,
+                           request->positions[request->current], b_fast );
+}
+
+/* Invokes the callback with the lock released, so that it may call the
+ * thumbnailer back */
+static void thumbnailer_request_Report( vlc_thumbnailer_request_t *request,
+                                        unsigned index, picture_t *thumbnail )
+{
+    vlc_assert_locked( &request->lock );
+
+    vlc_thumbnailer_cb cb = request->cb;
+    if( cb == NULL )
+        return;
+
+    request->running_cbs++;
+    vlc_mutex_unlock( &request->lock );
+    cb( request->userdata, index, thumbnail );
+    vlc_mutex_lock( &request->lock );
+    if( --request->running_cbs == 0 )
+        vlc_cond_broadcast( &request->wait_cb );
+}
+
+/* Reports every remaining thumbnail as failed */
+static void thumbnailer_request_FailLocked( vlc_thumbnailer_request_t *request )
+{
+    vlc_assert_locked( &request->lock );
+
+    /* Done before reporting, as the lock is released meanwhile */
+    unsigned index = request->current;
+    request->current = request->count;
+    request->done = true;
+
+    for( ; index < request->count; index++ )
+        thumbnailer_request_Report( request, index, NULL );
+}
+
+static void on_thumbnailer_input_event( input_thread_t *input, void *userdata,
+                                        const struct vlc_input_event *event )
+{
+    VLC_UNUSED(input);
+    if( event->type != INPUT_EVENT_THUMBNAIL_READY &&
+        ( event->type != INPUT_EVENT_STATE || ( event->state != ERROR_S &&
+                                                event->state != END_S ) ) )
+         return;
+
+    vlc_thumbnailer_request_t* request = userdata;
+
+    vlc_mutex_lock( &request->lock );
+    if( request->done )
+    {
+        vlc_mutex_unlock( &request->lock );
+        return;
+    }
+
+    if( event->type == INPUT_EVENT_THUMBNAIL_READY )
+    {
+        unsigned index = request->current++;
+
+        /* Move on to the next picture of the strip right away, so that the
+         * input seeks while the owner processes this one */
+        if( request->current < request->count )
+            thumbnailer_request_Seek( request );
+        else
+            request->done = true;
+
+        thumbnailer_request_Report( request, index, event->thumbnail );
+    }
+    else
+        /* The media ended or failed before every thumbnail was taken */
+        thumbnailer_request_FailLocked( request );
+
+    bool done = request->done;
+    vlc_mutex_unlock( &request->lock );
+
+    if( done )
+        background_worker_RequestProbe( request->thumbnailer->worker );
+}
+
+static int thumbnailer_request_Start( void* owner, void* entity, void** out )
+{
+    vlc_thumbnailer_t* thumbnailer = owner;
+    vlc_thumbnailer_request_t* request = entity;
+    input_thread_t* input = request->input_thread =
+            input_CreateThumbnailer( thumbnailer->parent,
+                                     on_thumbnailer_input_event, request,
+                                     request->input_item );
+    if( unlikely( input == NULL ) )
+        goto error;
+
+    /* Handled before anything is demuxed */
+    thumbnailer_request_Seek( request );
+
+    if( input_Start( input ) != VLC_SUCCESS )
+    {
+        input_Close( input );
+        request->input_thread = NULL;
+        goto error;
+    }
+    *out = request;
+    return VLC_SUCCESS;
+
+error:
+    vlc_mutex_lock( &request->lock );
+    thumbnailer_request_FailLocked( request );
+    vlc_mutex_unlock( &request->lock );
+    return VLC_EGENERIC;
+}
+
+static int thumbnailer_request_Probe( void* owner, void* handle )
+{
+    VLC_UNUSED(owner);
+    vlc_thumbnailer_request_t* request = handle;
+
+    vlc_mutex_lock( &request->lock );
+    bool done = request->done;
+    vlc_mutex_unlock( &request->lock );
+    return done;
+}
+
+static void thumbnailer_request_Stop( void* owner, void* handle )
+{
+    VLC_UNUSED(owner);
+    vlc_thumbnailer_request_t* request = handle;
+
+    /* Timed out or cancelled: report what could not be generated */
+    vlc_mutex_lock( &request->lock );
+    if( !request->done )
+        thumbnailer_request_FailLocked( request );
+    vlc_mutex_unlock( &request->lock );
+
+    assert( request->input_thread != NULL );
+    input_Stop( request->input_thread );
+    input_Close( request->input_thread );
+    request->input_thread = NULL;
+}
+
+static vlc_thumbnailer_request_t*
+thumbnailer_RequestCommon( vlc_thumbnailer_t* thumbnailer,
+                           vlc_thumbnailer_request_t* request,
+                           enum vlc_thumbnailer_seek_speed speed,
+                           input_item_t *input_item, vlc_tick_t timeout,
+                           vlc_thumbnailer_cb cb, void* userdata )
+{
+    request->thumbnailer = thumbnailer;
+    request->input_item = input_item_Hold( input_item );
+    request->input_thread = NULL;
+    request->speed = speed;
+    request->cb = cb;
+    request->userdata = userdata;
+    request->running_cbs = 0;
+    request->current = 0;
+    request->done = false;
+    vlc_atomic_rc_init( &request->rc );
+    vlc_mutex_init( &request->lock );
+    vlc_cond_init( &request->wait_cb );
+
+    /* The timeout applies to each thumbnail of a strip */
+    int i_timeout = -1;
+    if( timeout != VLC_TICK_INVALID )
+    {
+        int64_t i_ms = MS_FROM_VLC_TICK( timeout );
+        if( i_ms < 0 )
+            i_ms = 0;
+        i_timeout = i_ms > INT_MAX / request->count ? INT_MAX
+                  : (int)( i_ms * request->count );
+    }
+
+    if( background_worker_Push( thumbnailer->worker, request, request,
+                                i_timeout ) != VLC_SUCCESS )
+    {
+        thumbnailer_request_Release( request );
+        return NULL;
+    }
+    return request;
+}
+
+static vlc_thumbnailer_request_t*
+thumbnailer_RequestNew( unsigned count )
+{
+    vlc_thumbnailer_request_t *request = malloc( sizeof( *request ) );
+    if( unlikely( request == NULL ) )
+        return NULL;
+
+    request->positions = vlc_alloc( count, sizeof( *request->positions ) );
+    if( unlikely( request->positions == NULL ) )
+    {
+        free( request );
+        return NULL;
+    }
+    request->count = count;
+    return request;
+}
+
+vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestByTime( vlc_thumbnailer_t *thumbnailer,
+                               vlc_tick_t time,
+                               enum vlc_thumbnailer_seek_speed speed,
+                               input_item_t *input_item, vlc_tick_t timeout,
+                               vlc_thumbnailer_cb cb, void* userdata )
+{
+    vlc_thumbnailer_request_t *request = thumbnailer_RequestNew( 1 );
+    if( unlikely( request == NULL ) )
+        return NULL;
+    request->b_by_time = true;
+    request->time = time;
+    return thumbnailer_RequestCommon( thumbnailer, request, speed, input_item,
+                                      timeout, cb, userdata );
+}
+
+vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
+                              float pos, enum vlc_thumbnailer_seek_speed speed,
+                              input_item_t *input_item, vlc_tick_t timeout,
+                              vlc_thumbnailer_cb cb, void* userdata )
+{
+    return vlc_thumbnailer_RequestStrip( thumbnailer, &pos, 1, speed,
+                                         input_item, timeout, cb, userdata );
+}
+
+vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestStrip( vlc_thumbnailer_t *thumbnailer,
+                              const float *positions, unsigned count,
+                              enum vlc_thumbnailer_seek_speed speed,
+                              input_item_t *input_item, vlc_tick_t timeout,
+                              vlc_thumbnailer_cb cb, void* userdata )
+{
+    assert( count > 0 );
+
+    vlc_thumbnailer_request_t *request = thumbnailer_RequestNew( count );
+    if( unlikely( request == NULL ) )
+        return NULL;
+    request->b_by_time = false;
+    memcpy( request->positions, positions, count * sizeof( *positions ) );
+    return thumbnailer_RequestCommon( thumbnailer, request, speed, input_item,
+                                      timeout, cb, userdata );
+}
+
+void vlc_thumbnailer_DestroyRequest( vlc_thumbnailer_t* thumbnailer,
+                                     vlc_thumbnailer_request_t* request )
+{
+    /* Ensure we won't invoke the callback if the input is running */
+    vlc_mutex_lock( &request->lock );
+    request->cb = NULL;
+    while( request->running_cbs > 0 )
+        vlc_cond_wait( &request->wait_cb, &request->lock );
+    vlc_mutex_unlock( &request->lock );
+
+    background_worker_Cancel( thumbnailer->worker, request );
+    thumbnailer_request_Release( request );
+}
+
+vlc_thumbnailer_t *vlc_thumbnailer_Create( vlc_object_t* parent)
+{
+    vlc_thumbnailer_t *thumbnailer = malloc( sizeof( *thumbnailer ) );
+    if( unlikely( thumbnailer == NULL ) )
+        return NULL;
+
+    int threads = var_InheritInteger( parent, "thumbnail-threads" );
+    if( threads <= 0 )
+        threads = vlc_GetCPUCount();
+
+    struct background_worker_config cfg = {
+        .default_timeout = -1,
+        .max_threads = threads,
+        .pf_release = thumbnailer_request_Release,
+        .pf_hold = thumbnailer_request_Hold,
+        .pf_start = thumbnailer_request_Start,
+        .pf_probe = thumbnailer_request_Probe,
+        .pf_stop = thumbnailer_request_Stop,
+    };
+    thumbnailer->worker = background_worker_New( thumbnailer, &cfg );
+    if( unlikely( thumbnailer->worker == NULL ) )
+    {
+        free( thumbnailer );
+        return NULL;
+    }
+    thumbnailer->parent = parent;
+    return thumbnailer;
+}
+
+void vlc_thumbnailer_Release( vlc_thumbnailer_t *thumbnailer )
+{
+    background_worker_Delete( thumbnailer->worker );
+    free( thumbnailer );
+}
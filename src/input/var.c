@@ -417,6 +417,10 @@ void input_LegacyEvents( input_thread_t *p_input, void *user_data,
             break;
         case INPUT_EVENT_SUBITEMS:
             break;
+        case INPUT_EVENT_THUMBNAIL_READY:
+            break;
+        case INPUT_EVENT_LOUDNESS_READY:
+            break;
     }
     Trigger( p_input, event->type );
 }
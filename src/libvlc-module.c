@@ -229,6 +229,14 @@ static const char *const ppsz_stereo_mode_texts[] = { N_("Unset"),
     "This allows playing audio at lower or higher speed without " \
     "affecting the audio pitch" )
 
+#define AUDIO_PULL_TEXT N_( \
+    "Pull audio from the output thread" )
+#define AUDIO_PULL_LONGTEXT N_( \
+    "Queue the audio samples in a lock-free ring buffer, which the " \
+    "real-time thread of the audio output drains. This allows smaller " \
+    "device buffers, at the cost of one more copy of the samples. Only " \
+    "some audio outputs support this." )
+
 
 static const char *const ppsz_replay_gain_mode[] = {
     "none", "track", "album" };
@@ -649,10 +657,22 @@ static const char *const ppsz_prefres[] = {
 #define INPUT_FAST_SEEK_LONGTEXT N_( \
     "Favor speed over precision while seeking" )
 
+#define INPUT_SEEK_INDEX_TEXT N_("Seek index cache")
+#define INPUT_SEEK_INDEX_LONGTEXT N_( \
+    "Remember the positions of the files without an index, such as MPEG " \
+    "streams, met while playing them, so that seeking in them later is " \
+    "accurate. They are kept in the user cache directory, for the last " \
+    "256 files." )
+
 #define INPUT_RATE_TEXT N_("Playback speed")
 #define INPUT_RATE_LONGTEXT N_( \
     "This defines the playback speed (nominal speed is 1.0)." )
 
+#define INPUT_KEYFRAME_RATE_TEXT N_("Keyframe only playback speed")
+#define INPUT_KEYFRAME_RATE_LONGTEXT N_( \
+    "From this playback speed on, only the keyframes of the video are " \
+    "decoded and displayed, so that fast forward keeps up. 0 disables it." )
+
 #define INPUT_LIST_TEXT N_("Input list")
 #define INPUT_LIST_LONGTEXT N_( \
     "You can give a comma-separated list " \
@@ -919,6 +939,13 @@ static const char *const ppsz_prefres[] = {
     "This allows you to select a list of encoders that VLC will use in " \
     "priority.")
 
+#define DECODER_POOL_TEXT N_("Share decoder threads")
+#define DECODER_POOL_LONGTEXT N_( \
+    "Run the audio, subtitles and closed captions decoders on threads " \
+    "shared by all the inputs, rather than on a thread of their own. This " \
+    "saves resources with many tracks, e.g. when playing several programs " \
+    "or mosaics.")
+
 /*****************************************************************************
  * Sout
  ****************************************************************************/
@@ -957,6 +984,12 @@ static const char *const ppsz_prefres[] = {
     "Choose whether the SPU streams should be redirected to " \
     "the stream output facility when this last one is enabled.")
 
+#define SOUT_DIRECT_TEXT N_("Direct stream output")
+#define SOUT_DIRECT_LONGTEXT N_( \
+    "Packetize and send the elementary streams to the stream output from " \
+    "the input thread, without decoder threads. This speeds up remuxing, " \
+    "but a slow stream output then also slows the input down.")
+
 #define SOUT_KEEP_TEXT N_("Keep stream output open" )
 #define SOUT_KEEP_LONGTEXT N_( \
     "This allows you to keep an unique stream output instance across " \
@@ -973,6 +1006,11 @@ static const char *const ppsz_prefres[] = {
     "This allows you to select the order in which VLC will choose its " \
     "packetizers."  )
 
+#define PACKETIZER_LAZY_TEXT N_("Lazy packetizers")
+#define PACKETIZER_LAZY_LONGTEXT N_( \
+    "When the stream is output without being decoded, packetizers only " \
+    "parse what is needed to frame the access units and to timestamp them." )
+
 #define MUX_TEXT N_("Mux module")
 #define MUX_LONGTEXT N_( \
     "This is a legacy entry to let you configure mux modules")
@@ -1129,6 +1167,16 @@ static const char *const ppsz_prefres[] = {
 #define PREPARSE_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to preparse items" )
 
+#define THUMBNAIL_THREADS_TEXT N_( "Thumbnailing threads" )
+#define THUMBNAIL_THREADS_LONGTEXT N_( \
+    "Maximum number of threads used to generate thumbnails " \
+    "(0 uses one thread per CPU)" )
+
+#define LOUDNESS_THREADS_TEXT N_( "Loudness scanning threads" )
+#define LOUDNESS_THREADS_LONGTEXT N_( \
+    "Maximum number of threads used to measure the loudness of media " \
+    "(0 uses one thread per CPU)" )
+
 #define FETCH_ART_THREADS_TEXT N_( "Fetch-art threads" )
 #define FETCH_ART_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to fetch art" )
@@ -1545,6 +1593,7 @@ vlc_module_begin ()
         change_short('A')
     add_string( "role", "video", ROLE_TEXT, ROLE_LONGTEXT, true )
         change_string_list( ppsz_roles, ppsz_roles_text )
+    add_bool( "audio-pull", false, AUDIO_PULL_TEXT, AUDIO_PULL_LONGTEXT, true )
 
     set_subcategory( SUBCAT_AUDIO_AFILTER )
     add_module_list("audio-filter", "audio filter", NULL,
@@ -1778,8 +1827,12 @@ vlc_module_begin ()
     add_bool( "input-fast-seek", false,
               INPUT_FAST_SEEK_TEXT, INPUT_FAST_SEEK_LONGTEXT, false )
         change_safe ()
+    add_bool( "input-seek-index", true,
+              INPUT_SEEK_INDEX_TEXT, INPUT_SEEK_INDEX_LONGTEXT, true )
     add_float( "rate", 1.,
                INPUT_RATE_TEXT, INPUT_RATE_LONGTEXT, false )
+    add_float( "rate-keyframe-only", 8.,
+               INPUT_KEYFRAME_RATE_TEXT, INPUT_KEYFRAME_RATE_LONGTEXT, true )
 
     add_string( "input-list", NULL,
                  INPUT_LIST_TEXT, INPUT_LIST_LONGTEXT, true )
@@ -1947,6 +2000,8 @@ vlc_module_begin ()
                 CODEC_LONGTEXT, true )
     add_string( "encoder",  NULL, ENCODER_TEXT,
                 ENCODER_LONGTEXT, true )
+    add_bool( "decoder-pool", false, DECODER_POOL_TEXT,
+              DECODER_POOL_LONGTEXT, true )
 
     set_subcategory( SUBCAT_INPUT_ACCESS )
     add_category_hint(N_("Input"), INPUT_CAT_LONGTEXT)
@@ -1974,6 +2029,8 @@ vlc_module_begin ()
                                 SOUT_DISPLAY_LONGTEXT, true )
     add_bool( "sout-keep", false, SOUT_KEEP_TEXT,
                                 SOUT_KEEP_LONGTEXT, true )
+    add_bool( "sout-direct", false, SOUT_DIRECT_TEXT,
+                                SOUT_DIRECT_LONGTEXT, true )
     add_bool( "sout-all", true, SOUT_ALL_TEXT,
                                 SOUT_ALL_LONGTEXT, true )
     add_bool( "sout-audio", 1, SOUT_AUDIO_TEXT,
@@ -2006,6 +2063,8 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_SOUT_PACKETIZER )
     add_module("packetizer", "packetizer", NULL,
                PACKETIZER_TEXT, PACKETIZER_LONGTEXT)
+    add_bool( "packetizer-lazy", true, PACKETIZER_LAZY_TEXT,
+              PACKETIZER_LAZY_LONGTEXT, true )
 
     set_subcategory( SUBCAT_SOUT_VOD )
 
@@ -2124,6 +2183,12 @@ vlc_module_begin ()
     add_integer( "fetch-art-threads", 1, FETCH_ART_THREADS_TEXT,
                  FETCH_ART_THREADS_LONGTEXT, false )
 
+    add_integer( "thumbnail-threads", 0, THUMBNAIL_THREADS_TEXT,
+                 THUMBNAIL_THREADS_LONGTEXT, false )
+
+    add_integer( "loudness-threads", 0, LOUDNESS_THREADS_TEXT,
+                 LOUDNESS_THREADS_LONGTEXT, false )
+
     add_obsolete_integer( "album-art" )
     add_bool( "metadata-network-access", false, METADATA_NETWORK_TEXT,
                  METADATA_NETWORK_TEXT, false )
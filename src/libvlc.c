@@ -58,6 +58,7 @@
 #include <vlc_charset.h>
 #include <vlc_dialog.h>
 #include <vlc_keystore.h>
+#include <vlc_thumbnailer.h>
 #include <vlc_fs.h>
 #include <vlc_cpu.h>
 #include <vlc_url.h>
@@ -238,6 +239,11 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     if( !priv->parser )
         goto error;
 
+    /* Worker threads are only spawned once thumbnails are requested */
+    priv->p_thumbnailer = vlc_thumbnailer_Create(VLC_OBJECT(p_libvlc));
+    if (!priv->p_thumbnailer)
+        msg_Warn(p_libvlc, "Failed to instantiate thumbnailer");
+
     /* variables for signalling creation of new files */
     var_Create( p_libvlc, "snapshot-file", VLC_VAR_STRING );
     var_Create( p_libvlc, "record-file", VLC_VAR_STRING );
@@ -400,6 +406,9 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if (priv->parser != NULL)
         input_preparser_Delete(priv->parser);
 
+    if (priv->p_thumbnailer)
+        vlc_thumbnailer_Release(priv->p_thumbnailer);
+
     libvlc_InternalActionsClean( p_libvlc );
 
     /* Save the configuration */
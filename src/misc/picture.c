@@ -85,6 +85,12 @@ void picture_Reset( picture_t *p_picture )
 /*****************************************************************************
  *
  *****************************************************************************/
+
+/* Alignment of the pitches and planes of software pictures. It matches the
+ * widest SIMD alignment libavcodec may require (AVX-512), so that decoders
+ * can render directly into pictures instead of copying their output. */
+#define PICTURE_SW_ALIGN 64
+
 static int LCM( int a, int b )
 {
     return a * b / GCD( a, b );
@@ -114,9 +120,9 @@ int picture_Setup( picture_t *p_picture, const video_format_t *restrict fmt )
 
     /* We want V (width/height) to respect:
         (V * p_dsc->p[i].w.i_num) % p_dsc->p[i].w.i_den == 0
-        (V * p_dsc->p[i].w.i_num/p_dsc->p[i].w.i_den * p_dsc->i_pixel_size) % 16 == 0
+        (V * p_dsc->p[i].w.i_num/p_dsc->p[i].w.i_den * p_dsc->i_pixel_size) % PICTURE_SW_ALIGN == 0
        Which is respected if you have
-       V % lcm( p_dsc->p[0..planes].w.i_den * 16) == 0
+       V % lcm( p_dsc->p[0..planes].w.i_den * PICTURE_SW_ALIGN) == 0
     */
     unsigned i_modulo_w = 1;
     unsigned i_modulo_h = 1;
@@ -124,7 +130,7 @@ int picture_Setup( picture_t *p_picture, const video_format_t *restrict fmt )
 
     for( unsigned i = 0; i < p_dsc->plane_count; i++ )
     {
-        i_modulo_w = LCM( i_modulo_w, 16 * p_dsc->p[i].w.den );
+        i_modulo_w = LCM( i_modulo_w, PICTURE_SW_ALIGN * p_dsc->p[i].w.den );
         i_modulo_h = LCM( i_modulo_h, 16 * p_dsc->p[i].h.den );
         if( i_ratio_h < p_dsc->p[i].h.den )
             i_ratio_h = p_dsc->p[i].h.den;
@@ -162,7 +168,7 @@ int picture_Setup( picture_t *p_picture, const video_format_t *restrict fmt )
                              * p_dsc->pixel_size;
         p->i_pixel_pitch = p_dsc->pixel_size;
 
-        assert( (p->i_pitch % 16) == 0 );
+        assert( (p->i_pitch % PICTURE_SW_ALIGN) == 0 );
     }
     p_picture->i_planes = p_dsc->plane_count;
 
@@ -268,7 +274,7 @@ picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
     if (unlikely(pic_size >= PICTURE_SW_SIZE_MAX))
         goto error;
 
-    uint8_t *buf = aligned_alloc(16, pic_size);
+    uint8_t *buf = aligned_alloc(PICTURE_SW_ALIGN, pic_size);
     if (unlikely(buf == NULL))
         goto error;
 
@@ -38,14 +38,22 @@
 
 static_assert ((POOL_MAX & (POOL_MAX - 1)) == 0, "Not a power of two");
 
+/*
+ * The set of available pictures is a lock-free bitmap: getting a picture is a
+ * single compare-and-swap in the common case, and releasing one is a single
+ * atomic OR. The mutex and condition variable are only used by
+ * picture_pool_Wait() callers that found the pool empty; releasers only touch
+ * them if the waiters count is non-zero.
+ */
 struct picture_pool_t {
     int       (*pic_lock)(picture_t *);
     void      (*pic_unlock)(picture_t *);
     vlc_mutex_t lock;
     vlc_cond_t  wait;
 
-    bool               canceled;
-    unsigned long long available;
+    atomic_bool        canceled;
+    atomic_ullong      available;
+    atomic_uint        waiters;
     atomic_ushort      refs;
     unsigned short     picture_count;
     picture_t  *picture[];
@@ -69,6 +77,49 @@ void picture_pool_Release(picture_pool_t *pool)
     picture_pool_Destroy(pool);
 }
 
+/**
+ * Takes an available picture out of the pool.
+ *
+ * \param mask bitmap of the pictures that may be taken
+ * \return the picture index, or -1 if none is available
+ */
+static int picture_pool_Take(picture_pool_t *pool, unsigned long long mask)
+{
+    unsigned long long available = atomic_load_explicit(&pool->available,
+                                                        memory_order_relaxed);
+    while ((available & mask) != 0)
+    {
+        int i = ctz(available & mask);
+
+        if (atomic_compare_exchange_weak_explicit(&pool->available, &available,
+                                                  available & ~(1ULL << i),
+                                                  memory_order_acquire,
+                                                  memory_order_relaxed))
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * Puts a picture back into the pool, and wakes up a waiting thread if any.
+ */
+static void picture_pool_Put(picture_pool_t *pool, unsigned offset)
+{
+    /* Sequentially consistent: the waiters count must not be read before
+     * the picture is visible as available, see picture_pool_Wait(). */
+    unsigned long long prev = atomic_fetch_or(&pool->available,
+                                              1ULL << offset);
+    assert(!(prev & (1ULL << offset)));
+    (void) prev;
+
+    if (atomic_load(&pool->waiters) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
+}
+
 static void picture_pool_ReleasePicture(picture_t *clone)
 {
     picture_priv_t *priv = (picture_priv_t *)clone;
@@ -83,12 +134,7 @@ static void picture_pool_ReleasePicture(picture_t *clone)
         pool->pic_unlock(picture);
     picture_Release(picture);
 
-    vlc_mutex_lock(&pool->lock);
-    assert(!(pool->available & (1ULL << offset)));
-    pool->available |= 1ULL << offset;
-    vlc_cond_signal(&pool->wait);
-    vlc_mutex_unlock(&pool->lock);
-
+    picture_pool_Put(pool, offset);
     picture_pool_Destroy(pool);
 }
 
@@ -134,14 +180,15 @@ picture_pool_t *picture_pool_NewExtended(const picture_pool_configuration_t *cfg
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
     if (cfg->picture_count == POOL_MAX)
-        pool->available = ~0ULL;
+        atomic_init(&pool->available, ~0ULL);
     else
-        pool->available = (1ULL << cfg->picture_count) - 1;
+        atomic_init(&pool->available, (1ULL << cfg->picture_count) - 1);
+    atomic_init(&pool->waiters, 0);
     atomic_init(&pool->refs,  1);
     pool->picture_count = cfg->picture_count;
     memcpy(pool->picture, cfg->picture,
            cfg->picture_count * sizeof (picture_t *));
-    pool->canceled = false;
+    atomic_init(&pool->canceled, false);
     return pool;
 }
 
@@ -202,88 +249,89 @@ error:
     return NULL;
 }
 
+static picture_t *picture_pool_Acquire(picture_pool_t *pool, unsigned offset)
+{
+    picture_t *clone = picture_pool_ClonePicture(pool, offset);
+    if (clone != NULL) {
+        assert(clone->p_next == NULL);
+        atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+    }
+    return clone;
+}
+
 picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-    unsigned long long available;
+    unsigned long long mask = ~0ULL;
 
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
-    available = pool->available;
+    assert(atomic_load_explicit(&pool->refs, memory_order_relaxed) > 0);
 
-    while (available != 0)
+    for (;;)
     {
-        int i = ctz(available);
-
-        if (unlikely(pool->canceled))
-            break;
+        if (unlikely(atomic_load_explicit(&pool->canceled,
+                                          memory_order_relaxed)))
+            return NULL;
 
-        pool->available &= ~(1ULL << i);
-        vlc_mutex_unlock(&pool->lock);
-        available &= ~(1ULL << i);
+        int i = picture_pool_Take(pool, mask);
+        if (i < 0)
+            return NULL;
 
         picture_t *picture = pool->picture[i];
 
         if (pool->pic_lock != NULL && pool->pic_lock(picture) != VLC_SUCCESS) {
-            vlc_mutex_lock(&pool->lock);
-            pool->available |= 1ULL << i;
+            picture_pool_Put(pool, i);
+            mask &= ~(1ULL << i);
             continue;
         }
 
-        picture_t *clone = picture_pool_ClonePicture(pool, i);
-        if (clone != NULL) {
-            assert(clone->p_next == NULL);
-            atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
-        }
-        return clone;
+        return picture_pool_Acquire(pool, i);
     }
-
-    vlc_mutex_unlock(&pool->lock);
-    return NULL;
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    int i;
 
-    while (pool->available == 0)
+    assert(atomic_load_explicit(&pool->refs, memory_order_relaxed) > 0);
+
+    while ((i = picture_pool_Take(pool, ~0ULL)) < 0)
     {
-        if (pool->canceled)
+        vlc_mutex_lock(&pool->lock);
+        /* Sequentially consistent: pairs with picture_pool_Put(). Either the
+         * releasing thread sees this waiter and signals under the lock, or
+         * the availability check below sees its picture. */
+        atomic_fetch_add(&pool->waiters, 1);
+
+        while (atomic_load(&pool->available) == 0)
         {
-            vlc_mutex_unlock(&pool->lock);
-            return NULL;
+            if (atomic_load_explicit(&pool->canceled, memory_order_relaxed))
+            {
+                atomic_fetch_sub(&pool->waiters, 1);
+                vlc_mutex_unlock(&pool->lock);
+                return NULL;
+            }
+            vlc_cond_wait(&pool->wait, &pool->lock);
         }
-        vlc_cond_wait(&pool->wait, &pool->lock);
-    }
 
-    int i = ctz(pool->available);
-    pool->available &= ~(1ULL << i);
-    vlc_mutex_unlock(&pool->lock);
+        atomic_fetch_sub(&pool->waiters, 1);
+        vlc_mutex_unlock(&pool->lock);
+    }
 
     picture_t *picture = pool->picture[i];
 
     if (pool->pic_lock != NULL && pool->pic_lock(picture) != VLC_SUCCESS) {
-        vlc_mutex_lock(&pool->lock);
-        pool->available |= 1ULL << i;
-        vlc_cond_signal(&pool->wait);
-        vlc_mutex_unlock(&pool->lock);
+        picture_pool_Put(pool, i);
         return NULL;
     }
 
-    picture_t *clone = picture_pool_ClonePicture(pool, i);
-    if (clone != NULL) {
-        assert(clone->p_next == NULL);
-        atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
-    }
-    return clone;
+    return picture_pool_Acquire(pool, i);
 }
 
 void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
 {
     vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    assert(atomic_load_explicit(&pool->refs, memory_order_relaxed) > 0);
 
-    pool->canceled = canceled;
+    atomic_store_explicit(&pool->canceled, canceled, memory_order_relaxed);
     if (canceled)
         vlc_cond_broadcast(&pool->wait);
     vlc_mutex_unlock(&pool->lock);
@@ -98,6 +98,7 @@ static vout_display_t *vout_display_New(vlc_object_t *obj,
     vd->pool = NULL;
     vd->prepare = NULL;
     vd->display = NULL;
+    vd->cancel = NULL;
     vd->control = NULL;
     vd->sys = NULL;
 
@@ -28,15 +28,29 @@
 /* NOTE: Both statistics are atomic on their own, so one might be older than
  * the other one. Currently, only one of them is updated at a time, so this
  * is a non-issue. */
+/* Why a picture missed its deadline */
+enum vout_statistic_late {
+    /* Already late when leaving the decoder, the picture was dropped */
+    VOUT_STATISTIC_LATE_DECODER,
+    /* The render stage completed after the deadline */
+    VOUT_STATISTIC_LATE_RENDER,
+    /* Rendered in time, but the present stage woke up too late */
+    VOUT_STATISTIC_LATE_PRESENT,
+    VOUT_STATISTIC_LATE_COUNT
+};
+
 typedef struct {
     atomic_uint displayed;
     atomic_uint lost;
+    atomic_uint late[VOUT_STATISTIC_LATE_COUNT];
 } vout_statistic_t;
 
 static inline void vout_statistic_Init(vout_statistic_t *stat)
 {
     atomic_init(&stat->displayed, 0);
     atomic_init(&stat->lost, 0);
+    for (unsigned i = 0; i < ARRAY_SIZE(stat->late); i++)
+        atomic_init(&stat->late[i], 0);
 }
 
 static inline void vout_statistic_Clean(vout_statistic_t *stat)
@@ -65,4 +79,23 @@ static inline void vout_statistic_AddLost(vout_statistic_t *stat, int lost)
     atomic_fetch_add_explicit(&stat->lost, lost, memory_order_relaxed);
 }
 
+static inline void vout_statistic_AddLate(vout_statistic_t *stat,
+                                          enum vout_statistic_late cause)
+{
+    atomic_fetch_add_explicit(&stat->late[cause], 1, memory_order_relaxed);
+}
+
+static inline void vout_statistic_GetResetLate(vout_statistic_t *stat,
+                                               unsigned *restrict decoder,
+                                               unsigned *restrict render,
+                                               unsigned *restrict present)
+{
+    *decoder = atomic_exchange_explicit(&stat->late[VOUT_STATISTIC_LATE_DECODER],
+                                        0, memory_order_relaxed);
+    *render = atomic_exchange_explicit(&stat->late[VOUT_STATISTIC_LATE_RENDER],
+                                       0, memory_order_relaxed);
+    *present = atomic_exchange_explicit(&stat->late[VOUT_STATISTIC_LATE_PRESENT],
+                                        0, memory_order_relaxed);
+}
+
 #endif
@@ -921,6 +921,8 @@ static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse, bool fra
                         msg_Warn(vout, "picture is too late to be displayed (missing %"PRId64" ms)", MS_FROM_VLC_TICK(late));
                         picture_Release(decoded);
                         vout_statistic_AddLost(&vout->p->statistic, 1);
+                        vout_statistic_AddLate(&vout->p->statistic,
+                                               VOUT_STATISTIC_LATE_DECODER);
                         continue;
                     } else if (late > 0) {
                         msg_Dbg(vout, "picture might be displayed late (missing %"PRId64" ms)", MS_FROM_VLC_TICK(late));
@@ -1013,12 +1015,17 @@ static picture_t *ConvertRGB32AndBlend(vout_thread_t *vout, picture_t *pic,
     return NULL;
 }
 
-static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
+/* Render stage: filters, subpictures and vout_display_Prepare().
+ * The result is kept in displayed.prepared until ThreadPresentPicture(). */
+static int ThreadRenderPicture(vout_thread_t *vout, picture_t *picture,
+                               bool is_forced, bool is_next)
 {
     vout_thread_sys_t *sys = vout->p;
     vout_display_t *vd = vout->p->display.vd;
 
-    picture_t *torender = picture_Hold(vout->p->displayed.current);
+    assert(sys->displayed.prepared.picture == NULL);
+
+    picture_t *torender = picture_Hold(picture);
 
     vout_chrono_Start(&vout->p->render);
 
@@ -1029,7 +1036,7 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     if (!filtered)
         return VLC_EGENERIC;
 
-    if (filtered->date != vout->p->displayed.current->date)
+    if (filtered->date != picture->date)
         msg_Warn(vout, "Unsupported timestamp modifications done by chain_interactive");
 
     /*
@@ -1205,31 +1212,92 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     }
 
     vout_chrono_Stop(&vout->p->render);
-#if 0
-        {
-        static int i = 0;
-        if (((i++)%10) == 0)
-            msg_Info(vout, "render: avg %d ms var %d ms",
-                     (int)(vout->p->render.avg/1000), (int)(vout->p->render.var/1000));
-        }
-#endif
+
+    sys->displayed.prepared.picture   = todisplay;
+    sys->displayed.prepared.subpic    = subpic;
+    sys->displayed.prepared.ready     = vlc_tick_now();
+    sys->displayed.prepared.is_forced = is_forced;
+    sys->displayed.prepared.is_next   = is_next;
+    return VLC_SUCCESS;
+}
+
+/* Present stage: wait for the deadline of the prepared picture and flip it */
+static void ThreadPresentPicture(vout_thread_t *vout, bool is_forced)
+{
+    vout_thread_sys_t *sys = vout->p;
+    vout_display_t *vd = vout->p->display.vd;
+
+    picture_t *todisplay = sys->displayed.prepared.picture;
+    subpicture_t *subpic = sys->displayed.prepared.subpic;
+    assert(todisplay != NULL);
+
+    sys->displayed.prepared.picture = NULL;
+    sys->displayed.prepared.subpic  = NULL;
+    is_forced |= sys->displayed.prepared.is_forced;
+
+    if (sys->displayed.prepared.is_next) {
+        picture_Release(sys->displayed.current);
+        sys->displayed.current = sys->displayed.next;
+        sys->displayed.next    = NULL;
+    }
 
     /* Wait the real date (for rendering jitter) */
-#if 0
-    vlc_tick_t delay = todisplay->date - vlc_tick_now();
-    if (delay < 1000)
-        msg_Warn(vout, "picture is late (%lld ms)", delay / 1000);
-#endif
-    if (!is_forced)
-        vlc_tick_wait(todisplay->date);
+    if (!is_forced) {
+        const vlc_tick_t date = todisplay->date;
+
+        if (vlc_tick_now() > date + VOUT_MWAIT_TOLERANCE)
+            vout_statistic_AddLate(&sys->statistic,
+                                   sys->displayed.prepared.ready > date ?
+                                   VOUT_STATISTIC_LATE_RENDER :
+                                   VOUT_STATISTIC_LATE_PRESENT);
+        else
+            vlc_tick_wait(date);
+    }
 
     /* Display the direct buffer returned by vout_RenderPicture */
     vout->p->displayed.date = vlc_tick_now();
     vout_display_Display(vd, todisplay, subpic);
 
     vout_statistic_AddDisplayed(&vout->p->statistic, 1);
+}
 
-    return VLC_SUCCESS;
+/* The display must not be controlled between the prepare and display calls
+ * of a picture: flip the prepared one right away, if any. */
+static void ThreadFlushPreparedPicture(vout_thread_t *vout)
+{
+    if (vout->p->displayed.prepared.picture != NULL)
+        ThreadPresentPicture(vout, true);
+}
+
+/* Discards the prepared picture, if any, without displaying it. The next
+ * picture it was made from is kept, and rendered again if still due.
+ * A display that prepared the picture must display it, unless it can cancel
+ * it. */
+static void ThreadDropPreparedPicture(vout_thread_t *vout)
+{
+    vout_thread_sys_t *sys = vout->p;
+    vout_display_t *vd = sys->display.vd;
+
+    picture_t *picture = sys->displayed.prepared.picture;
+    subpicture_t *subpic = sys->displayed.prepared.subpic;
+    if (picture == NULL)
+        return;
+
+    if (vd->prepare != NULL && vd->cancel == NULL) {
+        ThreadPresentPicture(vout, true);
+        return;
+    }
+
+    sys->displayed.prepared.picture = NULL;
+    sys->displayed.prepared.subpic  = NULL;
+
+    if (vd->prepare != NULL)
+        vout_display_Cancel(vd, picture, subpic);
+    else {
+        picture_Release(picture);
+        if (subpic != NULL)
+            subpicture_Delete(subpic);
+    }
 }
 
 static int ThreadDisplayPicture(vout_thread_t *vout, vlc_tick_t *deadline)
@@ -1238,6 +1306,18 @@ static int ThreadDisplayPicture(vout_thread_t *vout, vlc_tick_t *deadline)
     bool paused = vout->p->pause.is_on;
     bool first = !vout->p->displayed.current;
 
+    if (vout->p->displayed.prepared.picture) {
+        const vlc_tick_t date = vout->p->displayed.prepared.picture->date;
+
+        if (!frame_by_frame && !vout->p->displayed.prepared.is_forced &&
+            date - VOUT_MWAIT_TOLERANCE > vlc_tick_now()) {
+            *deadline = date - VOUT_MWAIT_TOLERANCE;
+            return VLC_EGENERIC;
+        }
+        ThreadPresentPicture(vout, frame_by_frame);
+        return VLC_SUCCESS;
+    }
+
     if (first)
         if (ThreadDisplayPreparePicture(vout, true, frame_by_frame)) /* FIXME not sure it is ok */
             return VLC_EGENERIC;
@@ -1252,7 +1332,9 @@ static int ThreadDisplayPicture(vout_thread_t *vout, vlc_tick_t *deadline)
     bool drop_next_frame = frame_by_frame;
     vlc_tick_t date_next = VLC_TICK_INVALID;
     if (!paused && vout->p->displayed.next) {
-        date_next = vout->p->displayed.next->date - render_delay;
+        /* Render ahead of time, so that a render slower than the estimate
+         * still leaves the present stage on time */
+        date_next = vout->p->displayed.next->date - 2 * render_delay;
         if (date_next /* + 0 FIXME */ <= date)
             drop_next_frame = true;
     }
@@ -1285,18 +1367,26 @@ static int ThreadDisplayPicture(vout_thread_t *vout, vlc_tick_t *deadline)
         return VLC_EGENERIC;
     }
 
-    if (drop_next_frame) {
+    /* The current picture is replaced once the next one is presented, unless
+     * it has never been displayed */
+    bool is_next = drop_next_frame && !first && vout->p->displayed.next;
+    if (drop_next_frame && !is_next) {
         picture_Release(vout->p->displayed.current);
         vout->p->displayed.current = vout->p->displayed.next;
         vout->p->displayed.next    = NULL;
     }
 
-    if (!vout->p->displayed.current)
+    picture_t *torender = is_next ? vout->p->displayed.next
+                                  : vout->p->displayed.current;
+    if (!torender)
         return VLC_EGENERIC;
 
+    bool is_forced = frame_by_frame || force_refresh || torender->b_force;
+    int ret = ThreadRenderPicture(vout, torender, is_forced, is_next);
+
     /* display the picture immediately */
-    bool is_forced = frame_by_frame || force_refresh || vout->p->displayed.current->b_force;
-    int ret = ThreadDisplayRenderPicture(vout, is_forced);
+    if (ret == VLC_SUCCESS && (frame_by_frame || force_refresh))
+        ThreadPresentPicture(vout, true);
     return force_refresh ? VLC_EGENERIC : ret;
 }
 
@@ -1527,6 +1617,8 @@ static int ThreadStart(vout_thread_t *vout, vout_display_state_t *state)
 
     vout->p->displayed.current       = NULL;
     vout->p->displayed.next          = NULL;
+    vout->p->displayed.prepared.picture = NULL;
+    vout->p->displayed.prepared.subpic  = NULL;
     vout->p->displayed.decoded       = NULL;
     vout->p->displayed.date          = VLC_TICK_INVALID;
     vout->p->displayed.timestamp     = VLC_TICK_INVALID;
@@ -1556,6 +1648,14 @@ error:
 
 static void ThreadStop(vout_thread_t *vout, vout_display_state_t *state)
 {
+    unsigned late_decoder, late_render, late_present;
+
+    vout_statistic_GetResetLate(&vout->p->statistic, &late_decoder,
+                                &late_render, &late_present);
+    if (late_decoder || late_render || late_present)
+        msg_Dbg(vout, "late pictures: %u from the decoder, %u rendered late, "
+                "%u presented late", late_decoder, late_render, late_present);
+
     if (vout->p->spu_blend)
         filter_DeleteBlend(vout->p->spu_blend);
 
@@ -1662,6 +1762,27 @@ static void ThreadCancel(vout_thread_t *vout, bool canceled)
 
 static int ThreadControl(vout_thread_t *vout, vout_control_cmd_t cmd)
 {
+    switch(cmd.type) {
+    case VOUT_CONTROL_CANCEL:
+    case VOUT_CONTROL_SUBPICTURE:
+    case VOUT_CONTROL_FLUSH_SUBPICTURE:
+    case VOUT_CONTROL_MOUSE_STATE:
+    case VOUT_CONTROL_STEP: /* displays it */
+        break;
+    case VOUT_CONTROL_CLEAN:
+    case VOUT_CONTROL_REINIT:
+    case VOUT_CONTROL_CHANGE_FILTERS:
+    case VOUT_CONTROL_CHANGE_INTERLACE:
+    case VOUT_CONTROL_PAUSE:
+    case VOUT_CONTROL_FLUSH:
+        /* The prepared picture is stale or not due yet */
+        ThreadDropPreparedPicture(vout);
+        break;
+    default:
+        ThreadFlushPreparedPicture(vout);
+        break;
+    }
+
     switch(cmd.type) {
     case VOUT_CONTROL_CLEAN:
         ThreadStop(vout, NULL);
@@ -1773,7 +1894,9 @@ static void *Thread(void *object)
         const bool picture_interlaced = sys->displayed.is_interlaced;
 
         vout_SetInterlacingState(vout, picture_interlaced);
-        vout_ManageWrapper(vout);
+        /* Display events are handled once the prepared picture is flipped */
+        if (!sys->displayed.prepared.picture)
+            vout_ManageWrapper(vout);
     }
 
 out:
@@ -100,6 +100,15 @@ struct vout_thread_sys_t
         picture_t   *decoded;
         picture_t   *current;
         picture_t   *next;
+        /* Picture rendered ahead of its deadline: it went through
+         * vout_display_Prepare() and waits for vout_display_Display() */
+        struct {
+            picture_t    *picture;
+            subpicture_t *subpic;
+            vlc_tick_t   ready;     /* date the render stage completed */
+            bool         is_forced;
+            bool         is_next;   /* rendered from next, not current */
+        } prepared;
     } displayed;
 
     struct {
@@ -953,14 +953,15 @@ static void SpuRenderRegion(spu_t *spu,
         }
     }
 
-    subpicture_region_t *dst = *dst_ptr = subpicture_region_New(&region_fmt);
+    /* The output region only references the (possibly cached) rendered
+     * picture: nothing is allocated nor copied per displayed frame as long
+     * as the source region and the destination size are unchanged. */
+    subpicture_region_t *dst = *dst_ptr =
+        subpicture_region_ForPicture(&region_fmt, region_picture);
     if (dst) {
         dst->i_x       = x_offset;
         dst->i_y       = y_offset;
         dst->i_align   = 0;
-        if (dst->p_picture)
-            picture_Release(dst->p_picture);
-        dst->p_picture = picture_Hold(region_picture);
         int fade_alpha = 255;
         if (subpic->b_fade) {
             vlc_tick_t fade_start = subpic->i_start + 3 * (subpic->i_stop - subpic->i_start) / 4;
@@ -329,6 +329,56 @@ static void test_media_subitems(libvlc_instance_t *vlc)
     libvlc_media_release (media);
 }
 
+struct thumbnail_strip
+{
+    vlc_sem_t sem;
+    unsigned next_index;
+};
+
+static void thumbnail_generated(const libvlc_event_t *event, void *user_data)
+{
+    struct thumbnail_strip *strip = user_data;
+
+    /* Thumbnails are reported once each, in order */
+    assert(event->u.media_thumbnail_generated.i_index == strip->next_index);
+    assert(event->u.media_thumbnail_generated.p_thumbnail == NULL);
+    strip->next_index++;
+    vlc_sem_post(&strip->sem);
+}
+
+static void test_media_thumbnail_failed(libvlc_instance_t *vlc)
+{
+    log ("test_media_thumbnail_failed\n");
+
+    static const float positions[] = { .25f, .5f, .75f };
+    libvlc_media_t *media =
+        libvlc_media_new_path (vlc, SRCDIR"/samples/does_not_exist.mkv");
+    assert (media != NULL);
+
+    struct thumbnail_strip strip = { .next_index = 0 };
+    vlc_sem_init (&strip.sem, 0);
+
+    libvlc_event_manager_t *em = libvlc_media_event_manager (media);
+    libvlc_event_attach (em, libvlc_MediaThumbnailGenerated,
+                         thumbnail_generated, &strip);
+
+    libvlc_media_thumbnail_request_t *req =
+        libvlc_media_thumbnail_request_strip (media, positions,
+                                              ARRAY_SIZE(positions),
+                                              libvlc_media_thumbnail_seek_fast,
+                                              64, 0, libvlc_picture_Png, 0);
+    assert (req != NULL);
+
+    /* Every position fails when the media cannot be opened */
+    for (size_t i = 0; i < ARRAY_SIZE(positions); i++)
+        vlc_sem_wait (&strip.sem);
+    assert (strip.next_index == ARRAY_SIZE(positions));
+
+    libvlc_media_thumbnail_request_destroy (req);
+    vlc_sem_destroy (&strip.sem);
+    libvlc_media_release (media);
+}
+
 int main(int i_argc, char *ppsz_argv[])
 {
     test_init();
@@ -369,6 +419,7 @@ int main(int i_argc, char *ppsz_argv[])
                           libvlc_media_parse_local,
                           libvlc_media_parsed_status_skipped);
     test_media_subitems (vlc);
+    test_media_thumbnail_failed (vlc);
 
     /* Testing libvlc_MetadataRequest timeout and libvlc_MetadataCancel. For
      * that, we need to create a local input_item_t based on a pipe. There is
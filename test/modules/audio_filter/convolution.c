@@ -0,0 +1,239 @@
+/*****************************************************************************
+ * convolution.c: partitioned convolution engine and headphone filter test
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#include <vlc/vlc.h>
+
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_rand.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+#include "../modules/audio_filter/convolution.h"
+#include "../modules/audio_filter/convolution.c"
+
+#define SAMPLES 20000
+
+static float RandomSample(void)
+{
+    return vlc_drand48() - .5;
+}
+
+/* Feeds the samples in random amounts, as the audio output does */
+static void Process(convolver_t *c, const float *in, unsigned inputs,
+                    float *out, unsigned outputs, unsigned samples,
+                    unsigned chunk)
+{
+    for (unsigned done = 0; done < samples;)
+    {
+        unsigned n = __MIN(vlc_lrand48() % chunk + 1, samples - done);
+
+        convolver_Process(c, in + done * inputs, out + done * outputs, n);
+        done += n;
+    }
+}
+
+/*** Engine against the direct form convolution ***/
+static void TestEngine(unsigned inputs, unsigned outputs, unsigned partition,
+                       unsigned taps, unsigned chunk)
+{
+    convolver_t *c = convolver_New(inputs, outputs, partition, taps);
+    assert(c != NULL);
+
+    float *h = malloc(inputs * outputs * taps * sizeof (*h));
+    float *x = malloc(SAMPLES * inputs * sizeof (*x));
+    float *y = malloc(SAMPLES * outputs * sizeof (*y));
+    float *z = malloc(SAMPLES * outputs * sizeof (*z));
+    assert(h != NULL && x != NULL && y != NULL && z != NULL);
+
+    for (unsigned i = 0; i < inputs * outputs * taps; i++)
+        h[i] = RandomSample();
+    for (unsigned i = 0; i < SAMPLES * inputs; i++)
+        x[i] = RandomSample();
+
+    /* Leave the last input disconnected from the first output */
+    for (unsigned i = 0; i < inputs; i++)
+        for (unsigned o = 0; o < outputs; o++)
+            if (inputs == 1 || i < inputs - 1 || o > 0)
+                convolver_SetResponse(c, i, o, h + (i * outputs + o) * taps,
+                                      taps);
+            else
+                memset(h + (i * outputs + o) * taps, 0, taps * sizeof (*h));
+
+    vlc_tick_t begin = vlc_tick_now();
+    Process(c, x, inputs, y, outputs, SAMPLES, chunk);
+    vlc_tick_t elapsed = vlc_tick_now() - begin;
+
+    double err = 0.;
+    for (unsigned s = 0; s < SAMPLES; s += 7)
+        for (unsigned o = 0; o < outputs; o++)
+        {
+            double ref = 0.;
+
+            for (unsigned i = 0; i < inputs; i++)
+                for (unsigned k = 0; k < taps && k <= s; k++)
+                    ref += h[(i * outputs + o) * taps + k]
+                         * x[(s - k) * inputs + i];
+            err = fmax(err, fabs(ref - y[s * outputs + o]));
+        }
+
+    printf("%u -> %u, %5u taps, partition %4u: %8.2f Msamples/s, "
+           "error %g\n", inputs, outputs, taps, partition,
+           SAMPLES / (elapsed > 0 ? (double)elapsed : 1.) * CLOCK_FREQ / 1e6,
+           err);
+    /* The output magnitude grows with sqrt(taps) */
+    assert(err < 1e-6 * sqrt(taps * inputs) + 1e-6);
+
+    /* After a reset, the output must not depend on the previous samples */
+    convolver_Reset(c);
+    Process(c, x, inputs, z, outputs, SAMPLES, chunk);
+    for (unsigned i = 0; i < SAMPLES * outputs; i++)
+        assert(fabsf(z[i] - y[i]) < 1e-6f * sqrtf(taps * inputs) + 1e-6f);
+
+    free(z);
+    free(y);
+    free(x);
+    free(h);
+    convolver_Delete(c);
+}
+
+/*** Headphone filter against its delay lines model ***/
+static void HeadphoneDelay(double x, double z, int ear, unsigned rate,
+                           unsigned *delay, double *amplitude)
+{
+    const double c = 340., ear_x = ear ? .1 : -.1;
+    /* No compensation: the minimal distance is 0 */
+    const double compensation = -.1 / c * rate;
+
+    *delay = (int)(sqrt((ear_x - x) * (ear_x - x) + z * z) / c * rate
+                   - compensation);
+    if (x == 0)
+        *amplitude = .5;
+    else
+        *amplitude = ((x < 0) == (ear == 0) ? 1.1 : .9) / 2;
+}
+
+static void TestHeadphone(vlc_object_t *parent)
+{
+    const unsigned rate = 48000;
+    filter_t *filter = vlc_object_create(parent, sizeof (*filter));
+    assert(filter != NULL);
+
+    filter->fmt_in.audio.i_format = filter->fmt_in.i_codec = VLC_CODEC_FL32;
+    filter->fmt_in.audio.i_physical_channels = AOUT_CHANS_STEREO;
+    filter->fmt_in.audio.i_rate = rate;
+    aout_FormatPrepare(&filter->fmt_in.audio);
+    filter->fmt_out = filter->fmt_in;
+
+    filter->p_module = module_need(filter, "audio filter", "headphone", true);
+    assert(filter->p_module != NULL);
+
+    float *x = malloc(SAMPLES * 2 * sizeof (*x));
+    float *y = malloc(SAMPLES * 2 * sizeof (*y));
+    assert(x != NULL && y != NULL);
+    for (unsigned i = 0; i < SAMPLES * 2; i++)
+        x[i] = RandomSample();
+
+    vlc_tick_t elapsed = 0;
+    for (unsigned done = 0; done < SAMPLES;)
+    {
+        unsigned n = __MIN(vlc_lrand48() % 2000 + 1, SAMPLES - done);
+        block_t *block = block_Alloc(n * 2 * sizeof (*x));
+        assert(block != NULL);
+        memcpy(block->p_buffer, x + done * 2, block->i_buffer);
+        block->i_nb_samples = n;
+
+        vlc_tick_t begin = vlc_tick_now();
+        block = filter->pf_audio_filter(filter, block);
+        elapsed += vlc_tick_now() - begin;
+
+        assert(block != NULL && block->i_nb_samples == n);
+        memcpy(y + done * 2, block->p_buffer, block->i_buffer);
+        block_Release(block);
+        done += n;
+    }
+
+    /* Each speaker reaches each ear with its own delay and attenuation */
+    const int dim = var_InheritInteger(filter, "headphone-dim");
+    const double speakers[2] = { -dim, dim };
+    double err = 0.;
+
+    for (unsigned s = 0; s < SAMPLES; s++)
+        for (int ear = 0; ear < 2; ear++)
+        {
+            double ref = 0.;
+
+            for (unsigned src = 0; src < 2; src++)
+            {
+                unsigned delay;
+                double amplitude;
+
+                HeadphoneDelay(speakers[src], dim, ear, rate, &delay,
+                               &amplitude);
+                if (s >= delay)
+                    ref += amplitude * x[(s - delay) * 2 + src];
+            }
+            err = fmax(err, fabs(ref - y[s * 2 + ear]));
+        }
+
+    printf("headphone: %8.2f Msamples/s, error %g\n",
+           SAMPLES / (elapsed > 0 ? (double)elapsed : 1.) * CLOCK_FREQ / 1e6,
+           err);
+    assert(err < 1e-5);
+
+    free(y);
+    free(x);
+    module_unneed(filter, filter->p_module);
+    vlc_object_release(filter);
+}
+
+int main(void)
+{
+    alarm(30);
+
+    TestEngine(1, 1, 4, 1, 1);
+    TestEngine(1, 1, 64, 100, 7);
+    TestEngine(2, 3, 64, 1000, 100);
+    TestEngine(2, 2, 256, 3000, 333);
+    TestEngine(6, 2, 256, 1500, 1024);
+    TestEngine(1, 2, 1024, 48000, 4096);
+
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+
+    if (module_exists("headphone_channel_mixer"))
+        TestHeadphone(VLC_OBJECT(vlc->p_libvlc_int));
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,353 @@
+/*****************************************************************************
+ * kernels.c: audio volume, downmix and format conversion benchmark
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#include <vlc/vlc.h>
+
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_aout_volume.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_rand.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+/*
+ * Runs the per-sample kernels of the float volume, the simple channel mixer
+ * and the PCM format converter over random samples, checks their output
+ * against a plain C reference and prints their throughput, whichever of the
+ * C or SIMD versions the CPU picked. With "-a", more blocks are processed.
+ */
+
+#define BLOCK 4096 /* samples per block */
+
+static unsigned blocks;
+
+static float RandomSample(void)
+{
+    /* Slightly out of [-1;1] to exercise clipping */
+    return vlc_drand48() * 2.2 - 1.1;
+}
+
+static void Report(const char *name, vlc_tick_t elapsed)
+{
+    printf("%-28s %8.2f Msamples/s\n", name, (double)blocks * BLOCK /
+           (elapsed > 0 ? (double)elapsed : 1.) * CLOCK_FREQ / 1e6);
+}
+
+/*** Volume ***/
+static void BenchVolume(vlc_object_t *parent, vlc_fourcc_t format)
+{
+    audio_volume_t *volume = vlc_object_create(parent, sizeof (*volume));
+    assert(volume != NULL);
+    volume->format = format;
+
+    module_t *module = module_need(volume, "audio volume", "float_mixer",
+                                   true);
+    assert(module != NULL);
+
+    const size_t size = format == VLC_CODEC_FL32 ? sizeof (float)
+                                                 : sizeof (double);
+    const unsigned count = BLOCK * 2 + 3; /* odd length for the tails */
+    block_t *block = block_Alloc(count * size);
+    assert(block != NULL);
+
+    double *ref = malloc(count * sizeof (*ref));
+    assert(ref != NULL);
+    for (unsigned i = 0; i < count; i++)
+    {
+        ref[i] = RandomSample();
+        if (format == VLC_CODEC_FL32)
+            ((float *)block->p_buffer)[i] = ref[i];
+        else
+            ((double *)block->p_buffer)[i] = ref[i];
+    }
+
+    vlc_tick_t elapsed = 0;
+    /* Alternate between two gains whose product is exactly one */
+    for (unsigned i = 0; i < blocks; i++)
+    {
+        vlc_tick_t begin = vlc_tick_now();
+        volume->amplify(volume, block, i & 1 ? 0.5f : 2.f);
+        elapsed += vlc_tick_now() - begin;
+    }
+    if (blocks & 1)
+        volume->amplify(volume, block, 0.5f);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        double v = format == VLC_CODEC_FL32 ? ((float *)block->p_buffer)[i]
+                                            : ((double *)block->p_buffer)[i];
+        assert(v == (format == VLC_CODEC_FL32 ? (float)ref[i] : ref[i]));
+    }
+
+    Report(format == VLC_CODEC_FL32 ? "volume fl32" : "volume fl64", elapsed);
+    free(ref);
+    block_Release(block);
+    module_unneed(volume, module);
+    vlc_object_release(volume);
+}
+
+/*** Channel mixing ***/
+struct downmix
+{
+    const char *name;
+    uint32_t in, out;
+    float matrix[4][8]; /* [output][input] */
+};
+
+#define C_ 0.7071f
+
+static const struct downmix downmixes[] = {
+    { "downmix 5.1 -> 2.0", AOUT_CHANS_5_1, AOUT_CHANS_2_0, {
+        /* L R Lr Rr C LFE */
+        { 1, 0, C_, 0, C_, 0 },
+        { 0, 1, 0, C_, C_, 0 },
+    } },
+    { "downmix 5.0 -> 2.0", AOUT_CHANS_5_0, AOUT_CHANS_2_0, {
+        { 1, 0, C_, 0, C_ },
+        { 0, 1, 0, C_, C_ },
+    } },
+    { "downmix 7.1 -> 2.0", AOUT_CHANS_7_1, AOUT_CHANS_2_0, {
+        /* L R Lm Rm Lr Rr C LFE */
+        { 1, 0, .25f, 0, .25f, 0, C_, 0 },
+        { 0, 1, 0, .25f, 0, .25f, C_, 0 },
+    } },
+    { "downmix 6.1 -> 2.0", AOUT_CHANS_6_1_MIDDLE, AOUT_CHANS_2_0, {
+        { 1, 0, C_, 1, 0, C_, 0 },
+        { 0, 1, C_, 0, 1, C_, 0 },
+    } },
+    { "downmix 7.1 -> 4.0", AOUT_CHANS_7_1, AOUT_CHANS_4_0, {
+        { .5f, 0, 1.f/6, 0, 0, 0, 1, 0 },
+        { 0, .5f, 0, 1.f/6, 0, 0, 1, 0 },
+        { 0, 0, 1.f/6, 0, 1, 0, 0, 0 },
+        { 0, 0, 0, 1.f/6, 0, 1, 0, 0 },
+    } },
+    { "downmix 5.1 -> 4.0", AOUT_CHANS_5_1, AOUT_CHANS_4_0, {
+        { 1, 0, 0, 0, C_, 0 },
+        { 0, 1, 0, 0, C_, 0 },
+        { 0, 0, 1, 0, 0, 0 },
+        { 0, 0, 0, 1, 0, 0 },
+    } },
+};
+
+static filter_t *CreateConverter(vlc_object_t *parent, const char *name,
+                                 vlc_fourcc_t ifmt, uint32_t ichans,
+                                 vlc_fourcc_t ofmt, uint32_t ochans)
+{
+    filter_t *filter = vlc_object_create(parent, sizeof (*filter));
+    assert(filter != NULL);
+
+    filter->fmt_in.audio.i_format = filter->fmt_in.i_codec = ifmt;
+    filter->fmt_in.audio.i_physical_channels = ichans;
+    filter->fmt_in.audio.i_rate = 48000;
+    aout_FormatPrepare(&filter->fmt_in.audio);
+
+    filter->fmt_out.audio.i_format = filter->fmt_out.i_codec = ofmt;
+    filter->fmt_out.audio.i_physical_channels = ochans;
+    filter->fmt_out.audio.i_rate = 48000;
+    aout_FormatPrepare(&filter->fmt_out.audio);
+
+    filter->p_module = module_need(filter, "audio converter", name, true);
+    assert(filter->p_module != NULL);
+    return filter;
+}
+
+static void DeleteConverter(filter_t *filter)
+{
+    module_unneed(filter, filter->p_module);
+    vlc_object_release(filter);
+}
+
+static void BenchDownmix(vlc_object_t *parent, const struct downmix *dm)
+{
+    filter_t *filter = CreateConverter(parent, "simple_channel_mixer",
+                                       VLC_CODEC_FL32, dm->in,
+                                       VLC_CODEC_FL32, dm->out);
+    const unsigned ich = filter->fmt_in.audio.i_channels;
+    const unsigned och = filter->fmt_out.audio.i_channels;
+    const unsigned count = BLOCK + 1; /* odd length for the tails */
+
+    float *in = malloc(count * ich * sizeof (*in));
+    assert(in != NULL);
+    for (unsigned i = 0; i < count * ich; i++)
+        in[i] = RandomSample();
+
+    vlc_tick_t elapsed = 0;
+    for (unsigned b = 0; b < blocks; b++)
+    {
+        block_t *block = block_Alloc(count * ich * sizeof (*in));
+        assert(block != NULL);
+        memcpy(block->p_buffer, in, block->i_buffer);
+        block->i_nb_samples = count;
+
+        vlc_tick_t begin = vlc_tick_now();
+        block = filter->pf_audio_filter(filter, block);
+        elapsed += vlc_tick_now() - begin;
+        assert(block != NULL && block->i_nb_samples == count);
+
+        if (b == 0)
+        {
+            const float *out = (const float *)block->p_buffer;
+
+            for (unsigned i = 0; i < count; i++)
+                for (unsigned o = 0; o < och; o++)
+                {
+                    float ref = 0.f;
+                    for (unsigned c = 0; c < ich; c++)
+                        ref += dm->matrix[o][c] * in[i * ich + c];
+                    assert(fabsf(out[i * och + o] - ref) < 1e-5f);
+                }
+        }
+        block_Release(block);
+    }
+
+    Report(dm->name, elapsed);
+    free(in);
+    DeleteConverter(filter);
+}
+
+/*** Format conversion ***/
+static void BenchConversion(vlc_object_t *parent, vlc_fourcc_t ifmt,
+                            vlc_fourcc_t ofmt)
+{
+    filter_t *filter = CreateConverter(parent, "audio_format",
+                                       ifmt, AOUT_CHANS_STEREO,
+                                       ofmt, AOUT_CHANS_STEREO);
+    const unsigned count = (BLOCK + 3) * 2; /* odd length for the tails */
+    const size_t isize = filter->fmt_in.audio.i_bitspersample / 8;
+
+    float *ref = malloc(count * sizeof (*ref));
+    uint8_t *in = malloc(count * isize);
+    assert(ref != NULL && in != NULL);
+    for (unsigned i = 0; i < count; i++)
+    {
+        float s = RandomSample();
+        switch (ifmt)
+        {
+            case VLC_CODEC_FL32:
+                ((float *)in)[i] = ref[i] = s;
+                break;
+            case VLC_CODEC_S16N:
+                ((int16_t *)in)[i] = lroundf(VLC_CLIP(s, -1.f, .99f) * 32768.f);
+                ref[i] = ((int16_t *)in)[i] / 32768.f;
+                break;
+            case VLC_CODEC_S32N:
+                ((int32_t *)in)[i] = (int32_t)(VLC_CLIP(s, -1.f, .99f)
+                                               * 2147483648.);
+                ref[i] = ((int32_t *)in)[i] / 2147483648.;
+                break;
+            default:
+                vlc_assert_unreachable();
+        }
+    }
+
+    vlc_tick_t elapsed = 0;
+    for (unsigned b = 0; b < blocks; b++)
+    {
+        block_t *block = block_Alloc(count * isize);
+        assert(block != NULL);
+        memcpy(block->p_buffer, in, block->i_buffer);
+        block->i_nb_samples = count / 2;
+
+        vlc_tick_t begin = vlc_tick_now();
+        block = filter->pf_audio_filter(filter, block);
+        elapsed += vlc_tick_now() - begin;
+        assert(block != NULL);
+
+        if (b == 0)
+            for (unsigned i = 0; i < count; i++)
+            {
+                const float r = VLC_CLIP(ref[i], -1.f, 1.f);
+                switch (ofmt)
+                {
+                    case VLC_CODEC_FL32:
+                        assert(fabsf(((float *)block->p_buffer)[i] - r)
+                               < 1e-7f);
+                        break;
+                    case VLC_CODEC_S16N:
+                        assert(abs(((int16_t *)block->p_buffer)[i]
+                                   - (int)lroundf(VLC_CLIP(r * 32768.f,
+                                                           -32768.f, 32767.f)))
+                               <= 1);
+                        break;
+                    case VLC_CODEC_S32N:
+                        assert(fabs(((int32_t *)block->p_buffer)[i]
+                                    - VLC_CLIP(r * 2147483648.,
+                                               -2147483648., 2147483647.))
+                               <= 256.);
+                        break;
+                    default:
+                        vlc_assert_unreachable();
+                }
+            }
+        block_Release(block);
+    }
+
+    char name[32];
+    snprintf(name, sizeof (name), "convert %4.4s -> %4.4s",
+             (const char *)&ifmt, (const char *)&ofmt);
+    Report(name, elapsed);
+    free(in);
+    free(ref);
+    DeleteConverter(filter);
+}
+
+int main(int argc, char *argv[])
+{
+    blocks = argc > 1 && strcmp(argv[1], "-a") == 0 ? 10000 : 200;
+
+    alarm(blocks / 10 + 10);
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *parent = VLC_OBJECT(vlc->p_libvlc_int);
+
+    if (!module_exists("float_mixer") || !module_exists("audio_format")
+     || !module_exists("simple_channel_mixer"))
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    BenchVolume(parent, VLC_CODEC_FL32);
+    BenchVolume(parent, VLC_CODEC_FL64);
+
+    for (size_t i = 0; i < ARRAY_SIZE(downmixes); i++)
+        BenchDownmix(parent, &downmixes[i]);
+
+    BenchConversion(parent, VLC_CODEC_S16N, VLC_CODEC_FL32);
+    BenchConversion(parent, VLC_CODEC_FL32, VLC_CODEC_S16N);
+    BenchConversion(parent, VLC_CODEC_S32N, VLC_CODEC_FL32);
+    BenchConversion(parent, VLC_CODEC_FL32, VLC_CODEC_S32N);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,243 @@
+/*****************************************************************************
+ * resampler.c: audio resamplers quality and throughput benchmark
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#include <vlc/vlc.h>
+
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+/*
+ * Resamples a 1 kHz stereo sine with each available resampler, and prints
+ * the throughput and the THD+N (everything but the fitted sine, relative to
+ * it). With "-a", more seconds of audio are processed.
+ */
+
+#define TONE      1000.
+#define CHANNELS  2
+#define BLOCK     1024
+
+static const char *const modules[] = {
+    "polyphase", "bandlimited_resampler", "ugly_resampler",
+};
+
+static const unsigned rates[][2] = {
+    { 44100, 48000 }, { 48000, 44100 }, { 44100, 96000 }, { 96000, 48000 },
+};
+
+static filter_t *CreateResampler(vlc_object_t *parent, const char *name,
+                                 unsigned irate, unsigned orate)
+{
+    filter_t *filter = vlc_object_create(parent, sizeof (*filter));
+    assert(filter != NULL);
+
+    audio_format_t fmt = {
+        .i_format = VLC_CODEC_FL32,
+        .i_physical_channels = AOUT_CHANS_STEREO,
+        .i_channels = CHANNELS,
+    };
+    aout_FormatPrepare(&fmt);
+
+    filter->fmt_in.audio = filter->fmt_out.audio = fmt;
+    filter->fmt_in.i_codec = filter->fmt_out.i_codec = VLC_CODEC_FL32;
+    filter->fmt_in.audio.i_rate = irate;
+    filter->fmt_out.audio.i_rate = orate;
+
+    filter->p_module = module_need(filter, "audio resampler", name, true);
+    if (filter->p_module == NULL)
+    {
+        vlc_object_release(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+/* Returns the THD+N in dB, after the filter settled */
+static double Measure(const float *out, size_t count, unsigned rate)
+{
+    const double w = 2. * M_PI * TONE / rate;
+    const size_t start = rate / 10;
+    double ss = 0., cc = 0., sc = 0., ys = 0., yc = 0.;
+
+    assert(count > start);
+
+    /* Both channels get the same input, so they must match from the very
+     * first sample, including while the filter settles */
+    for (size_t i = 0; i < count; i++)
+        assert(out[i * CHANNELS + 1] == out[i * CHANNELS]);
+
+    for (size_t i = start; i < count; i++)
+    {
+        const double s = sin(w * i), c = cos(w * i), y = out[i * CHANNELS];
+
+        ss += s * s; cc += c * c; sc += s * c;
+        ys += y * s; yc += y * c;
+    }
+
+    /* Least squares fit of the tone, whatever its phase */
+    const double det = ss * cc - sc * sc;
+    const double a = (ys * cc - yc * sc) / det;
+    const double b = (yc * ss - ys * sc) / det;
+    double signal = 0., noise = 0.;
+
+    for (size_t i = start; i < count; i++)
+    {
+        const double fit = a * sin(w * i) + b * cos(w * i);
+        const double err = out[i * CHANNELS] - fit;
+
+        signal += fit * fit;
+        noise += err * err;
+    }
+    return 10. * log10(noise / signal);
+}
+
+static double Run(filter_t *filter, unsigned seconds, bool drift)
+{
+    const unsigned irate = filter->fmt_in.audio.i_rate;
+    const unsigned orate = filter->fmt_out.audio.i_rate;
+    const size_t total = (size_t)irate * seconds;
+    const double w = 2. * M_PI * TONE / irate;
+
+    size_t capacity = (total + BLOCK) * 2 * orate / irate + BLOCK, count = 0;
+    float *out = malloc(capacity * CHANNELS * sizeof (float));
+    assert(out != NULL);
+
+    vlc_tick_t elapsed = 0;
+    double expected = 0.;
+
+    for (size_t done = 0; done < total; done += BLOCK)
+    {
+        block_t *in = block_Alloc(BLOCK * CHANNELS * sizeof (float));
+        assert(in != NULL);
+        in->i_nb_samples = BLOCK;
+        in->i_pts = VLC_TICK_0 + done * CLOCK_FREQ / irate;
+        in->i_length = BLOCK * CLOCK_FREQ / irate;
+
+        float *p = (float *)in->p_buffer;
+        for (size_t i = 0; i < BLOCK; i++)
+            for (unsigned c = 0; c < CHANNELS; c++)
+                p[i * CHANNELS + c] = .5f * sinf(w * (done + i));
+
+        /* Mimic the aout drift correction */
+        if (drift)
+            filter->fmt_in.audio.i_rate = irate + ((done / BLOCK) & 1 ? 100
+                                                                      : -100);
+        expected += (double)BLOCK * orate / filter->fmt_in.audio.i_rate;
+
+        vlc_tick_t begin = vlc_tick_now();
+        block_t *res = filter->pf_audio_filter(filter, in);
+        elapsed += vlc_tick_now() - begin;
+
+        if (res != NULL)
+        {
+            assert(count + res->i_nb_samples <= capacity);
+            memcpy(out + count * CHANNELS, res->p_buffer,
+                   res->i_nb_samples * CHANNELS * sizeof (float));
+            count += res->i_nb_samples;
+            block_Release(res);
+        }
+    }
+    filter->fmt_in.audio.i_rate = irate;
+
+    double thdn = NAN;
+    if (drift)
+        /* The ratio changes must not lose nor add samples */
+        assert(fabs(count - expected) < 0.01 * expected);
+    else
+        thdn = Measure(out, count, orate);
+
+    printf("%-22s %6u -> %6u%s: %7.2f Msamples/s",
+           module_get_object(filter->p_module), irate, orate,
+           drift ? " (drift)" : "        ",
+           total / (elapsed > 0 ? (double)elapsed : 1.) * CLOCK_FREQ / 1e6);
+    if (!drift)
+        printf(", THD+N %6.1f dB", thdn);
+    printf("\n");
+    free(out);
+    return thdn;
+}
+
+int main(int argc, char *argv[])
+{
+    const unsigned seconds = argc > 1 && strcmp(argv[1], "-a") == 0 ? 60 : 2;
+
+    alarm(seconds * 10);
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *parent = VLC_OBJECT(vlc->p_libvlc_int);
+
+    if (!module_exists("polyphase"))
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    for (size_t m = 0; m < ARRAY_SIZE(modules); m++)
+    {
+        if (!module_exists(modules[m]))
+        {
+            printf("%s: not available\n", modules[m]);
+            continue;
+        }
+
+        const bool native = strcmp(modules[m], "polyphase") == 0;
+
+        for (size_t r = 0; r < ARRAY_SIZE(rates); r++)
+        {
+            filter_t *filter = CreateResampler(parent, modules[m],
+                                               rates[r][0], rates[r][1]);
+            assert(filter != NULL || !native);
+            if (filter == NULL)
+                continue;
+
+            double thdn = Run(filter, seconds, false);
+            /* Default quality: well below 16-bit quantization noise */
+            if (native)
+                assert(thdn < -80.);
+
+            module_unneed(filter, filter->p_module);
+            vlc_object_release(filter);
+
+            filter = CreateResampler(parent, modules[m],
+                                     rates[r][0], rates[r][1]);
+            assert(filter != NULL);
+            Run(filter, seconds, true);
+            module_unneed(filter, filter->p_module);
+            vlc_object_release(filter);
+        }
+    }
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*****************************************************************************
+ * scaletempo.c: scaletempo overlap search test
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#include <vlc/vlc.h>
+
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+/*
+ * Plays a sine faster, and checks that the output is still the same sine:
+ * strides only blend smoothly if the overlap search found positions in
+ * phase with the previous stride.
+ */
+
+#define PERIOD 100 /* frames */
+#define SECONDS 4
+
+static void TestScaletempo(vlc_object_t *parent, uint32_t chans,
+                           unsigned rate, double speed, int search,
+                           bool downmix)
+{
+    filter_t *filter = vlc_object_create(parent, sizeof (*filter));
+    assert(filter != NULL);
+
+    var_Create(filter, "scaletempo-search", VLC_VAR_INTEGER);
+    var_SetInteger(filter, "scaletempo-search", search);
+    var_Create(filter, "scaletempo-downmix", VLC_VAR_BOOL);
+    var_SetBool(filter, "scaletempo-downmix", downmix);
+
+    filter->fmt_in.audio.i_format = filter->fmt_in.i_codec = VLC_CODEC_FL32;
+    filter->fmt_in.audio.i_physical_channels = chans;
+    filter->fmt_in.audio.i_rate = rate;
+    aout_FormatPrepare(&filter->fmt_in.audio);
+    filter->fmt_out = filter->fmt_in;
+
+    filter->p_module = module_need(filter, "audio filter", "scaletempo", true);
+    assert(filter->p_module != NULL);
+
+    /* Play faster */
+    filter->fmt_in.audio.i_rate = rate * speed;
+
+    const unsigned channels = filter->fmt_in.audio.i_channels;
+    const unsigned frames_in = rate * SECONDS, block_frames = 1024;
+    float *out = malloc(frames_in * channels * sizeof (*out));
+    assert(out != NULL);
+
+    unsigned frames_out = 0;
+    vlc_tick_t elapsed = 0;
+
+    for (unsigned done = 0; done < frames_in; done += block_frames)
+    {
+        block_t *block = block_Alloc(block_frames * channels * sizeof (float));
+        assert(block != NULL);
+        block->i_nb_samples = block_frames;
+
+        float *p = (float *)block->p_buffer;
+        for (unsigned i = 0; i < block_frames; i++)
+            for (unsigned c = 0; c < channels; c++)
+                *p++ = (c + 1.f) / channels
+                     * sinf(2.f * M_PI * ((done + i) % PERIOD) / PERIOD);
+
+        vlc_tick_t begin = vlc_tick_now();
+        block = filter->pf_audio_filter(filter, block);
+        elapsed += vlc_tick_now() - begin;
+
+        if (block == NULL)
+            continue;
+        assert(frames_out + block->i_nb_samples <= frames_in);
+        memcpy(out + frames_out * channels, block->p_buffer, block->i_buffer);
+        frames_out += block->i_nb_samples;
+        block_Release(block);
+    }
+
+    /* Allow for the samples still queued */
+    assert(fabs(frames_out - frames_in / speed) < rate * .5);
+
+    /* Every sample of a sine is determined by the two previous ones. Skip
+     * the first stride, which fades in from silence. */
+    const float k = 2.f * cosf(2.f * M_PI / PERIOD);
+    float err = 0.f;
+
+    for (unsigned i = rate / 10; i < frames_out; i++)
+        for (unsigned c = 0; c < channels; c++)
+        {
+            const float *s = out + i * channels + c;
+            err = fmaxf(err, fabsf(s[0] - k * s[-(int)channels]
+                                   + s[-2 * (int)channels]));
+        }
+
+    printf("%u channels at %u Hz, %.1fx, search %3d ms%s: %8.2f x realtime, "
+           "error %g\n", channels, rate, speed, search,
+           downmix ? " (downmix)" : "",
+           SECONDS / (elapsed > 0 ? (double)elapsed / CLOCK_FREQ : 1e-6),
+           err);
+    assert(err < 1e-4f);
+
+    free(out);
+    module_unneed(filter, filter->p_module);
+    vlc_object_release(filter);
+}
+
+int main(void)
+{
+    alarm(60);
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *parent = VLC_OBJECT(vlc->p_libvlc_int);
+
+    if (!module_exists("scaletempo"))
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    TestScaletempo(parent, AOUT_CHANS_STEREO, 48000, 1.5, 14, false);
+    TestScaletempo(parent, AOUT_CHANS_STEREO, 48000, 4., 14, false);
+    TestScaletempo(parent, AOUT_CHANS_STEREO, 44100, 2., 200, false);
+    TestScaletempo(parent, AOUT_CHANS_5_1, 96000, 2., 14, false);
+    TestScaletempo(parent, AOUT_CHANS_5_1, 96000, 2., 100, false);
+    TestScaletempo(parent, AOUT_CHANS_5_1, 96000, 2., 14, true);
+
+    libvlc_release(vlc);
+    return 0;
+}
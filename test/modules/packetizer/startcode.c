@@ -0,0 +1,221 @@
+/*****************************************************************************
+ * startcode.c: startcode and emulation prevention scanners test
+ *****************************************************************************
+ * Copyright © 2018 VideoLabs and VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_rand.h>
+#include <vlc_tick.h>
+
+#include "../modules/packetizer/hxxx_ep3b.h"
+
+/*
+ * Checks every startcode and emulation prevention scanner the CPU supports
+ * against a byte by byte reference, over random data with planted sequences,
+ * and prints their throughput. With "-a", more data is processed.
+ */
+
+#define SIZE (1 << 20)
+
+typedef const uint8_t *(*find_cb)(const uint8_t *, const uint8_t *);
+
+static unsigned loops;
+
+static const uint8_t *FindAnnexB_Ref(const uint8_t *p, const uint8_t *end)
+{
+    for (; end - p >= 3; p++)
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    return NULL;
+}
+
+static const uint8_t *FindAnnexB_C(const uint8_t *p, const uint8_t *end)
+{
+    return startcode_FindSequence_C(p, end, 0x01);
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+static const uint8_t *FindAnnexB_AVX2(const uint8_t *p, const uint8_t *end)
+{
+    return startcode_FindSequence_AVX2(p, end, 0x01);
+}
+#endif
+
+#ifdef HAVE_NEON_INTRINSICS
+static const uint8_t *FindAnnexB_NEON(const uint8_t *p, const uint8_t *end)
+{
+    return startcode_FindSequence_NEON(p, end, 0x01);
+}
+#endif
+
+/* The bitstream reader unescaping on the fly */
+static size_t Unescape_Ref(uint8_t *dst, const uint8_t *src, size_t size)
+{
+    struct hxxx_bsfw_ep3b_ctx_s ctx;
+    bs_t bs;
+    size_t i = 0;
+
+    hxxx_bsfw_ep3b_ctx_init(&ctx);
+    bs_init_custom(&bs, src, size, &hxxx_bsfw_ep3b_callbacks, &ctx);
+    while (!bs_eof(&bs))
+        dst[i++] = bs_read(&bs, 8);
+    return i;
+}
+
+/* Random data with one zeros run every period bytes on average */
+static void Fill(uint8_t *buf, size_t size, uint8_t third, size_t period)
+{
+    for (size_t i = 0; i < size; i++)
+        buf[i] = vlc_lrand48();
+
+    for (size_t i = 0; i < size / period; i++)
+    {
+        size_t pos = vlc_lrand48() % (size - 4);
+        memset(&buf[pos], 0, 2 + vlc_lrand48() % 2);
+        if (vlc_lrand48() & 1)
+            buf[pos + 2] = third;
+    }
+}
+
+static void Report(const char *name, size_t bytes, vlc_tick_t elapsed)
+{
+    printf("%-24s %8.2f MB/s\n", name, (double)bytes /
+           (elapsed > 0 ? (double)elapsed : 1.) * CLOCK_FREQ / 1e6);
+}
+
+static void TestFind(const char *name, find_cb find, const uint8_t *dense,
+                     const uint8_t *buf)
+{
+    const uint8_t *end = buf + SIZE;
+    size_t count = 0;
+
+    /* Every start and end offset, including unaligned tails, matters */
+    for (size_t i = 0; i < 256; i++)
+        for (size_t j = i; j < i + 80; j++)
+            assert(find(&dense[i], &dense[j])
+                   == FindAnnexB_Ref(&dense[i], &dense[j]));
+
+    for (const uint8_t *p = buf, *q; p < end; p = q + 3, count++)
+    {
+        q = find(p, end);
+        assert(q == FindAnnexB_Ref(p, end));
+        if (q == NULL)
+            break;
+    }
+    assert(count > 1);
+
+    vlc_tick_t begin = vlc_tick_now();
+    for (unsigned l = 0; l < loops; l++)
+        for (const uint8_t *p = find(buf, end); p != NULL;)
+            p = find(p + 3, end);
+    Report(name, (size_t)loops * SIZE, vlc_tick_now() - begin);
+}
+
+static void TestUnescape(void)
+{
+    static const uint8_t escaped[] = {
+        0x00, 0x00, 0x03, 0x00, 0x03, 0x00, 0x00, 0x03, 0x03, 0xFF,
+        0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x01, 0x00, 0x00, 0x03,
+    };
+    static const uint8_t unescaped[] = {
+        0x00, 0x00,       0x00, 0x03, 0x00, 0x00,       0x03, 0xFF,
+        0x00, 0x00,       0x00, 0x00,       0x01, 0x00, 0x00, 0x03,
+    };
+    uint8_t out[sizeof (escaped)];
+
+    assert(Unescape_Ref(out, escaped, sizeof (escaped)) == sizeof (unescaped));
+    assert(memcmp(out, unescaped, sizeof (unescaped)) == 0);
+    assert(hxxx_ep3b_unescape(out, escaped, sizeof (escaped))
+           == sizeof (unescaped));
+    assert(memcmp(out, unescaped, sizeof (unescaped)) == 0);
+    assert(hxxx_ep3b_total_size(escaped, escaped + sizeof (escaped))
+           == sizeof (unescaped));
+
+    uint8_t *buf = malloc(SIZE), *ref = malloc(SIZE), *dst = malloc(SIZE);
+    assert(buf != NULL && ref != NULL && dst != NULL);
+
+    Fill(buf, 4096, 0x03, 16);
+    for (size_t i = 0; i < 256; i++)
+        for (size_t j = i; j < i + 80; j++)
+        {
+            size_t size = Unescape_Ref(ref, &buf[i], j - i);
+            assert(hxxx_ep3b_unescape(dst, &buf[i], j - i) == size);
+            assert(memcmp(dst, ref, size) == 0);
+            assert(hxxx_ep3b_total_size(&buf[i], &buf[j]) == size);
+        }
+
+    Fill(buf, SIZE, 0x03, 1024);
+
+    size_t size = 0;
+    vlc_tick_t begin = vlc_tick_now();
+    for (unsigned l = 0; l < loops; l++)
+        size = Unescape_Ref(ref, buf, SIZE);
+    Report("unescape bitstream", (size_t)loops * SIZE, vlc_tick_now() - begin);
+
+    begin = vlc_tick_now();
+    for (unsigned l = 0; l < loops; l++)
+        assert(hxxx_ep3b_unescape(dst, buf, SIZE) == size);
+    Report("unescape bulk", (size_t)loops * SIZE, vlc_tick_now() - begin);
+    assert(memcmp(dst, ref, size) == 0);
+
+    /* In place */
+    assert(hxxx_ep3b_unescape(buf, buf, SIZE) == size);
+    assert(memcmp(buf, ref, size) == 0);
+
+    free(dst);
+    free(ref);
+    free(buf);
+}
+
+int main(int argc, char *argv[])
+{
+    loops = argc > 1 && strcmp(argv[1], "-a") == 0 ? 200 : 4;
+
+    alarm(loops + 10);
+
+    uint8_t *buf = malloc(SIZE), dense[4096];
+    assert(buf != NULL);
+    Fill(dense, sizeof (dense), 0x01, 16);
+    Fill(buf, SIZE, 0x01, 1024);
+
+    TestFind("startcode reference", FindAnnexB_Ref, dense, buf);
+    TestFind("startcode bits", startcode_FindAnnexB_Bits, dense, buf);
+    TestFind("startcode C", FindAnnexB_C, dense, buf);
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE2())
+        TestFind("startcode SSE2", startcode_FindAnnexB_SSE2, dense, buf);
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        TestFind("startcode AVX2", FindAnnexB_AVX2, dense, buf);
+#endif
+#ifdef HAVE_NEON_INTRINSICS
+    TestFind("startcode NEON", FindAnnexB_NEON, dense, buf);
+#endif
+    free(buf);
+
+    TestUnescape();
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*****************************************************************************
+ * loudness.c: EBU R128 loudness meter test
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_loudness.h>
+
+/*
+ * Measures the sine signals of EBU Tech 3341 and Tech 3342, with the
+ * tolerances of the specifications.
+ */
+
+#define BLOCK 1000 /* frames per call */
+
+static vlc_loudness_meter_t *Create(uint32_t chans, unsigned rate)
+{
+    audio_sample_format_t fmt = {
+        .i_format = VLC_CODEC_FL32,
+        .i_physical_channels = chans,
+        .i_rate = rate,
+        .channel_type = AUDIO_CHANNEL_TYPE_BITMAP,
+    };
+    aout_FormatPrepare(&fmt);
+
+    vlc_loudness_meter_t *meter = vlc_loudness_meter_New(&fmt);
+    assert(meter != NULL);
+    return meter;
+}
+
+/* Feeds a sine in every channel */
+static void Sine(vlc_loudness_meter_t *meter, unsigned channels,
+                 unsigned rate, double freq, double phase, double dbfs,
+                 double seconds)
+{
+    const size_t frames = seconds * rate;
+    const double amplitude = pow(10., dbfs / 20.);
+    float *buf = malloc(BLOCK * channels * sizeof (*buf));
+    assert(buf != NULL);
+
+    for (size_t done = 0; done < frames; done += BLOCK)
+    {
+        size_t count = __MIN(BLOCK, frames - done);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            float v = amplitude
+                    * sin(2. * M_PI * freq * (done + i) / rate + phase);
+            for (unsigned c = 0; c < channels; c++)
+                buf[i * channels + c] = v;
+        }
+        vlc_loudness_meter_Process(meter, buf, count);
+    }
+    free(buf);
+}
+
+static void TestIntegrated(void)
+{
+    vlc_loudness_meter_t *meter = Create(AOUT_CHANS_STEREO, 48000);
+    struct vlc_loudness_report r;
+
+    /* Tech 3341 case 1: -23 dBFS in both channels reads -23 LUFS */
+    Sine(meter, 2, 48000, 1000., 0., -23., 20.);
+    vlc_loudness_meter_Get(meter, &r);
+    assert(fabs(r.integrated + 23.) <= .1);
+    assert(fabs(r.momentary + 23.) <= .1);
+    assert(fabs(r.short_term + 23.) <= .1);
+    assert(r.range <= 1.);
+
+    /* Tech 3341 case 2: -33 dBFS */
+    vlc_loudness_meter_Reset(meter);
+    Sine(meter, 2, 48000, 1000., 0., -33., 20.);
+    vlc_loudness_meter_Get(meter, &r);
+    assert(fabs(r.integrated + 33.) <= .1);
+
+    /* Tech 3341 case 3: the relative gate excludes the quiet parts */
+    vlc_loudness_meter_Reset(meter);
+    Sine(meter, 2, 48000, 1000., 0., -36., 10.);
+    Sine(meter, 2, 48000, 1000., 0., -23., 60.);
+    Sine(meter, 2, 48000, 1000., 0., -36., 10.);
+    vlc_loudness_meter_Get(meter, &r);
+    assert(fabs(r.integrated + 23.) <= .1);
+
+    /* Silence is not measurable */
+    vlc_loudness_meter_Reset(meter);
+    Sine(meter, 2, 48000, 1000., 0., -INFINITY, 5.);
+    vlc_loudness_meter_Get(meter, &r);
+    assert(isinf(r.integrated) && r.integrated < 0.);
+    vlc_loudness_meter_Delete(meter);
+
+    /* Surround channels weigh +1.5 dB and the LFE nothing */
+    meter = Create(AOUT_CHANS_5_1, 44100);
+    Sine(meter, 6, 44100, 1000., 0., -23., 10.);
+    vlc_loudness_meter_Get(meter, &r);
+    assert(fabs(r.integrated + 23. - 10. * log10((3. + 2. * 1.41) / 2.))
+           <= .1);
+    vlc_loudness_meter_Delete(meter);
+}
+
+static void TestRange(void)
+{
+    vlc_loudness_meter_t *meter = Create(AOUT_CHANS_STEREO, 48000);
+    struct vlc_loudness_report r;
+
+    /* Tech 3342 case 1: -20 then -30 dBFS reads a 10 LU range */
+    Sine(meter, 2, 48000, 1000., 0., -20., 20.);
+    Sine(meter, 2, 48000, 1000., 0., -30., 20.);
+    vlc_loudness_meter_Get(meter, &r);
+    assert(fabs(r.range - 10.) <= 1.);
+    vlc_loudness_meter_Delete(meter);
+}
+
+static void TestTruePeak(void)
+{
+    static const unsigned rates[] = { 44100, 48000, 96000 };
+
+    /* Tech 3341 case 15-like: a quarter of the sampling rate, 45 degrees off
+     * the samples, peaks 3 dB above the highest sample */
+    for (size_t i = 0; i < ARRAY_SIZE(rates); i++)
+    {
+        vlc_loudness_meter_t *meter = Create(AOUT_CHANS_STEREO, rates[i]);
+        struct vlc_loudness_report r;
+
+        Sine(meter, 2, rates[i], rates[i] / 4., M_PI / 4., -6.0206, 1.);
+        vlc_loudness_meter_Get(meter, &r);
+        assert(r.true_peak >= -6.4 && r.true_peak <= -5.8);
+        vlc_loudness_meter_Delete(meter);
+    }
+}
+
+int main(void)
+{
+    alarm(10);
+
+    TestIntegrated();
+    TestRange();
+    TestTruePeak();
+    return 0;
+}
@@ -22,6 +22,8 @@
 # include "config.h"
 #endif
 
+#include <time.h>
+
 #include "../lib/libvlc_internal.h"
 
 #include "common.h"
@@ -43,6 +45,30 @@ void vlc_run_args_init(struct vlc_run_args *args)
     args->test_demux_controls = getenv_atoi("VLC_DEMUX_CONTROLS");
 }
 
+void vlc_run_stats_clean(struct vlc_run_stats *stats)
+{
+    struct vlc_run_es_stats *es;
+
+    while ((es = stats->es) != NULL)
+    {
+        stats->es = es->next;
+        free(es);
+    }
+    stats->cpu_ns = 0;
+}
+
+uint64_t vlc_run_cputime(void)
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+        return ts.tv_sec * UINT64_C(1000000000) + ts.tv_nsec;
+#endif
+    /* Process time, including the other threads */
+    return (uint64_t)clock() * (UINT64_C(1000000000) / CLOCKS_PER_SEC);
+}
+
 libvlc_instance_t *libvlc_create(const struct vlc_run_args *args)
 {
 #ifdef TOP_BUILDDIR
@@ -69,7 +95,20 @@ libvlc_instance_t *libvlc_create(const struct vlc_run_args *args)
 
     libvlc_instance_t *vlc = libvlc_new(argc, argv);
     if (vlc == NULL)
+    {
         fprintf(stderr, "Error: cannot initialize LibVLC.\n");
+        return NULL;
+    }
+
+    /* The CPU time of each stage is measured on the calling thread: decode
+     * within it, rather than in frame threads. The variable is inherited by
+     * the decoders, even if the module is not available. */
+    if (args->stats != NULL)
+    {
+        vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
 
+        var_Create(obj, "avcodec-threads", VLC_VAR_INTEGER);
+        var_SetInteger(obj, "avcodec-threads", 1);
+    }
     return vlc;
 }
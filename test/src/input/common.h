@@ -26,6 +26,31 @@
 #define debug(...) (void)0
 #endif
 
+/* Per elementary stream statistics, in CPU time of the demux thread */
+struct vlc_run_es_stats
+{
+    struct vlc_run_es_stats *next;
+    int cat; /* enum es_format_category_e */
+    uint32_t codec;
+
+    uintmax_t blocks; /* sent by the demuxer */
+    uintmax_t bytes;
+    uintmax_t packets; /* output by the packetizer */
+    uintmax_t frames; /* output by the decoder */
+    /* CPU time of the calling thread, the decoders being single-threaded */
+    uint64_t packetize_ns;
+    uint64_t decode_ns;
+};
+
+struct vlc_run_stats
+{
+    /* elementary streams, in creation order */
+    struct vlc_run_es_stats *es;
+    /* CPU time of the demux thread, including the packetizers and decoders
+     * run from it */
+    uint64_t cpu_ns;
+};
+
 struct vlc_run_args
 {
     /* force specific target name (demux or decoder name). NULL to don't force
@@ -37,8 +62,15 @@ struct vlc_run_args
 
     /* true to test demux controls */
     bool test_demux_controls;
+
+    /* statistics to collect, NULL to not collect any */
+    struct vlc_run_stats *stats;
 };
 
 void vlc_run_args_init(struct vlc_run_args *args);
+void vlc_run_stats_clean(struct vlc_run_stats *stats);
+
+/* CPU time of the calling thread, in nanoseconds */
+uint64_t vlc_run_cputime(void);
 
 libvlc_instance_t *libvlc_create(const struct vlc_run_args *args);
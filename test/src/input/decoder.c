@@ -43,6 +43,7 @@ struct decoder_owner
 {
     decoder_t dec;
     decoder_t *packetizer;
+    struct vlc_run_es_stats *stats; /* can be NULL */
 };
 
 static inline struct decoder_owner *dec_get_owner(decoder_t *dec)
@@ -50,6 +51,13 @@ static inline struct decoder_owner *dec_get_owner(decoder_t *dec)
     return container_of(dec, struct decoder_owner, dec);
 }
 
+static void count_frame(decoder_t *dec)
+{
+    struct vlc_run_es_stats *stats = dec_get_owner(dec)->stats;
+    if (stats != NULL)
+        stats->frames++;
+}
+
 static picture_t *video_new_buffer_decoder(decoder_t *dec)
 {
     return picture_NewFromFormat(&dec->fmt_out.video);
@@ -64,13 +72,13 @@ static subpicture_t *spu_new_buffer_decoder(decoder_t *dec,
 
 static void queue_video(decoder_t *dec, picture_t *pic)
 {
-    (void) dec;
+    count_frame(dec);
     picture_Release(pic);
 }
 
 static void queue_audio(decoder_t *dec, block_t *p_block)
 {
-    (void) dec;
+    count_frame(dec);
     block_Release(p_block);
 }
 static void queue_cc(decoder_t *dec, block_t *p_block, const decoder_cc_desc_t *desc)
@@ -80,7 +88,7 @@ static void queue_cc(decoder_t *dec, block_t *p_block, const decoder_cc_desc_t *
 }
 static void queue_sub(decoder_t *dec, subpicture_t *p_subpic)
 {
-    (void) dec;
+    count_frame(dec);
     subpicture_Delete(p_subpic);
 }
 
@@ -146,7 +154,8 @@ void test_decoder_destroy(decoder_t *decoder)
     vlc_object_release(decoder);
 }
 
-decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
+decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt,
+                               struct vlc_run_es_stats *stats)
 {
     assert(parent && fmt);
     decoder_t *packetizer = NULL;
@@ -163,6 +172,7 @@ decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
     }
     decoder = &owner->dec;
     owner->packetizer = packetizer;
+    owner->stats = stats;
 
     static const struct decoder_owner_callbacks dec_video_cbs =
     {
@@ -223,6 +233,37 @@ decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
     return decoder;
 }
 
+static block_t *packetize(struct decoder_owner *owner, block_t **pp_block)
+{
+    decoder_t *packetizer = owner->packetizer;
+    struct vlc_run_es_stats *stats = owner->stats;
+
+    if (stats == NULL)
+        return packetizer->pf_packetize(packetizer, pp_block);
+
+    uint64_t begin = vlc_run_cputime();
+    block_t *out = packetizer->pf_packetize(packetizer, pp_block);
+    stats->packetize_ns += vlc_run_cputime() - begin;
+
+    for (block_t *b = out; b != NULL; b = b->p_next)
+        stats->packets++;
+    return out;
+}
+
+static int decode(struct decoder_owner *owner, block_t *block)
+{
+    decoder_t *decoder = &owner->dec;
+    struct vlc_run_es_stats *stats = owner->stats;
+
+    if (stats == NULL)
+        return decoder->pf_decode(decoder, block);
+
+    uint64_t begin = vlc_run_cputime();
+    int ret = decoder->pf_decode(decoder, block);
+    stats->decode_ns += vlc_run_cputime() - begin;
+    return ret;
+}
+
 int test_decoder_process(decoder_t *decoder, block_t *p_block)
 {
     struct decoder_owner *owner = dec_get_owner(decoder);
@@ -238,8 +279,7 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
 
     block_t **pp_block = p_block ? &p_block : NULL;
     block_t *p_packetized_block;
-    while ((p_packetized_block =
-                packetizer->pf_packetize(packetizer, pp_block)))
+    while ((p_packetized_block = packetize(owner, pp_block)))
     {
 
         if (!es_format_IsSimilar(&decoder->fmt_in, &packetizer->fmt_out))
@@ -247,7 +287,7 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
             debug("restarting module due to input format change\n");
 
             /* Drain the decoder module */
-            decoder->pf_decode(decoder, NULL);
+            decode(owner, NULL);
 
             /* Reload decoder */
             decoder_unload(decoder);
@@ -272,7 +312,7 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
             block_t *p_next = p_packetized_block->p_next;
             p_packetized_block->p_next = NULL;
 
-            int ret = decoder->pf_decode(decoder, p_packetized_block);
+            int ret = decode(owner, p_packetized_block);
 
             if (ret == VLCDEC_ECRITICAL)
             {
@@ -284,6 +324,6 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
         }
     }
     if (p_block == NULL) /* Drain */
-        decoder->pf_decode(decoder, NULL);
+        decode(owner, NULL);
     return VLC_SUCCESS;
 }
@@ -53,6 +53,7 @@ struct test_es_out_t
 {
     struct es_out_t out;
     struct es_out_id_t *ids;
+    struct vlc_run_stats *stats;
 #ifdef HAVE_DECODERS
     vlc_object_t *parent;
 #endif
@@ -61,6 +62,7 @@ struct test_es_out_t
 struct es_out_id_t
 {
     struct es_out_id_t *next;
+    struct vlc_run_es_stats *stats;
 #ifdef HAVE_DECODERS
     decoder_t *decoder;
     es_format_t fmt;
@@ -80,9 +82,23 @@ static es_out_id_t *EsOutAdd(es_out_t *out, const es_format_t *fmt)
 
     id->next = ctx->ids;
     ctx->ids = id;
+    id->stats = NULL;
+    if (ctx->stats != NULL)
+    {   /* Kept after the ES is deleted, until the statistics are cleaned */
+        struct vlc_run_es_stats **pp = &ctx->stats->es;
+        while (*pp != NULL)
+            pp = &(*pp)->next;
+
+        id->stats = *pp = calloc(1, sizeof (**pp));
+        if (id->stats != NULL)
+        {
+            id->stats->cat = fmt->i_cat;
+            id->stats->codec = fmt->i_codec;
+        }
+    }
 #ifdef HAVE_DECODERS
     es_format_Copy(&id->fmt, fmt);
-    id->decoder = test_decoder_create(ctx->parent, &id->fmt);
+    id->decoder = test_decoder_create(ctx->parent, &id->fmt, id->stats);
     if (id->decoder == NULL)
         es_format_Clean(&id->fmt);
 #endif
@@ -106,6 +122,11 @@ static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
 
     //debug("[%p] Sent    ES: %zu\n", (void *)idd, block->i_buffer);
     EsOutCheckId(ctx, id);
+    if (id->stats != NULL)
+    {
+        id->stats->blocks++;
+        id->stats->bytes += block->i_buffer;
+    }
 #ifdef HAVE_DECODERS
     if (id->decoder)
         test_decoder_process(id->decoder, block);
@@ -159,8 +180,10 @@ static int EsOutControl(es_out_t *out, int query, va_list args)
 #ifdef HAVE_DECODERS
             es_out_id_t* id = va_arg(args, es_out_id_t*);
             EsOutCheckId(ctx, id);
-            test_decoder_destroy(id->decoder);
-            test_decoder_create(ctx->parent, &id->fmt);
+            if (id->decoder)
+                test_decoder_destroy(id->decoder);
+            id->decoder = test_decoder_create(ctx->parent, &id->fmt,
+                                              id->stats);
 #endif
             break;
         }
@@ -220,7 +243,8 @@ static const struct es_out_callbacks es_out_cbs =
     .destroy = EsOutDestroy,
 };
 
-static es_out_t *test_es_out_create(vlc_object_t *parent)
+static es_out_t *test_es_out_create(vlc_object_t *parent,
+                                    struct vlc_run_stats *stats)
 {
     struct test_es_out_t *ctx = malloc(sizeof (*ctx));
     if (ctx == NULL)
@@ -230,6 +254,7 @@ static es_out_t *test_es_out_create(vlc_object_t *parent)
     }
 
     ctx->ids = NULL;
+    ctx->stats = stats;
 
     es_out_t *out = &ctx->out;
     out->cbs = &es_out_cbs;
@@ -286,7 +311,9 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     if (s == NULL)
         return -1;
 
-    es_out_t *out = test_es_out_create(VLC_OBJECT(s));
+    uint64_t cpu = vlc_run_cputime();
+
+    es_out_t *out = test_es_out_create(VLC_OBJECT(s), args->stats);
     if (out == NULL)
         return -1;
 
@@ -329,6 +356,9 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     demux_Delete(demux);
     es_out_Delete(out);
 
+    if (args->stats != NULL)
+        args->stats->cpu_ns += vlc_run_cputime() - cpu;
+
     debug("Completed with %" PRIuMAX " iteration(s).\n", i);
 
     return val == VLC_DEMUXER_EOF ? 0 : -1;
@@ -0,0 +1,202 @@
+/*****************************************************************************
+ * seek_index.c: Seek index unit test
+ *****************************************************************************
+ * Copyright © 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_seek_index.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+static libvlc_instance_t *vlc;
+static vlc_object_t *parent;
+static demux_t *demux;
+static uint8_t source[4096];
+static char cachedir[64];
+static char indexdir[128];
+
+static vlc_seek_index_t *Open(void)
+{
+    demux->s = vlc_stream_MemoryNew(parent, source, sizeof (source), true);
+    assert(demux->s != NULL);
+    return vlc_seek_index_New(demux, "test");
+}
+
+static void Close(vlc_seek_index_t *index)
+{
+    vlc_seek_index_Delete(index);
+    vlc_stream_Delete(demux->s);
+    demux->s = NULL;
+}
+
+static bool Lookup(vlc_seek_index_t *index, vlc_tick_t time,
+                   vlc_tick_t expected_time, uint64_t expected_offset)
+{
+    vlc_tick_t point_time;
+    uint64_t offset;
+
+    if (!vlc_seek_index_Lookup(index, time, &point_time, &offset))
+        return false;
+    assert(point_time == expected_time);
+    assert(offset == expected_offset);
+    return true;
+}
+
+/* Path of the only index saved in the cache */
+static void GetIndexPath(char *path, size_t size)
+{
+    DIR *dir = opendir(indexdir);
+    struct dirent *ent;
+    int count = 0;
+
+    assert(dir != NULL);
+    while ((ent = readdir(dir)) != NULL)
+    {
+        if (ent->d_name[0] == '.')
+            continue;
+        snprintf(path, size, "%s/%s", indexdir, ent->d_name);
+        count++;
+    }
+    closedir(dir);
+    assert(count == 1);
+}
+
+static void Corrupt(const char *path, long offset, const void *data,
+                    size_t size)
+{
+    FILE *file = fopen(path, "r+b");
+    assert(file != NULL);
+    assert(fseek(file, offset, SEEK_SET) == 0);
+    assert(fwrite(data, size, 1, file) == 1);
+    assert(fclose(file) == 0);
+}
+
+int main(void)
+{
+    vlc_seek_index_t *index;
+    char path[256];
+
+    test_init();
+
+    strcpy(cachedir, "/tmp/vlc-seek-index-XXXXXX");
+    assert(mkdtemp(cachedir) != NULL);
+    setenv("XDG_CACHE_HOME", cachedir, 1);
+    snprintf(indexdir, sizeof (indexdir), "%s/vlc/seekindex", cachedir);
+
+    for (size_t i = 0; i < sizeof (source); i++)
+        source[i] = i * 7;
+
+    vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    parent = VLC_OBJECT(vlc->p_libvlc_int);
+
+    demux = vlc_object_create(parent, sizeof (*demux));
+    assert(demux != NULL);
+    demux->psz_filepath = NULL;
+    demux->b_preparsing = false;
+
+    /* Ordering */
+    index = Open();
+    assert(index != NULL);
+    assert(!Lookup(index, VLC_TICK_FROM_SEC(10), 0, 0));
+
+    vlc_seek_index_Add(index, VLC_TICK_FROM_SEC(10), 1000);
+    vlc_seek_index_Add(index, VLC_TICK_FROM_SEC(20), 2000);
+    vlc_seek_index_Add(index, VLC_TICK_FROM_SEC(5), 500);
+
+    assert(!Lookup(index, VLC_TICK_FROM_SEC(4), 0, 0));
+    assert(Lookup(index, VLC_TICK_FROM_SEC(5), VLC_TICK_FROM_SEC(5), 500));
+    assert(Lookup(index, VLC_TICK_FROM_SEC(15), VLC_TICK_FROM_SEC(10), 1000));
+    assert(Lookup(index, VLC_TICK_FROM_SEC(60), VLC_TICK_FROM_SEC(20), 2000));
+
+    /* Rejection: too close to a point, or offset out of order */
+    vlc_seek_index_Add(index, VLC_TICK_FROM_MS(10500), 1050);
+    vlc_seek_index_Add(index, VLC_TICK_FROM_MS(19500), 1900);
+    vlc_seek_index_Add(index, VLC_TICK_FROM_SEC(15), 2500);
+    vlc_seek_index_Add(index, VLC_TICK_FROM_SEC(30), 1500);
+    vlc_seek_index_Add(index, VLC_TICK_FROM_SEC(2), 600);
+
+    assert(!Lookup(index, VLC_TICK_FROM_SEC(4), 0, 0));
+    assert(Lookup(index, VLC_TICK_FROM_SEC(19), VLC_TICK_FROM_SEC(10), 1000));
+    assert(Lookup(index, VLC_TICK_FROM_SEC(60), VLC_TICK_FROM_SEC(20), 2000));
+
+    vlc_seek_index_Add(index, VLC_TICK_FROM_SEC(15), 1500);
+    assert(Lookup(index, VLC_TICK_FROM_SEC(19), VLC_TICK_FROM_SEC(15), 1500));
+    Close(index);
+
+    /* Round trip */
+    index = Open();
+    assert(index != NULL);
+    assert(!Lookup(index, VLC_TICK_FROM_SEC(4), 0, 0));
+    assert(Lookup(index, VLC_TICK_FROM_SEC(5), VLC_TICK_FROM_SEC(5), 500));
+    assert(Lookup(index, VLC_TICK_FROM_SEC(12), VLC_TICK_FROM_SEC(10), 1000));
+    assert(Lookup(index, VLC_TICK_FROM_SEC(19), VLC_TICK_FROM_SEC(15), 1500));
+    assert(Lookup(index, VLC_TICK_FROM_SEC(60), VLC_TICK_FROM_SEC(20), 2000));
+    Close(index);
+
+    /* Another source does not share it */
+    source[0] ^= 0xFF;
+    index = Open();
+    assert(index != NULL);
+    assert(!Lookup(index, VLC_TICK_FROM_SEC(60), 0, 0));
+    Close(index);
+    source[0] ^= 0xFF;
+
+    /* Corrupted: the second point is before the first one */
+    GetIndexPath(path, sizeof (path));
+    uint8_t zero[8] = { 0 };
+    Corrupt(path, 12 + 16, zero, sizeof (zero));
+
+    index = Open();
+    assert(index != NULL);
+    assert(!Lookup(index, VLC_TICK_FROM_SEC(60), 0, 0));
+    Close(index);
+
+    /* Corrupted: bad magic */
+    Corrupt(path, 0, "XXXX", 4);
+
+    index = Open();
+    assert(index != NULL);
+    assert(!Lookup(index, VLC_TICK_FROM_SEC(60), 0, 0));
+    Close(index);
+
+    vlc_object_release(demux);
+    libvlc_release(vlc);
+
+    unlink(path);
+    rmdir(indexdir);
+    snprintf(path, sizeof (path), "%s/vlc", cachedir);
+    rmdir(path);
+    rmdir(cachedir);
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*****************************************************************************
+ * picture_pool.c: test picture pool contention
+ *****************************************************************************
+ * Copyright (C) 2018 VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdatomic.h>
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include <vlc_picture_pool.h>
+#include "../../libvlc/test.h"
+
+#define PICTURES  4
+#define THREADS   16
+#define LOOPS     20000
+
+static picture_t *originals[PICTURES];
+static atomic_bool in_use[PICTURES];
+static unsigned original_count;
+
+static void enum_cb(void *opaque, picture_t *pic)
+{
+    (void) opaque;
+    originals[original_count++] = pic;
+}
+
+/* Clones share the planes of the pooled picture they were made from */
+static unsigned picture_index(const picture_t *pic)
+{
+    for (unsigned i = 0; i < original_count; i++)
+        if (originals[i]->p[0].p_pixels == pic->p[0].p_pixels)
+            return i;
+    assert(!"picture not from pool");
+    return 0;
+}
+
+static void use_picture(picture_t *pic)
+{
+    unsigned i = picture_index(pic);
+
+    /* No other thread may own the same pooled picture */
+    assert(!atomic_exchange(&in_use[i], true));
+    pic->p[0].p_pixels[0]++;
+    assert(atomic_exchange(&in_use[i], false));
+
+    picture_Release(pic);
+}
+
+static void *decoder_thread(void *data)
+{
+    picture_pool_t *pool = data;
+
+    for (unsigned i = 0; i < LOOPS; i++)
+    {
+        picture_t *pic;
+
+        if (i & 1)
+        {
+            pic = picture_pool_Get(pool);
+            if (pic == NULL)
+                continue;
+        }
+        else
+        {
+            pic = picture_pool_Wait(pool);
+            assert(pic != NULL);
+        }
+        use_picture(pic);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    test_init();
+
+    video_format_t fmt;
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, 32, 32, 32, 32, 1, 1);
+
+    picture_pool_t *pool = picture_pool_NewFromFormat(&fmt, PICTURES);
+    assert(pool != NULL);
+    assert(picture_pool_GetSize(pool) == PICTURES);
+    picture_pool_Enum(pool, enum_cb, NULL);
+    assert(original_count == PICTURES);
+    for (unsigned i = 0; i < PICTURES; i++)
+        atomic_init(&in_use[i], false);
+
+    /* Drain the pool, then refill it */
+    picture_t *pics[PICTURES];
+    for (unsigned i = 0; i < PICTURES; i++)
+    {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+    for (unsigned i = 0; i < PICTURES; i++)
+        picture_Release(pics[i]);
+
+    /* Many decoders fighting over a few pictures */
+    vlc_thread_t threads[THREADS];
+    for (unsigned i = 0; i < THREADS; i++)
+        assert(vlc_clone(&threads[i], decoder_thread, pool,
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(threads[i], NULL);
+
+    /* Every picture must be back */
+    for (unsigned i = 0; i < PICTURES; i++)
+    {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+    for (unsigned i = 0; i < PICTURES; i++)
+        picture_Release(pics[i]);
+
+    picture_pool_Release(pool);
+    return 0;
+}
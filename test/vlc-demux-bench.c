@@ -0,0 +1,167 @@
+/*****************************************************************************
+ * vlc-demux-bench.c: decode throughput benchmark
+ *****************************************************************************
+ * Copyright © 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include <vlc_common.h>
+#include <vlc_es.h>
+#include <vlc_fourcc.h>
+
+#include "src/input/demux-run.h"
+
+/*
+ * Demuxes, packetizes and decodes every file as fast as possible, without any
+ * output, and prints one JSON object per file on the standard output:
+ *
+ *  - wall_us, cpu_us: elapsed and process CPU (user and system) times,
+ *  - demux_cpu_us: CPU time of the demux thread, minus the packetizers and
+ *    decoders,
+ *  - max_rss_kb: peak resident set size of the process so far,
+ *  - minor_faults: pages mapped, as a measure of the allocations,
+ *  - streams: blocks and bytes demuxed, packets and frames output, frames
+ *    per second and packetizer and decoder CPU times, per elementary stream.
+ *
+ * The decoders run single-threaded, so that all their work is accounted in
+ * their CPU time.
+ */
+
+static const char *const cats[] = {
+    [UNKNOWN_ES] = "unknown",
+    [VIDEO_ES] = "video",
+    [AUDIO_ES] = "audio",
+    [SPU_ES] = "spu",
+    [DATA_ES] = "data",
+};
+
+static uint64_t wall_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * UINT64_C(1000000) + ts.tv_nsec / 1000;
+}
+
+static uint64_t tv_us(const struct timeval *tv)
+{
+    return tv->tv_sec * UINT64_C(1000000) + tv->tv_usec;
+}
+
+static void print_string(const char *str)
+{
+    putchar('"');
+    for (const unsigned char *p = (const unsigned char *)str; *p; p++)
+    {
+        if (*p == '"' || *p == '\\')
+            printf("\\%c", *p);
+        else if (*p < 0x20)
+            printf("\\u%04x", *p);
+        else
+            putchar(*p);
+    }
+    putchar('"');
+}
+
+static int bench(const struct vlc_run_args *args, const char *path)
+{
+    struct rusage before, after;
+    struct vlc_run_stats *stats = args->stats;
+
+    getrusage(RUSAGE_SELF, &before);
+    uint64_t begin = wall_us();
+    int ret = vlc_demux_process_path(args, path);
+    uint64_t wall = wall_us() - begin;
+    getrusage(RUSAGE_SELF, &after);
+
+    uint64_t cpu = tv_us(&after.ru_utime) - tv_us(&before.ru_utime)
+                 + tv_us(&after.ru_stime) - tv_us(&before.ru_stime);
+    uint64_t demux_ns = stats->cpu_ns;
+    long max_rss = after.ru_maxrss;
+#ifdef __APPLE__
+    max_rss /= 1024; /* in bytes rather than kilobytes */
+#endif
+
+    for (const struct vlc_run_es_stats *es = stats->es; es; es = es->next)
+        demux_ns -= __MIN(demux_ns, es->packetize_ns + es->decode_ns);
+
+    printf("{\"file\":");
+    print_string(path);
+    printf(",\"result\":%d,\"wall_us\":%"PRIu64",\"cpu_us\":%"PRIu64","
+           "\"demux_cpu_us\":%"PRIu64",\"max_rss_kb\":%ld,"
+           "\"minor_faults\":%ld,\"streams\":[", ret, wall, cpu,
+           demux_ns / 1000, max_rss, after.ru_minflt - before.ru_minflt);
+
+    for (const struct vlc_run_es_stats *es = stats->es; es; es = es->next)
+    {
+        const char *cat = "unknown";
+        if (es->cat >= 0 && (size_t)es->cat < ARRAY_SIZE(cats))
+            cat = cats[es->cat];
+        const char *desc = vlc_fourcc_GetDescription(es->cat, es->codec);
+        char codec[5];
+
+        memcpy(codec, &es->codec, 4);
+        codec[4] = '\0';
+
+        printf("%s{\"cat\":\"%s\",\"codec\":",
+               es != stats->es ? "," : "", cat);
+        print_string(codec);
+        printf(",\"description\":");
+        print_string(desc != NULL ? desc : "");
+        printf(",\"blocks\":%ju,\"bytes\":%ju,\"packets\":%ju,\"frames\":%ju,"
+               "\"fps\":%.2f,\"packetize_cpu_us\":%"PRIu64","
+               "\"decode_cpu_us\":%"PRIu64"}",
+               es->blocks, es->bytes, es->packets, es->frames,
+               wall > 0 ? es->frames * 1e6 / wall : 0.,
+               es->packetize_ns / 1000, es->decode_ns / 1000);
+    }
+    printf("]}\n");
+    fflush(stdout);
+
+    vlc_run_stats_clean(stats);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    struct vlc_run_args args;
+    struct vlc_run_stats stats = { .es = NULL, .cpu_ns = 0 };
+    int ret = 0;
+
+    vlc_run_args_init(&args);
+    args.stats = &stats;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: [VLC_TARGET=demux] %s <filename>...\n",
+                argv[0]);
+        return 1;
+    }
+
+    for (int i = 1; i < argc; i++)
+        if (bench(&args, argv[i]))
+            ret = 1;
+
+    return ret;
+}